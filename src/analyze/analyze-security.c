@@ -2148,6 +2148,12 @@ int analyze_security(sd_bus *bus, char **units, AnalyzeSecurityFlags flags) {
                         if (!endswith(info.id, ".service"))
                                 continue;
 
+                        /* We only look at loaded units below (ANALYZE_SECURITY_ONLY_LOADED), and ListUnits
+                         * already tells us the load state, hence don't bother fetching all properties of the
+                         * others. */
+                        if (!streq_ptr(info.load_state, "loaded"))
+                                continue;
+
                         if (!GREEDY_REALLOC(list, allocated, n + 2))
                                 return log_oom();
 
@@ -5,24 +5,74 @@
 #include <stddef.h>
 #include <unistd.h>
 
+#include "alloc-util.h"
 #include "async.h"
 #include "errno-util.h"
 #include "fd-util.h"
+#include "list.h"
 #include "log.h"
 #include "macro.h"
 #include "process-util.h"
 #include "signal-util.h"
+#include "time-util.h"
 #include "util.h"
 
-int asynchronous_job(void* (*func)(void *p), void *arg) {
+/* Worker threads which didn't get a new job for this long exit again */
+#define WORKER_IDLE_USEC (5 * USEC_PER_SEC)
+
+typedef struct AsyncJob AsyncJob;
+
+struct AsyncJob {
+        void* (*func)(void *p);
+        void *arg;
+
+        LIST_FIELDS(AsyncJob, jobs);
+};
+
+static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t worker_cond = PTHREAD_COND_INITIALIZER;
+static LIST_HEAD(AsyncJob, worker_jobs);
+static unsigned n_worker_jobs, n_workers_idle;
+static pid_t worker_pid;
+
+static void *worker_thread(void *p) {
+        AsyncJob *j = p;
+
+        for (;;) {
+                j->func(j->arg);
+                free(j);
+
+                assert_se(pthread_mutex_lock(&worker_mutex) == 0);
+
+                while (!worker_jobs) {
+                        struct timespec ts;
+                        int r;
+
+                        n_workers_idle++;
+                        r = pthread_cond_timedwait(&worker_cond, &worker_mutex,
+                                                   timespec_store(&ts, now(CLOCK_REALTIME) + WORKER_IDLE_USEC));
+                        n_workers_idle--;
+
+                        if (r == ETIMEDOUT && !worker_jobs) {
+                                assert_se(pthread_mutex_unlock(&worker_mutex) == 0);
+                                return NULL;
+                        }
+                }
+
+                j = worker_jobs;
+                LIST_REMOVE(jobs, worker_jobs, j);
+                n_worker_jobs--;
+
+                assert_se(pthread_mutex_unlock(&worker_mutex) == 0);
+        }
+}
+
+static int worker_spawn(AsyncJob *j) {
         sigset_t ss, saved_ss;
         pthread_attr_t a;
         pthread_t t;
         int r, k;
 
-        /* It kinda sucks that we have to resort to threads to implement an asynchronous close(), but well, such is
-         * life. */
-
         r = pthread_attr_init(&a);
         if (r > 0)
                 return -r;
@@ -44,7 +94,7 @@ int asynchronous_job(void* (*func)(void *p), void *arg) {
                 goto finish;
         }
 
-        r = pthread_create(&t, &a, func, arg);
+        r = pthread_create(&t, &a, worker_thread, j);
 
         k = pthread_sigmask(SIG_SETMASK, &saved_ss, NULL);
 
@@ -60,6 +110,63 @@ finish:
         return r;
 }
 
+static void worker_reset_after_fork(void) {
+
+        /* Worker threads don't survive fork(), hence forget about them, and the jobs queued for them, in the
+         * child. Some thread of the parent might have held the mutex while forking, reinitialize it. */
+
+        if (worker_pid == 0 || worker_pid == getpid_cached())
+                return;
+
+        worker_mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+        worker_cond = (pthread_cond_t) PTHREAD_COND_INITIALIZER;
+        worker_jobs = NULL;
+        n_worker_jobs = n_workers_idle = 0;
+        worker_pid = 0;
+}
+
+int asynchronous_job(void* (*func)(void *p), void *arg) {
+        AsyncJob *j;
+        int r;
+
+        /* It kinda sucks that we have to resort to threads to implement an asynchronous close(), but well, such is
+         * life. Threads are kept around for a while after finishing their job, so that they can be reused
+         * for the next ones, instead of creating a new thread for each job. If no thread is idle, a new one
+         * is started, so that a job that blocks indefinitely never holds up any others. */
+
+        j = new(AsyncJob, 1);
+        if (!j)
+                return -ENOMEM;
+
+        *j = (AsyncJob) {
+                .func = func,
+                .arg = arg,
+        };
+
+        worker_reset_after_fork();
+
+        assert_se(pthread_mutex_lock(&worker_mutex) == 0);
+
+        if (n_workers_idle > n_worker_jobs) {
+                LIST_APPEND(jobs, worker_jobs, j);
+                n_worker_jobs++;
+
+                assert_se(pthread_cond_signal(&worker_cond) == 0);
+                assert_se(pthread_mutex_unlock(&worker_mutex) == 0);
+                return 0;
+        }
+
+        worker_pid = getpid_cached();
+
+        assert_se(pthread_mutex_unlock(&worker_mutex) == 0);
+
+        r = worker_spawn(j);
+        if (r < 0)
+                free(j);
+
+        return r;
+}
+
 int asynchronous_sync(pid_t *ret_pid) {
         int r;
 
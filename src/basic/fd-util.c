@@ -9,6 +9,7 @@
 #include "alloc-util.h"
 #include "copy.h"
 #include "dirent-util.h"
+#include "errno-util.h"
 #include "fd-util.h"
 #include "fileio.h"
 #include "fs-util.h"
@@ -21,6 +22,7 @@
 #include "path-util.h"
 #include "process-util.h"
 #include "socket-util.h"
+#include "sort-util.h"
 #include "stat-util.h"
 #include "stdio-util.h"
 #include "tmpfile-util.h"
@@ -210,13 +212,92 @@ static int get_max_fd(void) {
         return (int) (m - 1);
 }
 
+static int cmp_int(const int *a, const int *b) {
+        return CMP(*a, *b);
+}
+
+static int close_all_fds_by_range(const int except[], size_t n_except) {
+        _cleanup_free_ int *sorted_malloc = NULL;
+        size_t n_sorted, i;
+        int *sorted;
+
+        /* Closes all fds from 3 on that are not listed in the except array, with one close_range() call
+         * for each gap between two fds to keep, instead of one close() per open fd. Returns the error of
+         * close_range() as is, i.e. -ENOSYS if the kernel doesn't support it, or -EPERM if a seccomp
+         * filter doesn't let us use it, so that the caller can fall back to the slow path. */
+
+        if (n_except == 0) {
+                if (close_range(3, -1, 0) < 0)
+                        return -errno;
+
+                return 0;
+        }
+
+        assert(n_except < SIZE_MAX);
+        n_sorted = n_except + 1;
+
+        if (n_sorted > 64) /* Use the heap for large numbers of fds, the stack otherwise */
+                sorted = sorted_malloc = new(int, n_sorted);
+        else
+                sorted = newa(int, n_sorted);
+        if (!sorted)
+                return -ENOMEM;
+
+        memcpy(sorted, except, n_except * sizeof(int));
+
+        /* Add fd 2 to the list, so that the head of the array is covered by the same loop as the body */
+        sorted[n_sorted-1] = 2;
+
+        typesafe_qsort(sorted, n_sorted, cmp_int);
+
+        for (i = 0; i < n_sorted - 1; i++) {
+                int start, end;
+
+                start = MAX(sorted[i], 2); /* The first three fds shall always remain open */
+                end = MAX(sorted[i+1], 2);
+
+                assert(end >= start);
+
+                if (end - start <= 1)
+                        continue;
+
+                /* Close everything between the start and end fds, both of which shall stay open */
+                if (close_range(start + 1, end - 1, 0) < 0)
+                        return -errno;
+        }
+
+        /* And finally everything beyond the last fd to keep */
+        if (sorted[n_sorted-1] >= INT_MAX)
+                return 0;
+
+        if (close_range(sorted[n_sorted-1] + 1, -1, 0) < 0)
+                return -errno;
+
+        return 0;
+}
+
 int close_all_fds(const int except[], size_t n_except) {
+        static bool have_close_range = true; /* Assume we live in the future */
         _cleanup_closedir_ DIR *d = NULL;
         struct dirent *de;
         int r = 0;
 
         assert(n_except == 0 || except);
 
+        if (have_close_range) {
+                r = close_all_fds_by_range(except, n_except);
+                if (r >= 0)
+                        return r;
+                if (!ERRNO_IS_NOT_SUPPORTED(r) && !ERRNO_IS_PRIVILEGE(r) && r != -ENOMEM)
+                        return r;
+
+                /* Fall back to closing the fds one by one. The fds closed until the failure are gone
+                 * already, which is fine, since we'd have closed them anyway. */
+                if (r != -ENOMEM)
+                        have_close_range = false;
+                r = 0;
+        }
+
         d = opendir("/proc/self/fd");
         if (!d) {
                 int fd, max_fd;
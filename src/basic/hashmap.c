@@ -190,6 +190,17 @@ assert_cc(DIRECT_BUCKETS(struct set_entry) < (1 << 3));
  * outgrows direct storage, it gets its own key for indirect storage. */
 static uint8_t shared_hash_key[HASH_KEY_SIZE];
 
+/* Which of the common hash_ops a hashmap uses, so that their hash and compare functions can be
+ * called directly instead of through the function pointers */
+enum HashmapKeyType {
+        HASHMAP_KEY_GENERIC, /* anything else, use the hash_ops */
+        HASHMAP_KEY_POINTER, /* trivial_hash_func + trivial_compare_func */
+        HASHMAP_KEY_UINT64,  /* uint64_hash_func + uint64_compare_func */
+        _HASHMAP_KEY_TYPE_MAX,
+};
+
+assert_cc(_HASHMAP_KEY_TYPE_MAX <= (1 << 2));
+
 /* Fields that all hashmap/set types must have */
 struct HashmapBase {
         const struct hash_ops *hash_ops;  /* hash and compare ops to use */
@@ -206,6 +217,7 @@ struct HashmapBase {
         bool from_pool:1;            /* whether was allocated from mempool */
         bool dirty:1;                /* whether dirtied since last iterated_cache_get() */
         bool cached:1;               /* whether this hashmap is being cached */
+        enum HashmapKeyType key_type:2; /* HASHMAP_KEY_*, derived from hash_ops */
 
 #if ENABLE_DEBUG_HASHMAP
         struct hashmap_debug_info debug;
@@ -336,16 +348,56 @@ static unsigned base_bucket_hash(HashmapBase *h, const void *p) {
         struct siphash state;
         uint64_t hash;
 
-        siphash24_init(&state, hash_key(h));
+        /* Integer keys are still hashed with the keyed siphash, so that they can't be picked to collide,
+         * but without going through the generic hash function. */
+        switch (h->key_type) {
 
-        h->hash_ops->hash(p, &state);
+        case HASHMAP_KEY_POINTER:
+                hash = siphash24(&p, sizeof(p), hash_key(h));
+                break;
 
-        hash = siphash24_finalize(&state);
+        case HASHMAP_KEY_UINT64:
+                hash = siphash24(p, sizeof(uint64_t), hash_key(h));
+                break;
+
+        default:
+                siphash24_init(&state, hash_key(h));
+
+                h->hash_ops->hash(p, &state);
+
+                hash = siphash24_finalize(&state);
+        }
 
         return (unsigned) (hash % n_buckets(h));
 }
 #define bucket_hash(h, p) base_bucket_hash(HASHMAP_BASE(h), p)
 
+static bool base_key_equal(HashmapBase *h, const void *a, const void *b) {
+        switch (h->key_type) {
+
+        case HASHMAP_KEY_POINTER:
+                return a == b;
+
+        case HASHMAP_KEY_UINT64:
+                return *(const uint64_t*) a == *(const uint64_t*) b;
+
+        default:
+                return h->hash_ops->compare(a, b) == 0;
+        }
+}
+
+static enum HashmapKeyType hash_ops_key_type(const struct hash_ops *hash_ops) {
+        if (hash_ops->hash == trivial_hash_func &&
+            hash_ops->compare == trivial_compare_func)
+                return HASHMAP_KEY_POINTER;
+
+        if (hash_ops->hash == (hash_func_t) uint64_hash_func &&
+            hash_ops->compare == (compare_func_t) uint64_compare_func)
+                return HASHMAP_KEY_UINT64;
+
+        return HASHMAP_KEY_GENERIC;
+}
+
 static void base_set_dirty(HashmapBase *h) {
         h->dirty = true;
 }
@@ -781,6 +833,7 @@ static struct HashmapBase* hashmap_base_new(const struct hash_ops *hash_ops, enu
         h->type = type;
         h->from_pool = up;
         h->hash_ops = hash_ops ?: &trivial_hash_ops;
+        h->key_type = hash_ops_key_type(h->hash_ops);
 
         if (type == HASHMAP_TYPE_ORDERED) {
                 OrderedHashmap *lh = (OrderedHashmap*)h;
@@ -1206,7 +1259,7 @@ static unsigned base_bucket_scan(HashmapBase *h, unsigned idx, const void *key)
                         return IDX_NIL;
                 if (dib == distance) {
                         e = bucket_at(h, idx);
-                        if (h->hash_ops->compare(e->key, key) == 0)
+                        if (base_key_equal(h, e->key, key))
                                 return idx;
                 }
 
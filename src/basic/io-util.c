@@ -228,8 +228,10 @@ ssize_t sparse_write(int fd, const void *p, size_t sz, size_t run_length) {
                         w = q;
                 } else if (n > 0)
                         q += n;
-                else
-                        q++;
+                else {
+                        /* Skip over data in one go, rather than looking at each byte individually */
+                        q = memchr(q, 0, e - q) ?: e;
+                }
         }
 
         if (q > w) {
@@ -13,3 +13,7 @@ struct loop_config {
 
 #define LOOP_CONFIGURE 0x4C0A
 #endif
+
+#ifndef LOOP_SET_DIRECT_IO
+#define LOOP_SET_DIRECT_IO 0x4C08
+#endif
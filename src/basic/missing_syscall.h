@@ -5,6 +5,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <signal.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
@@ -693,6 +694,50 @@ static inline int missing_pidfd_open(pid_t pid, unsigned flags) {
 
 /* ======================================================================= */
 
+/* should be always defined, see kernel 9b4feb630e8e9801603f3cab3a36369e3c1cf88d */
+#if defined(__alpha__)
+#  define systemd_NR_close_range 546
+#else
+#  define systemd_NR_close_range 436
+#endif
+
+/* may be (invalid) negative number due to libseccomp, see PR 13319 */
+#if defined __NR_close_range && __NR_close_range >= 0
+#  if defined systemd_NR_close_range
+assert_cc(__NR_close_range == systemd_NR_close_range);
+#  endif
+#else
+#  if defined __NR_close_range
+#    undef __NR_close_range
+#  endif
+#  define __NR_close_range systemd_NR_close_range
+#endif
+
+#if !HAVE_CLOSE_RANGE
+static inline int missing_close_range(int first_fd, int end_fd, unsigned flags) {
+#  ifdef __NR_close_range
+        /* The kernel takes the fds as unsigned integers, with UINT_MAX meaning "up to the end". We use
+         * signed fds everywhere, hence map -1 to that, and refuse any other negative values. */
+        if (first_fd < 0 || (end_fd < 0 && end_fd != -1)) {
+                errno = EBADF;
+                return -1;
+        }
+
+        return syscall(__NR_close_range,
+                       (unsigned) first_fd,
+                       end_fd == -1 ? UINT_MAX : (unsigned) end_fd,
+                       flags);
+#  else
+        errno = ENOSYS;
+        return -1;
+#  endif
+}
+
+#  define close_range missing_close_range
+#endif
+
+/* ======================================================================= */
+
 #if !HAVE_RT_SIGQUEUEINFO
 static inline int missing_rt_sigqueueinfo(pid_t tgid, int sig, siginfo_t *info) {
 #  if defined __NR_rt_sigqueueinfo && __NR_rt_sigqueueinfo >= 0
@@ -54,7 +54,7 @@
 #define COMM_MAX_LEN 128
 
 static int get_process_state(pid_t pid) {
-        _cleanup_free_ char *line = NULL;
+        char line[LINE_MAX];
         const char *p;
         char state;
         int r;
@@ -67,7 +67,7 @@ static int get_process_state(pid_t pid) {
 
         p = procfs_file_alloca(pid, "stat");
 
-        r = read_one_line_file(p, &line);
+        r = read_virtual_file_to_buffer(p, line, sizeof(line), NULL);
         if (r == -ENOENT)
                 return -ESRCH;
         if (r < 0)
@@ -86,17 +86,16 @@ static int get_process_state(pid_t pid) {
 }
 
 int get_process_comm(pid_t pid, char **ret) {
-        _cleanup_free_ char *escaped = NULL, *comm = NULL;
+        _cleanup_free_ char *escaped = NULL;
+        char comm[COMM_MAX_LEN] = {};
         int r;
 
         assert(ret);
         assert(pid >= 0);
 
-        if (pid == 0 || pid == getpid_cached()) {
-                comm = new0(char, TASK_COMM_LEN + 1); /* Must fit in 16 byte according to prctl(2) */
-                if (!comm)
-                        return -ENOMEM;
+        assert_cc(sizeof(comm) > TASK_COMM_LEN); /* Must fit in 16 byte according to prctl(2) */
 
+        if (pid == 0 || pid == getpid_cached()) {
                 if (prctl(PR_GET_NAME, comm) < 0)
                         return -errno;
         } else {
@@ -104,12 +103,15 @@ int get_process_comm(pid_t pid, char **ret) {
 
                 p = procfs_file_alloca(pid, "comm");
 
-                /* Note that process names of kernel threads can be much longer than TASK_COMM_LEN */
-                r = read_one_line_file(p, &comm);
+                /* Note that process names of kernel threads can be much longer than TASK_COMM_LEN, but
+                 * they are still much shorter than COMM_MAX_LEN */
+                r = read_virtual_file_to_buffer(p, comm, sizeof(comm), NULL);
                 if (r == -ENOENT)
                         return -ESRCH;
                 if (r < 0)
                         return r;
+
+                comm[strcspn(comm, NEWLINE)] = 0;
         }
 
         escaped = new(char, COMM_MAX_LEN);
@@ -352,7 +354,7 @@ int rename_process(const char name[]) {
 }
 
 int is_kernel_thread(pid_t pid) {
-        _cleanup_free_ char *line = NULL;
+        char line[LINE_MAX];
         unsigned long long flags;
         size_t l, i;
         const char *p;
@@ -365,7 +367,7 @@ int is_kernel_thread(pid_t pid) {
                 return -EINVAL;
 
         p = procfs_file_alloca(pid, "stat");
-        r = read_one_line_file(p, &line);
+        r = read_virtual_file_to_buffer(p, line, sizeof(line), NULL);
         if (r == -ENOENT)
                 return -ESRCH;
         if (r < 0)
@@ -595,7 +597,7 @@ int get_process_environ(pid_t pid, char **env) {
 
 int get_process_ppid(pid_t pid, pid_t *_ppid) {
         int r;
-        _cleanup_free_ char *line = NULL;
+        char line[LINE_MAX];
         long unsigned ppid;
         const char *p;
 
@@ -608,7 +610,7 @@ int get_process_ppid(pid_t pid, pid_t *_ppid) {
         }
 
         p = procfs_file_alloca(pid, "stat");
-        r = read_one_line_file(p, &line);
+        r = read_virtual_file_to_buffer(p, line, sizeof(line), NULL);
         if (r == -ENOENT)
                 return -ESRCH;
         if (r < 0)
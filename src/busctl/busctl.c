@@ -1330,9 +1330,9 @@ static int monitor(int argc, char **argv, int (*dump)(sd_bus_message *m, FILE *f
 
                 if (m) {
                         dump(m, stdout);
-                        fflush(stdout);
 
                         if (sd_bus_message_is_signal(m, "org.freedesktop.DBus.Local", "Disconnected") > 0) {
+                                fflush(stdout);
                                 log_info("Connection terminated, exiting.");
                                 return 0;
                         }
@@ -1343,6 +1343,10 @@ static int monitor(int argc, char **argv, int (*dump)(sd_bus_message *m, FILE *f
                 if (r > 0)
                         continue;
 
+                /* Only flush once we caught up with the message stream, rather than after each message, so
+                 * that we don't fall behind on busy buses with a write() per message. */
+                fflush(stdout);
+
                 r = sd_bus_wait(bus, (uint64_t) -1);
                 if (r < 0)
                         return log_error_errno(r, "Failed to wait for bus: %m");
@@ -17,7 +17,9 @@
 #include "alloc-util.h"
 #include "bpf-firewall.h"
 #include "bpf-program.h"
+#include "cpu-set-util.h"
 #include "fd-util.h"
+#include "fileio.h"
 #include "ip-address-access.h"
 #include "memory-util.h"
 #include "missing_syscall.h"
@@ -290,6 +292,7 @@ static int bpf_firewall_compile_bpf(
                         BPF_LD_MAP_FD(BPF_REG_1, accounting_map_fd), /* load map fd to r1 */
                         BPF_RAW_INSN(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_map_lookup_elem),
                         BPF_JMP_IMM(BPF_JEQ, BPF_REG_0, 0, 2),
+                        /* The maps are per-CPU, hence this only touches this CPU's counter */
                         BPF_MOV64_IMM(BPF_REG_1, 1), /* r1 = 1 */
                         BPF_RAW_INSN(BPF_STX | BPF_XADD | BPF_DW, BPF_REG_0, BPF_REG_1, 0, 0), /* xadd r0 += r1 */
 
@@ -491,7 +494,7 @@ static int bpf_firewall_prepare_accounting_maps(Unit *u, bool enabled, int *fd_i
 
         if (enabled) {
                 if (*fd_ingress < 0) {
-                        r = bpf_map_new(BPF_MAP_TYPE_ARRAY, sizeof(int), sizeof(uint64_t), 2, 0);
+                        r = bpf_map_new(BPF_MAP_TYPE_PERCPU_ARRAY, sizeof(int), sizeof(uint64_t), 2, 0);
                         if (r < 0)
                                 return r;
 
@@ -500,7 +503,7 @@ static int bpf_firewall_prepare_accounting_maps(Unit *u, bool enabled, int *fd_i
 
                 if (*fd_egress < 0) {
 
-                        r = bpf_map_new(BPF_MAP_TYPE_ARRAY, sizeof(int), sizeof(uint64_t), 2, 0);
+                        r = bpf_map_new(BPF_MAP_TYPE_PERCPU_ARRAY, sizeof(int), sizeof(uint64_t), 2, 0);
                         if (r < 0)
                                 return r;
 
@@ -740,23 +743,73 @@ int bpf_firewall_install(Unit *u) {
         return 0;
 }
 
+static int accounting_map_n_cpus(void) {
+        static int cached = 0;
+        _cleanup_(cpu_set_reset) CPUSet cpus = {};
+        _cleanup_free_ char *s = NULL;
+        int r, n;
+
+        /* The accounting maps are per-CPU arrays. Looking up or updating an element of those always
+         * transfers one value for each possible CPU, hence we need to know how many there are. This
+         * never changes at runtime. */
+
+        if (cached > 0)
+                return cached;
+
+        r = read_one_line_file("/sys/devices/system/cpu/possible", &s);
+        if (r < 0)
+                return r;
+
+        r = parse_cpu_set(s, &cpus);
+        if (r < 0)
+                return r;
+
+        n = cpus.set ? CPU_COUNT_S(cpus.allocated, cpus.set) : 0;
+        if (n <= 0)
+                return -EINVAL;
+
+        return (cached = n);
+}
+
+static int read_accounting_value(int map_fd, uint64_t key, uint64_t *ret) {
+        _cleanup_free_ uint64_t *values = NULL;
+        uint64_t sum = 0;
+        int r, n;
+
+        n = accounting_map_n_cpus();
+        if (n < 0)
+                return n;
+
+        values = new(uint64_t, n);
+        if (!values)
+                return -ENOMEM;
+
+        r = bpf_map_lookup_element(map_fd, &key, values);
+        if (r < 0)
+                return r;
+
+        for (int i = 0; i < n; i++)
+                sum += values[i];
+
+        *ret = sum;
+        return 0;
+}
+
 int bpf_firewall_read_accounting(int map_fd, uint64_t *ret_bytes, uint64_t *ret_packets) {
-        uint64_t key, packets;
+        uint64_t packets;
         int r;
 
         if (map_fd < 0)
                 return -EBADF;
 
         if (ret_packets) {
-                key = MAP_KEY_PACKETS;
-                r = bpf_map_lookup_element(map_fd, &key, &packets);
+                r = read_accounting_value(map_fd, MAP_KEY_PACKETS, &packets);
                 if (r < 0)
                         return r;
         }
 
         if (ret_bytes) {
-                key = MAP_KEY_BYTES;
-                r = bpf_map_lookup_element(map_fd, &key, ret_bytes);
+                r = read_accounting_value(map_fd, MAP_KEY_BYTES, ret_bytes);
                 if (r < 0)
                         return r;
         }
@@ -768,19 +821,28 @@ int bpf_firewall_read_accounting(int map_fd, uint64_t *ret_bytes, uint64_t *ret_
 }
 
 int bpf_firewall_reset_accounting(int map_fd) {
-        uint64_t key, value = 0;
-        int r;
+        _cleanup_free_ uint64_t *zeroes = NULL;
+        uint64_t key;
+        int r, n;
 
         if (map_fd < 0)
                 return -EBADF;
 
+        n = accounting_map_n_cpus();
+        if (n < 0)
+                return n;
+
+        zeroes = new0(uint64_t, n);
+        if (!zeroes)
+                return -ENOMEM;
+
         key = MAP_KEY_PACKETS;
-        r = bpf_map_update_element(map_fd, &key, &value);
+        r = bpf_map_update_element(map_fd, &key, zeroes);
         if (r < 0)
                 return r;
 
         key = MAP_KEY_BYTES;
-        return bpf_map_update_element(map_fd, &key, &value);
+        return bpf_map_update_element(map_fd, &key, zeroes);
 }
 
 static int bpf_firewall_unsupported_reason = 0;
@@ -37,6 +37,9 @@
  * out specific attributes from us. */
 #define LOG_LEVEL_CGROUP_WRITE(r) (IN_SET(abs(r), ENOENT, EROFS, EACCES, EPERM) ? LOG_DEBUG : LOG_WARNING)
 
+/* Log at debug level if a cgroup empty or OOM notification sat in its queue for longer than this */
+#define CGROUP_QUEUE_SLOW_USEC ((usec_t) 100 * USEC_PER_MSEC)
+
 uint64_t tasks_max_resolve(const TasksMax *tasks_max) {
         if (tasks_max->scale == 0)
                 return tasks_max->value;
@@ -73,15 +76,76 @@ bool unit_has_host_root_cgroup(Unit *u) {
         return unit_has_name(u, SPECIAL_ROOT_SLICE);
 }
 
+static int cgroup_attribute_cache_put(Unit *u, const char *attribute, const char *value) {
+        _cleanup_free_ char *a = NULL, *v = NULL;
+        char *old;
+        int r;
+
+        assert(u);
+        assert(attribute);
+        assert(value);
+
+        v = strdup(value);
+        if (!v)
+                return -ENOMEM;
+
+        old = hashmap_get(u->cgroup_attribute_cache, attribute);
+        if (old) {
+                assert_se(hashmap_update(u->cgroup_attribute_cache, attribute, v) >= 0);
+                TAKE_PTR(v);
+                free(old);
+                return 0;
+        }
+
+        r = hashmap_ensure_allocated(&u->cgroup_attribute_cache, &string_hash_ops_free_free);
+        if (r < 0)
+                return r;
+
+        a = strdup(attribute);
+        if (!a)
+                return -ENOMEM;
+
+        r = hashmap_put(u->cgroup_attribute_cache, a, v);
+        if (r < 0)
+                return r;
+
+        TAKE_PTR(a);
+        TAKE_PTR(v);
+        return 0;
+}
+
+static void cgroup_attribute_cache_remove(Unit *u, const char *attribute) {
+        char *key = NULL;
+
+        assert(u);
+
+        free(hashmap_remove2(u->cgroup_attribute_cache, attribute, (void**) &key));
+        free(key);
+}
+
 static int set_attribute_and_warn(Unit *u, const char *controller, const char *attribute, const char *value) {
         int r;
 
+        /* Writing to cgroupfs is not free, and some attributes (e.g. memory.max) make the kernel do real
+         * work on every write. Hence skip the write if we already wrote the very same value the last
+         * time. The cache is flushed whenever we let go of the cgroup, see unit_release_cgroup(). */
+        if (streq_ptr(hashmap_get(u->cgroup_attribute_cache, attribute), value))
+                return 0;
+
         r = cg_set_attribute(controller, u->cgroup_path, attribute, value);
-        if (r < 0)
+        if (r < 0) {
                 log_unit_full_errno(u, LOG_LEVEL_CGROUP_WRITE(r), r, "Failed to set '%s' attribute on '%s' to '%.*s': %m",
                                     strna(attribute), isempty(u->cgroup_path) ? "/" : u->cgroup_path, (int) strcspn(value, NEWLINE), value);
 
-        return r;
+                /* We don't know what the attribute is set to now */
+                cgroup_attribute_cache_remove(u, attribute);
+                return r;
+        }
+
+        if (cgroup_attribute_cache_put(u, attribute, value) < 0)
+                cgroup_attribute_cache_remove(u, attribute);
+
+        return 0;
 }
 
 static void cgroup_compat_warn(void) {
@@ -1891,6 +1955,11 @@ static int unit_update_cgroup(
                         log_unit_warning_errno(u, r, "Failed to delete controller cgroups %s, ignoring: %m", u->cgroup_path);
         }
 
+        /* A freshly created cgroup (or controller hierarchy) starts out with the kernel's defaults, forget
+         * what we wrote to the old one */
+        if (created || migrate_mask != 0)
+                u->cgroup_attribute_cache = hashmap_free_free_free(u->cgroup_attribute_cache);
+
         /* Set attributes */
         cgroup_context_apply(u, target_mask, state);
         cgroup_xattr_apply(u);
@@ -2396,6 +2465,8 @@ void unit_release_cgroup(Unit *u) {
                 u->cgroup_path = mfree(u->cgroup_path);
         }
 
+        u->cgroup_attribute_cache = hashmap_free_free_free(u->cgroup_attribute_cache);
+
         if (u->cgroup_control_inotify_wd >= 0) {
                 if (inotify_rm_watch(u->manager->cgroup_inotify_fd, u->cgroup_control_inotify_wd) < 0)
                         log_unit_debug_errno(u, errno, "Failed to remove cgroup control inotify watch %i for %s, ignoring: %m", u->cgroup_control_inotify_wd, u->id);
@@ -2585,6 +2656,24 @@ int unit_watch_all_pids(Unit *u) {
         return unit_watch_pids_in_path(u, u->cgroup_path);
 }
 
+static void log_cgroup_queue_latency(Unit *u, const char *what, usec_t queued) {
+        char buf[FORMAT_TIMESPAN_MAX];
+        usec_t d;
+
+        assert(u);
+        assert(what);
+
+        /* On hosts where thousands of cgroups run empty at once the queues can grow long, let's make that
+         * visible, since every notification we delay delays the unit state change, too. */
+
+        d = usec_sub_unsigned(now(CLOCK_MONOTONIC), queued);
+        if (d < CGROUP_QUEUE_SLOW_USEC)
+                return;
+
+        log_unit_debug(u, "Processing cgroup %s notification, which was queued %s ago.",
+                       what, format_timespan(buf, sizeof(buf), d, USEC_PER_MSEC));
+}
+
 static int on_cgroup_empty_event(sd_event_source *s, void *userdata) {
         Manager *m = userdata;
         Unit *u;
@@ -2608,6 +2697,8 @@ static int on_cgroup_empty_event(sd_event_source *s, void *userdata) {
                         log_debug_errno(r, "Failed to reenable cgroup empty event source, ignoring: %m");
         }
 
+        log_cgroup_queue_latency(u, "empty", u->cgroup_empty_queue_timestamp);
+
         unit_add_to_gc_queue(u);
 
         if (UNIT_VTABLE(u)->notify_cgroup_empty)
@@ -2655,6 +2746,7 @@ void unit_add_to_cgroup_empty_queue(Unit *u) {
 
         LIST_PREPEND(cgroup_empty_queue, u->manager->cgroup_empty_queue, u);
         u->in_cgroup_empty_queue = true;
+        u->cgroup_empty_queue_timestamp = now(CLOCK_MONOTONIC);
 
         /* Trigger the defer event */
         r = sd_event_source_set_enabled(u->manager->cgroup_empty_event_source, SD_EVENT_ONESHOT);
@@ -2730,6 +2822,8 @@ static int on_cgroup_oom_event(sd_event_source *s, void *userdata) {
                         log_debug_errno(r, "Failed to reenable cgroup oom event source, ignoring: %m");
         }
 
+        log_cgroup_queue_latency(u, "OOM", u->cgroup_oom_queue_timestamp);
+
         (void) unit_check_oom(u);
         return 0;
 }
@@ -2746,6 +2840,7 @@ static void unit_add_to_cgroup_oom_queue(Unit *u) {
 
         LIST_PREPEND(cgroup_oom_queue, u->manager->cgroup_oom_queue, u);
         u->in_cgroup_oom_queue = true;
+        u->cgroup_oom_queue_timestamp = now(CLOCK_MONOTONIC);
 
         /* Trigger the defer event */
         if (!u->manager->cgroup_oom_event_source) {
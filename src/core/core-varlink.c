@@ -2,6 +2,8 @@
 
 #include "core-varlink.h"
 #include "mkdir.h"
+#include "path-util.h"
+#include "unit.h"
 #include "user-util.h"
 #include "varlink.h"
 
@@ -262,7 +264,115 @@ static int vl_method_get_memberships(Varlink *link, JsonVariant *parameters, Var
         return varlink_error(link, "io.systemd.UserDatabase.NoRecordFound", NULL);
 }
 
-int manager_varlink_init(Manager *m) {
+typedef struct ListUnitsParameters {
+        uint64_t since_generation;
+        sd_id128_t instance;
+} ListUnitsParameters;
+
+static int build_unit_json(Unit *u, JsonVariant **ret) {
+        uint64_t memory = UINT64_MAX, tasks = UINT64_MAX;
+        nsec_t cpu = NSEC_INFINITY;
+        pid_t main_pid, control_pid;
+
+        assert(u);
+        assert(ret);
+
+        /* These read from cgroupfs, and fail with -ENODATA if accounting is off, in which case we just
+         * leave the fields out */
+        (void) unit_get_memory_current(u, &memory);
+        (void) unit_get_tasks_current(u, &tasks);
+        (void) unit_get_cpu_usage(u, &cpu);
+
+        main_pid = unit_main_pid(u);
+        control_pid = unit_control_pid(u);
+
+        return json_build(ret, JSON_BUILD_OBJECT(
+                                   JSON_BUILD_PAIR("unit", JSON_BUILD_OBJECT(
+                                       JSON_BUILD_PAIR("id", JSON_BUILD_STRING(u->id)),
+                                       JSON_BUILD_PAIR("loadState", JSON_BUILD_STRING(unit_load_state_to_string(u->load_state))),
+                                       JSON_BUILD_PAIR("activeState", JSON_BUILD_STRING(unit_active_state_to_string(unit_active_state(u)))),
+                                       JSON_BUILD_PAIR("subState", JSON_BUILD_STRING(unit_sub_state_to_string(u))),
+                                       JSON_BUILD_PAIR("generation", JSON_BUILD_UNSIGNED(u->state_generation)),
+                                       JSON_BUILD_PAIR_CONDITION(dual_timestamp_is_set(&u->state_change_timestamp),
+                                                                 "stateChangeTimestamp", JSON_BUILD_UNSIGNED(u->state_change_timestamp.realtime)),
+                                       JSON_BUILD_PAIR_CONDITION(dual_timestamp_is_set(&u->inactive_exit_timestamp),
+                                                                 "inactiveExitTimestamp", JSON_BUILD_UNSIGNED(u->inactive_exit_timestamp.realtime)),
+                                       JSON_BUILD_PAIR_CONDITION(dual_timestamp_is_set(&u->active_enter_timestamp),
+                                                                 "activeEnterTimestamp", JSON_BUILD_UNSIGNED(u->active_enter_timestamp.realtime)),
+                                       JSON_BUILD_PAIR_CONDITION(dual_timestamp_is_set(&u->active_exit_timestamp),
+                                                                 "activeExitTimestamp", JSON_BUILD_UNSIGNED(u->active_exit_timestamp.realtime)),
+                                       JSON_BUILD_PAIR_CONDITION(dual_timestamp_is_set(&u->inactive_enter_timestamp),
+                                                                 "inactiveEnterTimestamp", JSON_BUILD_UNSIGNED(u->inactive_enter_timestamp.realtime)),
+                                       JSON_BUILD_PAIR_CONDITION(main_pid > 0, "mainPID", JSON_BUILD_UNSIGNED(main_pid)),
+                                       JSON_BUILD_PAIR_CONDITION(control_pid > 0, "controlPID", JSON_BUILD_UNSIGNED(control_pid)),
+                                       JSON_BUILD_PAIR_CONDITION(memory != UINT64_MAX, "memoryCurrent", JSON_BUILD_UNSIGNED(memory)),
+                                       JSON_BUILD_PAIR_CONDITION(tasks != UINT64_MAX, "tasksCurrent", JSON_BUILD_UNSIGNED(tasks)),
+                                       JSON_BUILD_PAIR_CONDITION(cpu != NSEC_INFINITY, "cpuUsageNSec", JSON_BUILD_UNSIGNED(cpu))))));
+}
+
+static int vl_method_list_units(Varlink *link, JsonVariant *parameters, VarlinkMethodFlags flags, void *userdata) {
+
+        static const JsonDispatch dispatch_table[] = {
+                { "sinceGeneration", JSON_VARIANT_UNSIGNED, json_dispatch_uint64, offsetof(ListUnitsParameters, since_generation), 0 },
+                { "instance",        JSON_VARIANT_STRING,   json_dispatch_id128,  offsetof(ListUnitsParameters, instance),         0 },
+                {}
+        };
+
+        ListUnitsParameters p = {};
+        Manager *m = userdata;
+        bool complete;
+        const char *k;
+        Unit *u;
+        int r;
+
+        assert(parameters);
+        assert(m);
+
+        /* Streams one reply per unit, followed by a final reply carrying the current generation. If
+         * "sinceGeneration" is specified only units that changed after that generation are sent. Resource
+         * usage counters changing alone don't count as a change. The generation counter restarts with each
+         * manager process (e.g. on daemon-reexec), hence it is only meaningful together with the
+         * "instance" ID of the reply that carried it. If units were removed since then, or the instance
+         * doesn't match, we can't express that as a delta, hence send everything and tell the client via
+         * "complete", so that it replaces its view instead of merging into it. */
+
+        r = json_dispatch(parameters, dispatch_table, NULL, 0, &p);
+        if (r < 0)
+                return r;
+
+        if (!FLAGS_SET(flags, VARLINK_METHOD_MORE))
+                return varlink_error(link, VARLINK_ERROR_EXPECTED_MORE, NULL);
+
+        complete = p.since_generation == 0 ||
+                !sd_id128_equal(p.instance, m->unit_state_instance_id) ||
+                p.since_generation < m->unit_removed_generation ||
+                p.since_generation > m->unit_state_generation;
+
+        HASHMAP_FOREACH_KEY(u, k, m->units) {
+                _cleanup_(json_variant_unrefp) JsonVariant *v = NULL;
+
+                if (k != u->id) /* Skip aliases */
+                        continue;
+
+                if (!complete && u->state_generation <= p.since_generation)
+                        continue;
+
+                r = build_unit_json(u, &v);
+                if (r < 0)
+                        return r;
+
+                r = varlink_notify(link, v);
+                if (r < 0)
+                        return r;
+        }
+
+        return varlink_replyb(link, JSON_BUILD_OBJECT(
+                                      JSON_BUILD_PAIR("generation", JSON_BUILD_UNSIGNED(m->unit_state_generation)),
+                                      JSON_BUILD_PAIR("instance", JSON_BUILD_ID128(m->unit_state_instance_id)),
+                                      JSON_BUILD_PAIR("complete", JSON_BUILD_BOOLEAN(complete))));
+}
+
+static int manager_varlink_init_userdb(Manager *m) {
         _cleanup_(varlink_server_unrefp) VarlinkServer *s = NULL;
         int r;
 
@@ -304,8 +414,68 @@ int manager_varlink_init(Manager *m) {
         return 0;
 }
 
+static int manager_varlink_init_unit(Manager *m) {
+        _cleanup_(varlink_server_unrefp) VarlinkServer *s = NULL;
+        int r;
+
+        assert(m);
+
+        /* The unit state interface lives on a server and socket of its own, so that its methods aren't
+         * reachable via the userdb socket and vice versa, and the connection limits of one don't affect
+         * the other. */
+
+        if (m->varlink_unit_server)
+                return 0;
+
+        r = varlink_server_new(&s, VARLINK_SERVER_ACCOUNT_UID);
+        if (r < 0)
+                return log_error_errno(r, "Failed to allocate varlink server object: %m");
+
+        varlink_server_set_userdata(s, m);
+
+        r = varlink_server_bind_method(s, "io.systemd.Unit.List", vl_method_list_units);
+        if (r < 0)
+                return log_error_errno(r, "Failed to register varlink methods: %m");
+
+        if (!MANAGER_IS_TEST_RUN(m)) {
+                _cleanup_free_ char *p = NULL;
+
+                /* That's /run/systemd/io.systemd.Unit for the system manager, and
+                 * $XDG_RUNTIME_DIR/systemd/io.systemd.Unit for user managers */
+                p = path_join(m->prefix[EXEC_DIRECTORY_RUNTIME], "systemd/io.systemd.Unit");
+                if (!p)
+                        return log_oom();
+
+                (void) mkdir_parents_label(p, 0755);
+
+                r = varlink_server_listen_address(s, p, MANAGER_IS_SYSTEM(m) ? 0666 : 0600);
+                if (r < 0)
+                        return log_error_errno(r, "Failed to bind to varlink socket: %m");
+        }
+
+        r = varlink_server_attach_event(s, m->event, SD_EVENT_PRIORITY_NORMAL);
+        if (r < 0)
+                return log_error_errno(r, "Failed to attach varlink connection to event loop: %m");
+
+        m->varlink_unit_server = TAKE_PTR(s);
+        return 0;
+}
+
+int manager_varlink_init(Manager *m) {
+        int r;
+
+        assert(m);
+
+        r = manager_varlink_init_userdb(m);
+        if (r < 0)
+                return r;
+
+        return manager_varlink_init_unit(m);
+}
+
 void manager_varlink_done(Manager *m) {
         assert(m);
 
         m->varlink_server = varlink_server_unref(m->varlink_server);
+        m->varlink_unit_server = varlink_server_unref(m->varlink_unit_server);
 }
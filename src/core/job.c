@@ -1235,9 +1235,9 @@ int job_deserialize(Job *j, FILE *f) {
                 char *l, *v;
                 size_t k;
 
-                r = read_line(f, LONG_LINE_MAX, &line);
+                r = read_serialization_line(f, &line);
                 if (r < 0)
-                        return log_error_errno(r, "Failed to read serialization line: %m");
+                        return r;
                 if (r == 0)
                         return 0;
 
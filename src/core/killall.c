@@ -5,18 +5,23 @@
 
 #include <errno.h>
 #include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include "alloc-util.h"
 #include "def.h"
 #include "dirent-util.h"
+#include "errno-util.h"
 #include "fd-util.h"
 #include "format-util.h"
+#include "hashmap.h"
+#include "io-util.h"
 #include "killall.h"
+#include "missing_syscall.h"
 #include "parse-util.h"
 #include "process-util.h"
-#include "set.h"
 #include "string-util.h"
 #include "terminal-util.h"
 #include "util.h"
@@ -77,11 +82,34 @@ static bool ignore_proc(pid_t pid, bool warn_rootfs) {
         return true;
 }
 
-static void log_children_no_yet_killed(Set *pids) {
-        _cleanup_free_ char *lst_child = NULL;
+/* The PIDs we wait for are kept in a Hashmap, mapping each PID to a pidfd referring to it, if we got one,
+ * or -1 otherwise. */
+
+static void pids_remove(Hashmap *pids, pid_t pid) {
+        void *p;
+
+        p = hashmap_remove(pids, PID_TO_PTR(pid));
+        if (p)
+                safe_close(PTR_TO_FD(p));
+}
+
+static Hashmap* pids_free(Hashmap *pids) {
         void *p;
 
-        SET_FOREACH(p, pids) {
+        HASHMAP_FOREACH(p, pids)
+                safe_close(PTR_TO_FD(p));
+
+        return hashmap_free(pids);
+}
+
+DEFINE_TRIVIAL_CLEANUP_FUNC(Hashmap*, pids_free);
+
+static void log_children_no_yet_killed(Hashmap *pids) {
+        _cleanup_free_ char *lst_child = NULL;
+        const void *p;
+        void *v;
+
+        HASHMAP_FOREACH_KEY(v, p, pids) {
                 _cleanup_free_ char *s = NULL;
 
                 if (get_process_comm(PTR_TO_PID(p), &s) < 0)
@@ -99,17 +127,53 @@ static void log_children_no_yet_killed(Set *pids) {
         log_warning("Waiting for process: %s", lst_child + 2);
 }
 
-static int wait_for_children(Set *pids, sigset_t *mask, usec_t timeout) {
+static int wait_for_children(Hashmap *pids, sigset_t *mask, usec_t timeout) {
+        _cleanup_close_ int epoll_fd = -1, signal_fd = -1;
         usec_t until, date_log_child, n;
+        const void *k;
+        void *p;
 
         assert(mask);
 
         /* Return the number of children remaining in the pids set: That correspond to the number
          * of processes still "alive" after the timeout */
 
-        if (set_isempty(pids))
+        if (hashmap_isempty(pids))
                 return 0;
 
+        /* Watch the pidfds of all processes we got one for via epoll, which tells us about the exit of
+         * processes that aren't our children too, without having to check each of them with kill().
+         * SIGCHLD is added to the same epoll set via a signalfd, for the remaining processes. If any of
+         * this fails, we fall back to sigtimedwait() and kill(pid, 0) for everything. */
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd >= 0)
+                signal_fd = signalfd(-1, mask, SFD_NONBLOCK|SFD_CLOEXEC);
+        if (signal_fd >= 0 &&
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &(struct epoll_event) { .events = EPOLLIN }) < 0)
+                signal_fd = safe_close(signal_fd);
+        if (signal_fd < 0) {
+                log_debug_errno(errno, "Failed to set up epoll for waiting for processes, falling back to sigtimedwait(): %m");
+                epoll_fd = safe_close(epoll_fd);
+        }
+
+        HASHMAP_FOREACH_KEY(p, k, pids) {
+                int fd = PTR_TO_FD(p);
+
+                if (fd < 0)
+                        continue;
+
+                /* PID 0 is used for the signalfd, hence PIDs are always distinguishable from it */
+                if (epoll_fd >= 0 &&
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &(struct epoll_event) {
+                                    .events = EPOLLIN,
+                                    .data.u64 = PTR_TO_PID(k),
+                            }) >= 0)
+                        continue;
+
+                safe_close(fd);
+                assert_se(hashmap_update(pids, k, FD_TO_PTR(-1)) >= 0);
+        }
+
         n = now(CLOCK_MONOTONIC);
         until = usec_add(n, timeout);
         date_log_child = usec_add(n, 10u * USEC_PER_SEC);
@@ -118,8 +182,7 @@ static int wait_for_children(Set *pids, sigset_t *mask, usec_t timeout) {
 
         for (;;) {
                 struct timespec ts;
-                int k;
-                void *p;
+                int r;
 
                 /* First, let the kernel inform us about killed
                  * children. Most processes will probably be our
@@ -138,25 +201,29 @@ static int wait_for_children(Set *pids, sigset_t *mask, usec_t timeout) {
                                 return log_error_errno(errno, "waitpid() failed: %m");
                         }
 
-                        (void) set_remove(pids, PID_TO_PTR(pid));
+                        pids_remove(pids, pid);
                 }
 
                 /* Now explicitly check who might be remaining, who
-                 * might not be our child. */
-                SET_FOREACH(p, pids) {
+                 * might not be our child, unless we are told about
+                 * that via the pidfd anyway. */
+                HASHMAP_FOREACH_KEY(p, k, pids) {
+
+                        if (PTR_TO_FD(p) >= 0)
+                                continue;
 
                         /* kill(pid, 0) sends no signal, but it tells
                          * us whether the process still exists. */
-                        if (kill(PTR_TO_PID(p), 0) == 0)
+                        if (kill(PTR_TO_PID(k), 0) == 0)
                                 continue;
 
                         if (errno != ESRCH)
                                 continue;
 
-                        set_remove(pids, p);
+                        pids_remove(pids, PTR_TO_PID(k));
                 }
 
-                if (set_isempty(pids))
+                if (hashmap_isempty(pids))
                         return 0;
 
                 n = now(CLOCK_MONOTONIC);
@@ -167,26 +234,53 @@ static int wait_for_children(Set *pids, sigset_t *mask, usec_t timeout) {
                 }
 
                 if (n >= until)
-                        return set_size(pids);
+                        return hashmap_size(pids);
 
                 if (date_log_child > 0)
                         timespec_store(&ts, MIN(until - n, date_log_child - n));
                 else
                         timespec_store(&ts, until - n);
 
-                k = sigtimedwait(mask, NULL, &ts);
-                if (k != SIGCHLD) {
+                if (epoll_fd >= 0) {
+                        struct epoll_event events[64];
+                        int n_events;
+
+                        n_events = epoll_wait(epoll_fd, events, ELEMENTSOF(events),
+                                              DIV_ROUND_UP(timespec_load(&ts), USEC_PER_MSEC));
+                        if (n_events < 0) {
+                                if (errno == EINTR)
+                                        continue;
+
+                                return log_error_errno(errno, "epoll_wait() failed: %m");
+                        }
+
+                        for (int i = 0; i < n_events; i++) {
+                                if (events[i].data.u64 == 0) {
+                                        /* SIGCHLD, children are reaped at the beginning of the loop */
+                                        (void) flush_fd(signal_fd);
+                                        continue;
+                                }
+
+                                /* Closing the pidfd also removes it from the epoll set */
+                                pids_remove(pids, (pid_t) events[i].data.u64);
+                        }
 
-                        if (k < 0 && errno != EAGAIN)
+                        continue;
+                }
+
+                r = sigtimedwait(mask, NULL, &ts);
+                if (r != SIGCHLD) {
+
+                        if (r < 0 && errno != EAGAIN)
                                 return log_error_errno(errno, "sigtimedwait() failed: %m");
 
-                        if (k >= 0)
+                        if (r >= 0)
                                 log_warning("sigtimedwait() returned unexpected signal.");
                 }
         }
 }
 
-static int killall(int sig, Set *pids, bool send_sighup) {
+static int killall(int sig, Hashmap *pids, bool send_sighup) {
         _cleanup_closedir_ DIR *dir = NULL;
         struct dirent *d;
         int n_killed = 0;
@@ -199,6 +293,7 @@ static int killall(int sig, Set *pids, bool send_sighup) {
                 return log_warning_errno(errno, "opendir(/proc) failed: %m");
 
         FOREACH_DIRENT_ALL(d, dir, break) {
+                _cleanup_close_ int pidfd = -1;
                 pid_t pid;
                 int r;
 
@@ -218,12 +313,23 @@ static int killall(int sig, Set *pids, bool send_sighup) {
                         log_notice("Sending SIGKILL to PID "PID_FMT" (%s).", pid, strna(s));
                 }
 
+                if (pids) {
+                        /* All processes are stopped right now, hence the PID can't be recycled between
+                         * opening the pidfd and sending the signal. Not having a pidfd is not fatal, we
+                         * fall back to checking with kill(pid, 0) in that case. */
+                        pidfd = pidfd_open(pid, 0);
+                        if (pidfd < 0 && !ERRNO_IS_NOT_SUPPORTED(errno) && errno != ESRCH)
+                                log_debug_errno(errno, "Failed to open pidfd for PID " PID_FMT ", ignoring: %m", pid);
+                }
+
                 if (kill(pid, sig) >= 0) {
                         n_killed++;
                         if (pids) {
-                                r = set_put(pids, PID_TO_PTR(pid));
+                                r = hashmap_put(pids, PID_TO_PTR(pid), FD_TO_PTR(pidfd));
                                 if (r < 0)
                                         log_oom();
+                                else
+                                        TAKE_FD(pidfd);
                         }
                 } else if (errno != ENOENT)
                         log_warning_errno(errno, "Could not kill %d: %m", pid);
@@ -251,7 +357,7 @@ static int killall(int sig, Set *pids, bool send_sighup) {
 int broadcast_signal(int sig, bool wait_for_exit, bool send_sighup, usec_t timeout) {
         int n_children_left;
         sigset_t mask, oldmask;
-        _cleanup_set_free_ Set *pids = NULL;
+        _cleanup_(pids_freep) Hashmap *pids = NULL;
 
         /* Send the specified signal to all remaining processes, if not excluded by ignore_proc().
          * Return:
@@ -260,7 +366,7 @@ int broadcast_signal(int sig, bool wait_for_exit, bool send_sighup, usec_t timeo
          *  - Otherwise, the number of processes to which the specified signal was sent */
 
         if (wait_for_exit)
-                pids = set_new(NULL);
+                pids = hashmap_new(NULL);
 
         assert_se(sigemptyset(&mask) == 0);
         assert_se(sigaddset(&mask, SIGCHLD) == 0);
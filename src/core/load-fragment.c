@@ -5367,14 +5367,9 @@ int unit_load_fragment(Unit *u) {
                 return 0;
         }
 
-        /* Possibly rebuild the fragment map to catch new units */
-        r = unit_file_build_name_map(&u->manager->lookup_paths,
-                                     &u->manager->unit_cache_timestamp_hash,
-                                     &u->manager->unit_id_map,
-                                     &u->manager->unit_name_map,
-                                     &u->manager->unit_path_cache);
+        r = manager_update_unit_name_map(u->manager);
         if (r < 0)
-                return log_error_errno(r, "Failed to rebuild name map: %m");
+                return r;
 
         r = unit_file_find_fragment(u->manager->unit_id_map,
                                     u->manager->unit_name_map,
@@ -5392,9 +5387,9 @@ int unit_load_fragment(Unit *u) {
                 /* Try to open the file name. A symlink is OK, for example for linked files or masks. We
                  * expect that all symlinks within the lookup paths have been already resolved, but we don't
                  * verify this here. */
-                f = fopen(fragment, "re");
-                if (!f)
-                        return log_unit_notice_errno(u, errno, "Failed to open %s: %m", fragment);
+                r = fopen_unlocked(fragment, "re", &f);
+                if (r < 0)
+                        return log_unit_notice_errno(u, r, "Failed to open %s: %m", fragment);
 
                 if (fstat(fileno(f), &st) < 0)
                         return -errno;
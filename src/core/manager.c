@@ -38,6 +38,7 @@
 #include "dirent-util.h"
 #include "env-util.h"
 #include "escape.h"
+#include "event-util.h"
 #include "exec-util.h"
 #include "execute.h"
 #include "exit-status.h"
@@ -87,12 +88,18 @@
 #define NOTIFY_RCVBUF_SIZE (8*1024*1024)
 #define CGROUPS_AGENT_RCVBUF_SIZE (8*1024*1024)
 
+/* How many notification messages to process at most before returning to the event loop */
+#define NOTIFY_MESSAGES_PER_WAKEUP_MAX 16U
+
 /* Initial delay and the interval for printing status messages about running jobs */
 #define JOBS_IN_PROGRESS_WAIT_USEC (2*USEC_PER_SEC)
 #define JOBS_IN_PROGRESS_QUIET_WAIT_USEC (25*USEC_PER_SEC)
 #define JOBS_IN_PROGRESS_PERIOD_USEC (USEC_PER_SEC / 3)
 #define JOBS_IN_PROGRESS_PERIOD_DIVISOR 3
 
+/* GC passes taking longer than this are logged */
+#define GC_UNIT_QUEUE_SLOW_USEC (100*USEC_PER_MSEC)
+
 /* If there are more than 1K bus messages queue across our API and direct buses, then let's not add more on top until
  * the queue gets more empty. */
 #define MANAGER_BUS_BUSY_THRESHOLD 1024LU
@@ -705,6 +712,7 @@ static void manager_free_unit_name_maps(Manager *m) {
         m->unit_name_map = hashmap_free(m->unit_name_map);
         m->unit_path_cache = set_free(m->unit_path_cache);
         m->unit_cache_timestamp_hash = 0;
+        m->unit_cache_iteration = UINT64_MAX;
 }
 
 static int manager_setup_run_queue(Manager *m) {
@@ -767,6 +775,7 @@ int manager_new(UnitFileScope scope, ManagerTestRunFlags test_run_flags, Manager
 
         *m = (Manager) {
                 .unit_file_scope = scope,
+                .unit_cache_iteration = UINT64_MAX,
                 .objective = _MANAGER_OBJECTIVE_INVALID,
 
                 .status_unit_format = STATUS_UNIT_FORMAT_DEFAULT,
@@ -859,6 +868,10 @@ int manager_new(UnitFileScope scope, ManagerTestRunFlags test_run_flags, Manager
         if (r < 0)
                 return r;
 
+        r = sd_id128_randomize(&m->unit_state_instance_id);
+        if (r < 0)
+                return r;
+
         e = secure_getenv("CREDENTIALS_DIRECTORY");
         if (e) {
                 m->received_credentials = strdup(e);
@@ -1222,13 +1235,19 @@ good:
 }
 
 static unsigned manager_dispatch_gc_unit_queue(Manager *m) {
-        unsigned n = 0, gc_marker;
+        unsigned n = 0, n_collected = 0, gc_marker;
+        usec_t begin, d;
         Unit *u;
 
         assert(m);
 
         /* log_debug("Running GC..."); */
 
+        if (!m->gc_unit_queue)
+                return 0;
+
+        begin = now(CLOCK_MONOTONIC);
+
         m->gc_marker += _GC_OFFSET_MAX;
         if (m->gc_marker + _GC_OFFSET_MAX <= _GC_OFFSET_MAX)
                 m->gc_marker = 1;
@@ -1251,9 +1270,21 @@ static unsigned manager_dispatch_gc_unit_queue(Manager *m) {
                                 log_unit_debug(u, "Collecting.");
                         u->gc_marker = gc_marker + GC_OFFSET_BAD;
                         unit_add_to_cleanup_queue(u);
+                        n_collected++;
                 }
         }
 
+        d = usec_sub_unsigned(now(CLOCK_MONOTONIC), begin);
+        m->gc_unit_queue_passes++;
+        m->gc_unit_queue_usec = usec_add(m->gc_unit_queue_usec, d);
+
+        if (d >= GC_UNIT_QUEUE_SLOW_USEC) {
+                char buf[FORMAT_TIMESPAN_MAX];
+
+                log_debug("Unit GC pass checked %u units and collected %u in %s.",
+                          n, n_collected, format_timespan(buf, sizeof(buf), d, USEC_PER_MSEC));
+        }
+
         return n;
 }
 
@@ -1940,6 +1971,33 @@ unsigned manager_dispatch_load_queue(Manager *m) {
         return n;
 }
 
+int manager_update_unit_name_map(Manager *m) {
+        uint64_t iteration = 0;
+        int r;
+
+        assert(m);
+
+        /* Possibly rebuild the fragment map to catch new units. Checking whether that's necessary means
+         * stat()ing all unit search paths, which adds up when many units are loaded at once (e.g. thousands
+         * of template instances pulled in by a single transaction), hence do this only once per event loop
+         * iteration. */
+
+        (void) sd_event_get_iteration(m->event, &iteration);
+        if (iteration == m->unit_cache_iteration)
+                return 0;
+
+        r = unit_file_build_name_map(&m->lookup_paths,
+                                     &m->unit_cache_timestamp_hash,
+                                     &m->unit_id_map,
+                                     &m->unit_name_map,
+                                     &m->unit_path_cache);
+        if (r < 0)
+                return log_error_errno(r, "Failed to rebuild name map: %m");
+
+        m->unit_cache_iteration = iteration;
+        return 0;
+}
+
 bool manager_unit_cache_should_retry_load(Unit *u) {
         assert(u);
 
@@ -1955,7 +2013,13 @@ bool manager_unit_cache_should_retry_load(Unit *u) {
                 return true;
 
         /* The cache needs to be updated because there are modifications on disk. */
-        return !lookup_paths_timestamp_hash_same(&u->manager->lookup_paths, u->manager->unit_cache_timestamp_hash, NULL);
+        if (lookup_paths_timestamp_hash_same(&u->manager->lookup_paths, u->manager->unit_cache_timestamp_hash, NULL))
+                return false;
+
+        /* Make sure the next load actually rebuilds the cache, even if it was checked in this event loop
+         * iteration already */
+        u->manager->unit_cache_iteration = UINT64_MAX;
+        return true;
 }
 
 int manager_load_unit_prepare(
@@ -2128,8 +2192,20 @@ void manager_dump(Manager *m, FILE *f, const char *prefix) {
                                                                 format_timespan(buf, sizeof buf, t->monotonic, 1));
         }
 
+        if (m->gc_unit_queue_passes > 0) {
+                char buf[FORMAT_TIMESPAN_MAX], buf2[FORMAT_TIMESPAN_MAX];
+
+                fprintf(f, "%sUnit GC: %u passes, %s total, %s per pass\n",
+                        strempty(prefix),
+                        m->gc_unit_queue_passes,
+                        format_timespan(buf, sizeof buf, m->gc_unit_queue_usec, 1),
+                        format_timespan(buf2, sizeof buf2, m->gc_unit_queue_usec / m->gc_unit_queue_passes, 1));
+        }
+
         manager_dump_units(m, f, prefix);
         manager_dump_jobs(m, f, prefix);
+
+        event_dump_source_stats(m->event, f, prefix);
 }
 
 int manager_get_dump_string(Manager *m, char **ret) {
@@ -2349,10 +2425,9 @@ static void manager_invoke_notify_message(
         }
 }
 
-static int manager_dispatch_notify_fd(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
+static int manager_process_notify_message(Manager *m) {
 
         _cleanup_fdset_free_ FDSet *fds = NULL;
-        Manager *m = userdata;
         char buf[NOTIFY_BUFFER_MAX+1];
         struct iovec iovec = {
                 .iov_base = buf,
@@ -2378,16 +2453,13 @@ static int manager_dispatch_notify_fd(sd_event_source *source, int fd, uint32_t
         ssize_t n;
 
         assert(m);
-        assert(m->notify_fd == fd);
 
-        if (revents != EPOLLIN) {
-                log_warning("Got unexpected poll event for notify fd.");
-                return 0;
-        }
+        /* Returns -EAGAIN or -EINTR if there was no message to read, and other negative errors only if
+         * reading failed fatally. Problems with the message itself are logged and ignored. */
 
         n = recvmsg_safe(m->notify_fd, &msghdr, MSG_DONTWAIT|MSG_CMSG_CLOEXEC|MSG_TRUNC);
         if (IN_SET(n, -EAGAIN, -EINTR))
-                return 0; /* Spurious wakeup, try again */
+                return n;
         if (n < 0)
                 /* If this is any other, real error, then let's stop processing this socket. This of course
                  * means we won't take notification messages anymore, but that's still better than busy
@@ -2493,6 +2565,32 @@ static int manager_dispatch_notify_fd(sd_event_source *source, int fd, uint32_t
         return 0;
 }
 
+static int manager_dispatch_notify_fd(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
+        Manager *m = userdata;
+        int r;
+
+        assert(m);
+        assert(m->notify_fd == fd);
+
+        if (revents != EPOLLIN) {
+                log_warning("Got unexpected poll event for notify fd.");
+                return 0;
+        }
+
+        /* Process a couple of queued notification messages per wakeup, so that services sending many
+         * notifications don't cost us a full event loop iteration each, while still returning to the event
+         * loop regularly so that other sources are not starved. */
+        for (unsigned i = 0; i < NOTIFY_MESSAGES_PER_WAKEUP_MAX; i++) {
+                r = manager_process_notify_message(m);
+                if (IN_SET(r, -EAGAIN, -EINTR))
+                        return 0; /* Spurious wakeup or queue drained, try again */
+                if (r < 0)
+                        return r;
+        }
+
+        return 0;
+}
+
 static void manager_invoke_sigchld_event(
                 Manager *m,
                 Unit *u,
@@ -3139,6 +3237,7 @@ void manager_send_unit_plymouth(Manager *m, Unit *u) {
 int manager_open_serialization(Manager *m, FILE **_f) {
         _cleanup_close_ int fd = -1;
         FILE *f;
+        int r;
 
         assert(_f);
 
@@ -3146,9 +3245,11 @@ int manager_open_serialization(Manager *m, FILE **_f) {
         if (fd < 0)
                 return fd;
 
-        f = take_fdopen(&fd, "w+");
-        if (!f)
-                return -errno;
+        /* The state of all units is written and read back line by line through this stream, and nothing
+         * else has access to it, hence don't bother with locking it for each call. */
+        r = take_fdopen_unlocked(&fd, "w+", &f);
+        if (r < 0)
+                return r;
 
         *_f = f;
         return 0;
@@ -3358,9 +3459,9 @@ static int manager_deserialize_units(Manager *m, FILE *f, FDSet *fds) {
         for (;;) {
                 _cleanup_free_ char *line = NULL;
                 /* Start marker */
-                r = read_line(f, LONG_LINE_MAX, &line);
+                r = read_serialization_line(f, &line);
                 if (r < 0)
-                        return log_error_errno(r, "Failed to read serialization line: %m");
+                        return r;
                 if (r == 0)
                         break;
 
@@ -3504,9 +3605,9 @@ int manager_deserialize(Manager *m, FILE *f, FDSet *fds) {
                 _cleanup_free_ char *line = NULL;
                 const char *val, *l;
 
-                r = read_line(f, LONG_LINE_MAX, &line);
+                r = read_serialization_line(f, &line);
                 if (r < 0)
-                        return log_error_errno(r, "Failed to read serialization line: %m");
+                        return r;
                 if (r == 0)
                         break;
 
@@ -234,6 +234,8 @@ struct Manager {
         Hashmap *unit_name_map;
         Set *unit_path_cache;
         uint64_t unit_cache_timestamp_hash;
+        /* The event loop iteration in which the unit name maps were last checked against the lookup paths */
+        uint64_t unit_cache_iteration;
 
         char **transient_environment;  /* The environment, as determined from config files, kernel cmdline and environment generators */
         char **client_environment;     /* Environment variables created by clients through the bus API */
@@ -250,10 +252,14 @@ struct Manager {
         /* Data specific to the mount subsystem */
         struct libmnt_monitor *mount_monitor;
         sd_event_source *mount_event_source;
+        sd_event_source *mount_ratelimit_event_source;
+        RateLimit mount_ratelimit;
 
         /* Data specific to the swap filesystem */
         FILE *proc_swaps;
         sd_event_source *swap_event_source;
+        sd_event_source *swap_ratelimit_event_source;
+        RateLimit swap_ratelimit;
         Hashmap *swaps_by_devnode;
 
         /* Data specific to the D-Bus subsystem */
@@ -307,6 +313,10 @@ struct Manager {
 
         unsigned gc_marker;
 
+        /* Statistics about the unit GC queue passes, shown in the dump */
+        unsigned gc_unit_queue_passes;
+        usec_t gc_unit_queue_usec;
+
         /* The stat() data the last time we saw /etc/localtime */
         usec_t etc_localtime_mtime;
         bool etc_localtime_accessible:1;
@@ -434,6 +444,14 @@ struct Manager {
         bool honor_device_enumeration;
 
         VarlinkServer *varlink_server;
+        VarlinkServer *varlink_unit_server;
+
+        /* Bumped whenever any unit changes in a way visible on the bus, and whenever a unit is removed,
+         * for the "changes since" mode of io.systemd.Unit.List. The counters start from zero in each
+         * manager process, hence they are qualified by a random ID clients need to pass back to us. */
+        uint64_t unit_state_generation;
+        uint64_t unit_removed_generation;
+        sd_id128_t unit_state_instance_id;
 };
 
 static inline usec_t manager_default_timeout_abort_usec(Manager *m) {
@@ -465,6 +483,7 @@ Unit *manager_get_unit(Manager *m, const char *name);
 int manager_get_job_from_dbus_path(Manager *m, const char *s, Job **_j);
 
 bool manager_unit_cache_should_retry_load(Unit *u);
+int manager_update_unit_name_map(Manager *m);
 int manager_load_unit_prepare(Manager *m, const char *name, const char *path, sd_bus_error *e, Unit **_ret);
 int manager_load_unit(Manager *m, const char *name, const char *path, sd_bus_error *e, Unit **_ret);
 int manager_load_startable_unit_or_warn(Manager *m, const char *name, const char *path, Unit **ret);
@@ -34,6 +34,10 @@
 
 #define RETRY_UMOUNT_MAX 32
 
+/* Process at most this many mount table changes per interval, see mount_dispatch_io() */
+#define MOUNT_RATELIMIT_INTERVAL_USEC (1 * USEC_PER_SEC)
+#define MOUNT_RATELIMIT_BURST 5U
+
 static const UnitActiveState state_translation_table[_MOUNT_STATE_MAX] = {
         [MOUNT_DEAD] = UNIT_INACTIVE,
         [MOUNT_MOUNTING] = UNIT_ACTIVATING,
@@ -1762,6 +1766,7 @@ static void mount_shutdown(Manager *m) {
         assert(m);
 
         m->mount_event_source = sd_event_source_unref(m->mount_event_source);
+        m->mount_ratelimit_event_source = sd_event_source_unref(m->mount_ratelimit_event_source);
 
         mnt_unref_monitor(m->mount_monitor);
         m->mount_monitor = NULL;
@@ -1864,6 +1869,8 @@ static void mount_enumerate(Manager *m) {
                 }
 
                 (void) sd_event_source_set_description(m->mount_event_source, "mount-monitor-dispatch");
+
+                m->mount_ratelimit = (RateLimit) { MOUNT_RATELIMIT_INTERVAL_USEC, MOUNT_RATELIMIT_BURST };
         }
 
         r = mount_load_proc_self_mountinfo(m, false);
@@ -2010,13 +2017,58 @@ static int mount_process_proc_self_mountinfo(Manager *m) {
         return 0;
 }
 
+static int mount_dispatch_ratelimit_expired(sd_event_source *source, usec_t usec, void *userdata) {
+        Manager *m = userdata;
+        int r;
+
+        assert(m);
+
+        m->mount_ratelimit_event_source = sd_event_source_unref(m->mount_ratelimit_event_source);
+
+        r = sd_event_source_set_enabled(m->mount_event_source, SD_EVENT_ON);
+        if (r < 0)
+                log_warning_errno(r, "Failed to resume watching mount changes, ignoring: %m");
+
+        /* Pick up everything that changed while we weren't looking, in one go */
+        return mount_process_proc_self_mountinfo(m);
+}
+
 static int mount_dispatch_io(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
         Manager *m = userdata;
+        int r;
 
         assert(m);
         assert(revents & EPOLLIN);
 
-        return mount_process_proc_self_mountinfo(m);
+        /* Every change means reparsing the whole mount table, which gets expensive with many mounts. If
+         * mounts are changing more frequently than our rate limit allows, stop watching until the rate
+         * limit interval is over, so that a mount storm is coalesced into a single rescan. Note that the
+         * changes caused by our own mount jobs are picked up from the SIGCHLD handler anyway. */
+        if (ratelimit_below(&m->mount_ratelimit))
+                return mount_process_proc_self_mountinfo(m);
+
+        if (m->mount_ratelimit_event_source)
+                return 0;
+
+        r = sd_event_add_time(m->event, &m->mount_ratelimit_event_source, CLOCK_MONOTONIC,
+                              usec_add(m->mount_ratelimit.begin, m->mount_ratelimit.interval), 0,
+                              mount_dispatch_ratelimit_expired, m);
+        if (r < 0) {
+                log_warning_errno(r, "Failed to install mount rate limit timer, processing mount changes right-away: %m");
+                return mount_process_proc_self_mountinfo(m);
+        }
+
+        (void) sd_event_source_set_description(m->mount_ratelimit_event_source, "mount-monitor-ratelimit");
+
+        r = sd_event_source_set_enabled(m->mount_event_source, SD_EVENT_OFF);
+        if (r < 0) {
+                m->mount_ratelimit_event_source = sd_event_source_unref(m->mount_ratelimit_event_source);
+                log_warning_errno(r, "Failed to suspend watching mount changes, processing them right-away: %m");
+                return mount_process_proc_self_mountinfo(m);
+        }
+
+        log_debug("Mount table is changing rapidly, delaying processing of mount changes.");
+        return 0;
 }
 
 static void mount_reset_failed(Unit *u) {
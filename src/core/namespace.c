@@ -959,7 +959,7 @@ static int mount_images(const MountEntry *m) {
         r = loop_device_make_by_path(
                         mount_entry_source(m),
                         m->read_only ? O_RDONLY : -1 /* < 0 means writable if possible, read-only as fallback */,
-                        verity.data_path ? 0 : LO_FLAGS_PARTSCAN,
+                        LO_FLAGS_DIRECT_IO | (verity.data_path ? 0 : LO_FLAGS_PARTSCAN),
                         &loop_device);
         if (r < 0)
                 return log_debug_errno(r, "Failed to create loop device for image: %m");
@@ -1515,10 +1515,12 @@ int setup_namespace(
 
                 SET_FLAG(dissect_image_flags, DISSECT_IMAGE_NO_PARTITION_TABLE, verity.data_path);
 
+                /* Use direct IO on the backing file, so that the image isn't cached twice: once for the
+                 * image file itself and once more for the loopback block device on top. */
                 r = loop_device_make_by_path(
                                 root_image,
                                 FLAGS_SET(dissect_image_flags, DISSECT_IMAGE_READ_ONLY) ? O_RDONLY : -1 /* < 0 means writable if possible, read-only as fallback */,
-                                FLAGS_SET(dissect_image_flags, DISSECT_IMAGE_NO_PARTITION_TABLE) ? 0 : LO_FLAGS_PARTSCAN,
+                                LO_FLAGS_DIRECT_IO | (FLAGS_SET(dissect_image_flags, DISSECT_IMAGE_NO_PARTITION_TABLE) ? 0 : LO_FLAGS_PARTSCAN),
                                 &loop_device);
                 if (r < 0)
                         return log_debug_errno(r, "Failed to create loop device for root image: %m");
@@ -405,6 +405,11 @@ static int path_watch(Path *p) {
         assert(p);
 
         LIST_FOREACH(spec, s, p->specs) {
+                /* Specs that are still watched are left as they are: nothing happened to them, or their
+                 * inotify fd would have an event queued, which is then dispatched on its own. */
+                if (s->inotify_fd >= 0)
+                        continue;
+
                 r = path_spec_watch(s, path_dispatch_io);
                 if (r < 0)
                         return r;
@@ -732,8 +737,12 @@ static int path_dispatch_io(sd_event_source *source, int fd, uint32_t revents, v
 
         if (changed)
                 path_enter_running(p);
-        else
+        else {
+                /* Something happened to one of the watched path components, hence the watches of this
+                 * spec need to be set up again. The other specs of the unit are not affected. */
+                path_spec_unwatch(s);
                 path_enter_waiting(p, false, false);
+        }
 
         return 0;
 
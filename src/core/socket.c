@@ -5,6 +5,7 @@
 #include <fcntl.h>
 #include <mqueue.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <sys/epoll.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -46,6 +47,9 @@
 #include "unit.h"
 #include "user-util.h"
 
+/* How many connections to accept at most on an Accept=yes socket before returning to the event loop */
+#define SOCKET_ACCEPT_PER_WAKEUP_MAX 16U
+
 struct SocketPeer {
         unsigned n_ref;
 
@@ -2993,13 +2997,34 @@ static int socket_dispatch_io(sd_event_source *source, int fd, uint32_t revents,
             p->type == SOCKET_SOCKET &&
             socket_address_can_accept(&p->address)) {
 
-                cfd = socket_accept_in_cgroup(p->socket, p, fd);
-                if (cfd == -EAGAIN) /* Spurious accept() */
-                        return 0;
-                if (cfd < 0)
-                        goto fail;
+                /* When connections come in faster than we can return to the event loop, take a number of
+                 * them at once, instead of paying for a full event loop iteration for each. */
+                for (unsigned i = 0; i < SOCKET_ACCEPT_PER_WAKEUP_MAX; i++) {
+                        int r;
 
-                socket_apply_socket_options(p->socket, p, cfd);
+                        /* Triggering the service might have changed our state, for example because the
+                         * trigger limit was hit. */
+                        if (i > 0) {
+                                if (p->socket->state != SOCKET_LISTENING || p->fd != fd)
+                                        break;
+
+                                /* Check first, so that we don't fork off an accept helper for nothing */
+                                r = fd_wait_for_event(fd, POLLIN, 0);
+                                if (r <= 0)
+                                        break;
+                        }
+
+                        cfd = socket_accept_in_cgroup(p->socket, p, fd);
+                        if (cfd == -EAGAIN) /* Spurious accept() */
+                                return 0;
+                        if (cfd < 0)
+                                goto fail;
+
+                        socket_apply_socket_options(p->socket, p, cfd);
+                        socket_enter_running(p->socket, cfd);
+                }
+
+                return 0;
         }
 
         socket_enter_running(p->socket, cfd);
@@ -30,6 +30,10 @@
 #include "unit.h"
 #include "virt.h"
 
+/* Process at most this many /proc/swaps changes per interval, see swap_dispatch_io() */
+#define SWAP_RATELIMIT_INTERVAL_USEC (1 * USEC_PER_SEC)
+#define SWAP_RATELIMIT_BURST 5U
+
 static const UnitActiveState state_translation_table[_SWAP_STATE_MAX] = {
         [SWAP_DEAD] = UNIT_INACTIVE,
         [SWAP_ACTIVATING] = UNIT_ACTIVATING,
@@ -1296,13 +1300,65 @@ static int swap_process_proc_swaps(Manager *m) {
         return 1;
 }
 
+static int swap_dispatch_ratelimit_expired(sd_event_source *source, usec_t usec, void *userdata) {
+        Manager *m = userdata;
+        int r;
+
+        assert(m);
+
+        m->swap_ratelimit_event_source = sd_event_source_unref(m->swap_ratelimit_event_source);
+
+        r = sd_event_source_set_enabled(m->swap_event_source, SD_EVENT_ON);
+        if (r < 0)
+                log_warning_errno(r, "Failed to resume watching /proc/swaps, ignoring: %m");
+
+        /* Pick up everything that changed while we weren't looking, in one go */
+        return swap_process_proc_swaps(m);
+}
+
+int swap_process_proc_swaps_ratelimited(Manager *m) {
+        int r;
+
+        assert(m);
+
+        /* Same as for the mount table: if swaps come and go faster than our rate limit allows, stop
+         * watching until the interval is over, and then rescan once, which covers everything that changed
+         * in the meantime. Changes caused by our own swapon/swapoff jobs are picked up from the SIGCHLD
+         * handler anyway. */
+        if (ratelimit_below(&m->swap_ratelimit))
+                return swap_process_proc_swaps(m);
+
+        if (m->swap_ratelimit_event_source)
+                return 0;
+
+        r = sd_event_add_time(m->event, &m->swap_ratelimit_event_source, CLOCK_MONOTONIC,
+                              usec_add(m->swap_ratelimit.begin, m->swap_ratelimit.interval), 0,
+                              swap_dispatch_ratelimit_expired, m);
+        if (r < 0) {
+                log_warning_errno(r, "Failed to install /proc/swaps rate limit timer, processing swap changes right-away: %m");
+                return swap_process_proc_swaps(m);
+        }
+
+        (void) sd_event_source_set_description(m->swap_ratelimit_event_source, "swap-proc-ratelimit");
+
+        r = sd_event_source_set_enabled(m->swap_event_source, SD_EVENT_OFF);
+        if (r < 0) {
+                m->swap_ratelimit_event_source = sd_event_source_unref(m->swap_ratelimit_event_source);
+                log_warning_errno(r, "Failed to suspend watching /proc/swaps, processing swap changes right-away: %m");
+                return swap_process_proc_swaps(m);
+        }
+
+        log_debug("/proc/swaps is changing rapidly, delaying processing of swap changes.");
+        return 0;
+}
+
 static int swap_dispatch_io(sd_event_source *source, int fd, uint32_t revents, void *userdata) {
         Manager *m = userdata;
 
         assert(m);
         assert(revents & EPOLLPRI);
 
-        return swap_process_proc_swaps(m);
+        return swap_process_proc_swaps_ratelimited(m);
 }
 
 static Unit *swap_following(Unit *u) {
@@ -1373,6 +1429,7 @@ static void swap_shutdown(Manager *m) {
         assert(m);
 
         m->swap_event_source = sd_event_source_unref(m->swap_event_source);
+        m->swap_ratelimit_event_source = sd_event_source_unref(m->swap_ratelimit_event_source);
         m->proc_swaps = safe_fclose(m->proc_swaps);
         m->swaps_by_devnode = hashmap_free(m->swaps_by_devnode);
 }
@@ -1409,6 +1466,8 @@ static void swap_enumerate(Manager *m) {
                 }
 
                 (void) sd_event_source_set_description(m->swap_event_source, "swap-proc");
+
+                m->swap_ratelimit = (RateLimit) { SWAP_RATELIMIT_INTERVAL_USEC, SWAP_RATELIMIT_BURST };
         }
 
         r = swap_load_proc_swaps(m, false);
@@ -89,6 +89,7 @@ extern const UnitVTable swap_vtable;
 
 int swap_process_device_new(Manager *m, sd_device *dev);
 int swap_process_device_remove(Manager *m, sd_device *dev);
+int swap_process_proc_swaps_ratelimited(Manager *m);
 
 const char* swap_exec_command_to_string(SwapExecCommand i) _const_;
 SwapExecCommand swap_exec_command_from_string(const char *s) _pure_;
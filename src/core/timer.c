@@ -383,9 +383,19 @@ static void timer_enter_waiting(Timer *t, bool time_change) {
                                         b = ts.realtime;
                         }
 
-                        r = calendar_spec_next_usec(v->calendar_spec, b, &v->next_elapse);
-                        if (r < 0)
-                                continue;
+                        /* The result only depends on the base and the time zone, hence don't redo the
+                         * calculation (which forks for specs with an explicit time zone) if the base didn't
+                         * change, for example when we are called for a clock change. */
+                        if (v->calendar_next > 0 && v->calendar_base == b)
+                                v->next_elapse = v->calendar_next;
+                        else {
+                                r = calendar_spec_next_usec(v->calendar_spec, b, &v->next_elapse);
+                                if (r < 0)
+                                        continue;
+
+                                v->calendar_base = b;
+                                v->calendar_next = v->next_elapse;
+                        }
 
                         /* To make the delay due to RandomizedDelaySec= work even at boot, if the scheduled
                          * time has already passed, set the time when systemd first started as the scheduled
@@ -819,9 +829,14 @@ static void timer_time_change(Unit *u) {
 
 static void timer_timezone_change(Unit *u) {
         Timer *t = TIMER(u);
+        TimerValue *v;
 
         assert(u);
 
+        /* Calendar specs are evaluated in local time, hence everything we calculated so far is stale */
+        LIST_FOREACH(value, v, t->values)
+                v->calendar_next = 0;
+
         if (t->state != TIMER_WAITING)
                 return;
 
@@ -25,6 +25,10 @@ typedef struct TimerValue {
         CalendarSpec *calendar_spec; /* only for calendar events */
         usec_t next_elapse;
 
+        /* The last calendar_spec_next_usec() result and the base it was calculated from, 0 if unset */
+        usec_t calendar_base;
+        usec_t calendar_next;
+
         LIST_FIELDS(struct TimerValue, value);
 } TimerValue;
 
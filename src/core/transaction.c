@@ -735,7 +735,10 @@ int transaction_activate(
                         transaction_collect_garbage(tr);
 
                 /* Fifth step: verify order makes sense and correct
-                 * cycles if necessary and possible */
+                 * cycles if necessary and possible. Each pass needs a
+                 * fresh generation: deleting a job may add edges, as
+                 * ordering then falls back to the installed job of
+                 * the unit, hence earlier results can't be reused. */
                 r = transaction_verify_order(tr, &generation, e);
                 if (r >= 0)
                         break;
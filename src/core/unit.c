@@ -473,6 +473,8 @@ void unit_add_to_dbus_queue(Unit *u) {
         assert(u);
         assert(u->type != _UNIT_TYPE_INVALID);
 
+        u->state_generation = ++u->manager->unit_state_generation;
+
         if (u->load_state == UNIT_STUB || u->in_dbus_queue)
                 return;
 
@@ -621,6 +623,8 @@ void unit_free(Unit *u) {
 
         bus_unit_send_removed_signal(u);
 
+        u->manager->unit_removed_generation = ++u->manager->unit_state_generation;
+
         unit_done(u);
 
         unit_dequeue_rewatch_pids(u);
@@ -2961,26 +2965,36 @@ static int unit_add_dependency_hashmap(
 
         assert_cc(sizeof(void*) == sizeof(info));
 
+        /* Most dependencies are new, hence try to add the entry first, so that we need only one lookup for
+         * them */
+        info = (UnitDependencyInfo) {
+                .origin_mask = origin_mask,
+                .destination_mask = destination_mask,
+        };
+
+        r = hashmap_put(*h, other, info.data);
+        if (r == 0)
+                return 0; /* Entry exists already with exactly these masks, NOP */
+        if (r != -EEXIST) {
+                if (r < 0)
+                        return r;
+
+                return 1;
+        }
+
         info.data = hashmap_get(*h, other);
-        if (info.data) {
-                /* Entry already exists. Add in our mask. */
+        assert(info.data);
 
-                if (FLAGS_SET(origin_mask, info.origin_mask) &&
-                    FLAGS_SET(destination_mask, info.destination_mask))
-                        return 0; /* NOP */
+        /* Entry already exists. Add in our mask. */
 
-                info.origin_mask |= origin_mask;
-                info.destination_mask |= destination_mask;
+        if (FLAGS_SET(origin_mask, info.origin_mask) &&
+            FLAGS_SET(destination_mask, info.destination_mask))
+                return 0; /* NOP */
 
-                r = hashmap_update(*h, other, info.data);
-        } else {
-                info = (UnitDependencyInfo) {
-                        .origin_mask = origin_mask,
-                        .destination_mask = destination_mask,
-                };
+        info.origin_mask |= origin_mask;
+        info.destination_mask |= destination_mask;
 
-                r = hashmap_put(*h, other, info.data);
-        }
+        r = hashmap_update(*h, other, info.data);
         if (r < 0)
                 return r;
 
@@ -3637,9 +3651,9 @@ int unit_deserialize(Unit *u, FILE *f, FDSet *fds) {
                 ssize_t m;
                 size_t k;
 
-                r = read_line(f, LONG_LINE_MAX, &line);
+                r = read_serialization_line(f, &line);
                 if (r < 0)
-                        return log_error_errno(r, "Failed to read serialization line: %m");
+                        return r;
                 if (r == 0) /* eof */
                         break;
 
@@ -3974,9 +3988,9 @@ int unit_deserialize_skip(FILE *f) {
                 _cleanup_free_ char *line = NULL;
                 char *l;
 
-                r = read_line(f, LONG_LINE_MAX, &line);
+                r = read_serialization_line(f, &line);
                 if (r < 0)
-                        return log_error_errno(r, "Failed to read serialization line: %m");
+                        return r;
                 if (r == 0)
                         return 0;
 
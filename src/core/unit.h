@@ -230,6 +230,9 @@ typedef struct Unit {
         unsigned sigchldgen;
         unsigned notifygen;
 
+        /* The manager's unit_state_generation when this unit last changed */
+        uint64_t state_generation;
+
         /* Used during GC sweeps */
         unsigned gc_marker;
 
@@ -274,6 +277,13 @@ typedef struct Unit {
         CGroupMask cgroup_invalidated_mask;        /* A mask specifying controllers which shall be considered invalidated, and require re-realization */
         CGroupMask cgroup_members_mask;            /* A cache for the controllers required by all children of this cgroup (only relevant for slice units) */
 
+        /* When the unit was added to the cgroup empty and OOM queues, for tracking the dispatch latency */
+        usec_t cgroup_empty_queue_timestamp;
+        usec_t cgroup_oom_queue_timestamp;
+
+        /* The values we last successfully wrote to the cgroup attributes, attribute name → value */
+        Hashmap *cgroup_attribute_cache;
+
         /* Inotify watch descriptors for watching cgroup.events and memory.events on cgroupv2 */
         int cgroup_control_inotify_wd;
         int cgroup_memory_inotify_wd;
@@ -19,6 +19,11 @@
 #include "strv.h"
 #include "xattr-util.h"
 
+/* The receive buffer size we ask curl for. The default of 16K means a write callback, and hence a
+ * decompression step and a write() for each 16K of image data, which shows on fast links. This is the
+ * maximum curl accepts. */
+#define PULL_JOB_BUFFER_SIZE (512U*1024U)
+
 PullJob* pull_job_unref(PullJob *j) {
         if (!j)
                 return NULL;
@@ -629,6 +634,9 @@ int pull_job_begin(PullJob *j) {
         if (curl_easy_setopt(j->curl, CURLOPT_NOPROGRESS, 0) != CURLE_OK)
                 return -EIO;
 
+        /* Not fatal, older curl versions refuse buffers this large and use their default size then */
+        (void) curl_easy_setopt(j->curl, CURLOPT_BUFFERSIZE, (long) PULL_JOB_BUFFER_SIZE);
+
         r = curl_glue_add(j->glue, j->curl);
         if (r < 0)
                 return r;
@@ -27,7 +27,6 @@
 #include "parse-util.h"
 #include "pretty-print.h"
 #include "sigbus.h"
-#include "tmpfile-util.h"
 #include "util.h"
 
 #define JOURNAL_WAIT_TIMEOUT (10*USEC_PER_SEC)
@@ -51,7 +50,10 @@ typedef struct RequestMeta {
         uint64_t n_entries;
         bool n_entries_set;
 
+        /* The serialization of the current entry or field, in memory */
         FILE *tmp;
+        char *tmp_buf;
+        size_t tmp_buf_size;
         uint64_t delta, size;
 
         int argument_parse_error;
@@ -100,6 +102,7 @@ static void request_meta_free(
         sd_journal_close(m->journal);
 
         safe_fclose(m->tmp);
+        free(m->tmp_buf);
 
         free(m->cursor);
         free(m);
@@ -120,16 +123,14 @@ static int open_journal(RequestMeta *m) {
 static int request_meta_ensure_tmp(RequestMeta *m) {
         assert(m);
 
+        /* Entries and fields are serialized one at a time into a memory stream, whose buffer is reused
+         * for the next one, and from which the data is then copied directly into the buffers of
+         * microhttpd. */
+
         if (m->tmp)
                 rewind(m->tmp);
         else {
-                _cleanup_close_ int fd = -1;
-
-                fd = open_tmpfile_unlinkable("/tmp", O_RDWR|O_CLOEXEC);
-                if (fd < 0)
-                        return fd;
-
-                m->tmp = take_fdopen(&fd, "w+");
+                m->tmp = open_memstream_unlocked(&m->tmp_buf, &m->tmp_buf_size);
                 if (!m->tmp)
                         return -errno;
         }
@@ -137,6 +138,27 @@ static int request_meta_ensure_tmp(RequestMeta *m) {
         return 0;
 }
 
+static int request_meta_finish_tmp(RequestMeta *m) {
+        off_t sz;
+
+        assert(m);
+        assert(m->tmp);
+
+        /* Make sure the buffer is up-to-date. We rewind instead of truncating between items, hence what
+         * counts is the current position, not the size of the buffer. */
+        if (fflush(m->tmp) != 0)
+                return -errno;
+
+        sz = ftello(m->tmp);
+        if (sz == (off_t) -1)
+                return -errno;
+
+        assert((size_t) sz <= m->tmp_buf_size);
+
+        m->size = (uint64_t) sz;
+        return 0;
+}
+
 static ssize_t request_reader_entries(
                 void *cls,
                 uint64_t pos,
@@ -144,8 +166,8 @@ static ssize_t request_reader_entries(
                 size_t max) {
 
         RequestMeta *m = cls;
+        size_t n = 0;
         int r;
-        size_t n, k;
 
         assert(m);
         assert(buf);
@@ -154,108 +176,101 @@ static ssize_t request_reader_entries(
 
         pos -= m->delta;
 
-        while (pos >= m->size) {
-                off_t sz;
+        /* Fill the buffer with as many entries as are available right now, instead of returning only
+         * the rest of one entry per call. If there's already something in the buffer, return that first
+         * instead of waiting for more, or instead of ending the stream. */
 
-                /* End of this entry, so let's serialize the next
-                 * one */
+        for (;;) {
+                size_t k;
 
-                if (m->n_entries_set &&
-                    m->n_entries <= 0)
-                        return MHD_CONTENT_READER_END_OF_STREAM;
+                while (pos >= m->size) {
 
-                if (m->n_skip < 0)
-                        r = sd_journal_previous_skip(m->journal, (uint64_t) -m->n_skip + 1);
-                else if (m->n_skip > 0)
-                        r = sd_journal_next_skip(m->journal, (uint64_t) m->n_skip + 1);
-                else
-                        r = sd_journal_next(m->journal);
+                        /* End of this entry, so let's serialize the next
+                         * one */
 
-                if (r < 0) {
-                        log_error_errno(r, "Failed to advance journal pointer: %m");
-                        return MHD_CONTENT_READER_END_WITH_ERROR;
-                } else if (r == 0) {
+                        if (m->n_entries_set &&
+                            m->n_entries <= 0)
+                                return n > 0 ? (ssize_t) n : MHD_CONTENT_READER_END_OF_STREAM;
 
-                        if (m->follow) {
-                                r = sd_journal_wait(m->journal, (uint64_t) JOURNAL_WAIT_TIMEOUT);
-                                if (r < 0) {
-                                        log_error_errno(r, "Couldn't wait for journal event: %m");
-                                        return MHD_CONTENT_READER_END_WITH_ERROR;
-                                }
-                                if (r == SD_JOURNAL_NOP)
-                                        break;
+                        if (m->n_skip < 0)
+                                r = sd_journal_previous_skip(m->journal, (uint64_t) -m->n_skip + 1);
+                        else if (m->n_skip > 0)
+                                r = sd_journal_next_skip(m->journal, (uint64_t) m->n_skip + 1);
+                        else
+                                r = sd_journal_next(m->journal);
 
-                                continue;
-                        }
+                        if (r < 0) {
+                                log_error_errno(r, "Failed to advance journal pointer: %m");
+                                return MHD_CONTENT_READER_END_WITH_ERROR;
+                        } else if (r == 0) {
 
-                        return MHD_CONTENT_READER_END_OF_STREAM;
-                }
+                                if (n > 0)
+                                        return (ssize_t) n;
 
-                if (m->discrete) {
-                        assert(m->cursor);
+                                if (m->follow) {
+                                        r = sd_journal_wait(m->journal, (uint64_t) JOURNAL_WAIT_TIMEOUT);
+                                        if (r < 0) {
+                                                log_error_errno(r, "Couldn't wait for journal event: %m");
+                                                return MHD_CONTENT_READER_END_WITH_ERROR;
+                                        }
+                                        if (r == SD_JOURNAL_NOP)
+                                                return 0;
 
-                        r = sd_journal_test_cursor(m->journal, m->cursor);
-                        if (r < 0) {
-                                log_error_errno(r, "Failed to test cursor: %m");
-                                return MHD_CONTENT_READER_END_WITH_ERROR;
-                        }
+                                        continue;
+                                }
 
-                        if (r == 0)
                                 return MHD_CONTENT_READER_END_OF_STREAM;
-                }
+                        }
 
-                pos -= m->size;
-                m->delta += m->size;
+                        if (m->discrete) {
+                                assert(m->cursor);
+
+                                r = sd_journal_test_cursor(m->journal, m->cursor);
+                                if (r < 0) {
+                                        log_error_errno(r, "Failed to test cursor: %m");
+                                        return MHD_CONTENT_READER_END_WITH_ERROR;
+                                }
 
-                if (m->n_entries_set)
-                        m->n_entries -= 1;
+                                if (r == 0)
+                                        return n > 0 ? (ssize_t) n : MHD_CONTENT_READER_END_OF_STREAM;
+                        }
 
-                m->n_skip = 0;
+                        pos -= m->size;
+                        m->delta += m->size;
 
-                r = request_meta_ensure_tmp(m);
-                if (r < 0) {
-                        log_error_errno(r, "Failed to create temporary file: %m");
-                        return MHD_CONTENT_READER_END_WITH_ERROR;
-                }
+                        if (m->n_entries_set)
+                                m->n_entries -= 1;
 
-                r = show_journal_entry(m->tmp, m->journal, m->mode, 0, OUTPUT_FULL_WIDTH,
-                                   NULL, NULL, NULL);
-                if (r < 0) {
-                        log_error_errno(r, "Failed to serialize item: %m");
-                        return MHD_CONTENT_READER_END_WITH_ERROR;
-                }
+                        m->n_skip = 0;
 
-                sz = ftello(m->tmp);
-                if (sz == (off_t) -1) {
-                        log_error_errno(errno, "Failed to retrieve file position: %m");
-                        return MHD_CONTENT_READER_END_WITH_ERROR;
-                }
+                        r = request_meta_ensure_tmp(m);
+                        if (r < 0) {
+                                log_error_errno(r, "Failed to create temporary file: %m");
+                                return MHD_CONTENT_READER_END_WITH_ERROR;
+                        }
 
-                m->size = (uint64_t) sz;
-        }
+                        r = show_journal_entry(m->tmp, m->journal, m->mode, 0, OUTPUT_FULL_WIDTH,
+                                           NULL, NULL, NULL);
+                        if (r < 0) {
+                                log_error_errno(r, "Failed to serialize item: %m");
+                                return MHD_CONTENT_READER_END_WITH_ERROR;
+                        }
 
-        if (m->tmp == NULL && m->follow)
-                return 0;
+                        r = request_meta_finish_tmp(m);
+                        if (r < 0) {
+                                log_error_errno(r, "Failed to retrieve serialized item: %m");
+                                return MHD_CONTENT_READER_END_WITH_ERROR;
+                        }
+                }
 
-        if (fseeko(m->tmp, pos, SEEK_SET) < 0) {
-                log_error_errno(errno, "Failed to seek to position: %m");
-                return MHD_CONTENT_READER_END_WITH_ERROR;
-        }
+                k = MIN(m->size - pos, max - n);
+                memcpy(buf + n, m->tmp_buf + pos, k);
+                n += k;
+                pos += k;
 
-        n = m->size - pos;
-        if (n < 1)
-                return 0;
-        if (n > max)
-                n = max;
-
-        errno = 0;
-        k = fread(buf, 1, n, m->tmp);
-        if (k != n) {
-                log_error("Failed to read from file: %s", errno != 0 ? strerror_safe(errno) : "Premature EOF");
-                return MHD_CONTENT_READER_END_WITH_ERROR;
+                if (n >= max)
+                        return (ssize_t) n;
         }
-
-        return (ssize_t) k;
 }
 
 static int request_parse_accept(
@@ -499,7 +514,8 @@ static int request_handler_entries(
         if (r < 0)
                 return mhd_respond(connection, MHD_HTTP_BAD_REQUEST, "Failed to seek in journal.");
 
-        response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 4*1024, request_reader_entries, m, NULL);
+        /* Entries are batched into the buffer, hence make it large enough to hold a good number of them */
+        response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 64*1024, request_reader_entries, m, NULL);
         if (!response)
                 return respond_oom(connection);
 
@@ -537,7 +553,7 @@ static ssize_t request_reader_fields(
 
         RequestMeta *m = cls;
         int r;
-        size_t n, k;
+        size_t n;
 
         assert(m);
         assert(buf);
@@ -547,7 +563,6 @@ static ssize_t request_reader_fields(
         pos -= m->delta;
 
         while (pos >= m->size) {
-                off_t sz;
                 const void *d;
                 size_t l;
 
@@ -583,32 +598,17 @@ static ssize_t request_reader_fields(
                         return MHD_CONTENT_READER_END_WITH_ERROR;
                 }
 
-                sz = ftello(m->tmp);
-                if (sz == (off_t) -1) {
-                        log_error_errno(errno, "Failed to retrieve file position: %m");
+                r = request_meta_finish_tmp(m);
+                if (r < 0) {
+                        log_error_errno(r, "Failed to retrieve serialized item: %m");
                         return MHD_CONTENT_READER_END_WITH_ERROR;
                 }
-
-                m->size = (uint64_t) sz;
         }
 
-        if (fseeko(m->tmp, pos, SEEK_SET) < 0) {
-                log_error_errno(errno, "Failed to seek to position: %m");
-                return MHD_CONTENT_READER_END_WITH_ERROR;
-        }
-
-        n = m->size - pos;
-        if (n > max)
-                n = max;
-
-        errno = 0;
-        k = fread(buf, 1, n, m->tmp);
-        if (k != n) {
-                log_error("Failed to read from file: %s", errno != 0 ? strerror_safe(errno) : "Premature EOF");
-                return MHD_CONTENT_READER_END_WITH_ERROR;
-        }
+        n = MIN(m->size - pos, max);
+        memcpy(buf, m->tmp_buf + pos, n);
 
-        return (ssize_t) k;
+        return (ssize_t) n;
 }
 
 static int request_handler_fields(
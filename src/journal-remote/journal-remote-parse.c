@@ -53,7 +53,11 @@ int process_source(RemoteSource *source, bool compress, bool seal) {
         assert(source);
         assert(source->writer);
 
-        r = journal_importer_process_data(&source->importer);
+        /* Consume the fields of an entry in one go, rather than returning to the event loop after each of
+         * them. 0 means to continue, unless the end of the stream was reached. */
+        do
+                r = journal_importer_process_data(&source->importer);
+        while (r == 0 && !journal_importer_eof(&source->importer));
         if (r <= 0)
                 return r;
 
@@ -57,6 +57,10 @@ static void close_fd_input(Uploader *u);
 
 #define SERVER_ANSWER_KEEP 2048
 
+/* How much data curl asks the input callbacks for at once, and hence sends per chunk. A lot more than the
+ * curl default of 16K, so that many journal entries are sent per chunk when catching up with a backlog. */
+#define UPLOAD_BUFFER_SIZE (512U*1024U)
+
 #define STATE_FILE "/var/lib/systemd/journal-upload/state"
 
 #define easy_setopt(curl, opt, value, level, cmd)                       \
@@ -241,6 +245,12 @@ int start_upload(Uploader *u,
                             "systemd-journal-upload " GIT_VERSION,
                             LOG_WARNING, );
 
+#if LIBCURL_VERSION_NUM >= 0x073e00
+                /* Not fatal, curl uses its default size then */
+                easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, (long) UPLOAD_BUFFER_SIZE,
+                            LOG_DEBUG, );
+#endif
+
                 if (!streq_ptr(arg_key, "-") && (arg_key || startswith(u->url, "https://"))) {
                         easy_setopt(curl, CURLOPT_SSLKEY, arg_key ?: PRIV_KEY_FILE,
                                     LOG_ERR, return -EXFULL);
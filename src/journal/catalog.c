@@ -605,13 +605,43 @@ static const char *find_id(void *p, sd_id128_t id) {
                 le64toh(f->offset);
 }
 
+int catalog_map(const char *database, void **ret_map, struct stat *ret_st) {
+        _cleanup_close_ int fd = -1;
+
+        assert(database);
+        assert(ret_map);
+        assert(ret_st);
+
+        /* Maps the database for use with catalog_get_mapped(). The file descriptor is not needed anymore
+         * once the mapping exists. Release with munmap(*ret_map, ret_st->st_size). */
+
+        return open_mmap(database, &fd, ret_st, ret_map);
+}
+
+int catalog_get_mapped(void *p, sd_id128_t id, char **_text) {
+        const char *s;
+        char *text;
+
+        assert(p);
+        assert(_text);
+
+        s = find_id(p, id);
+        if (!s)
+                return -ENOENT;
+
+        text = strdup(s);
+        if (!text)
+                return -ENOMEM;
+
+        *_text = text;
+        return 0;
+}
+
 int catalog_get(const char* database, sd_id128_t id, char **_text) {
         _cleanup_close_ int fd = -1;
         void *p = NULL;
         struct stat st = {};
-        char *text = NULL;
         int r;
-        const char *s;
 
         assert(_text);
 
@@ -619,24 +649,9 @@ int catalog_get(const char* database, sd_id128_t id, char **_text) {
         if (r < 0)
                 return r;
 
-        s = find_id(p, id);
-        if (!s) {
-                r = -ENOENT;
-                goto finish;
-        }
-
-        text = strdup(s);
-        if (!text) {
-                r = -ENOMEM;
-                goto finish;
-        }
+        r = catalog_get_mapped(p, id, _text);
 
-        *_text = text;
-        r = 0;
-
-finish:
-        if (p)
-                munmap(p, st.st_size);
+        munmap(p, st.st_size);
 
         return r;
 }
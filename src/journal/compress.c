@@ -56,6 +56,75 @@ static int zstd_ret_to_errno(size_t ret) {
 
 #define ALIGN_8(l) ALIGN_TO(l, sizeof(size_t))
 
+struct CompressContext {
+#if HAVE_LZ4
+        void *lz4_state;
+#endif
+#if HAVE_ZSTD
+        ZSTD_CCtx *zstd_cctx;
+        ZSTD_DCtx *zstd_dctx;
+#endif
+};
+
+int compress_context_new(CompressContext **ret) {
+        CompressContext *c;
+
+        assert(ret);
+
+        /* The codec state is only allocated on first use, hence this is cheap */
+        c = new0(CompressContext, 1);
+        if (!c)
+                return -ENOMEM;
+
+        *ret = c;
+        return 0;
+}
+
+CompressContext *compress_context_free(CompressContext *c) {
+        if (!c)
+                return NULL;
+
+#if HAVE_LZ4
+        free(c->lz4_state);
+#endif
+#if HAVE_ZSTD
+        ZSTD_freeCCtx(c->zstd_cctx);
+        ZSTD_freeDCtx(c->zstd_dctx);
+#endif
+        return mfree(c);
+}
+
+#if HAVE_ZSTD
+/* Returns the compression context of c, allocating it if necessary. If no context object is passed, a
+ * temporary one is allocated and returned in *tmp too, so that the caller releases it. */
+static ZSTD_CCtx *zstd_get_cctx(CompressContext *c, ZSTD_CCtx **tmp) {
+        assert(tmp);
+
+        if (!c)
+                return (*tmp = ZSTD_createCCtx());
+
+        if (!c->zstd_cctx)
+                c->zstd_cctx = ZSTD_createCCtx();
+
+        return c->zstd_cctx;
+}
+
+static ZSTD_DCtx *zstd_get_dctx(CompressContext *c, ZSTD_DCtx **tmp) {
+        assert(tmp);
+
+        if (!c)
+                return (*tmp = ZSTD_createDCtx());
+
+        if (!c->zstd_dctx)
+                c->zstd_dctx = ZSTD_createDCtx();
+        else
+                /* Forget the state of the previous use */
+                (void) ZSTD_DCtx_reset(c->zstd_dctx, ZSTD_reset_session_and_parameters);
+
+        return c->zstd_dctx;
+}
+#endif
+
 static const char* const object_compressed_table[_OBJECT_COMPRESSED_MAX] = {
         [OBJECT_COMPRESSED_XZ]   = "XZ",
         [OBJECT_COMPRESSED_LZ4]  = "LZ4",
@@ -106,6 +175,13 @@ int compress_blob_xz(const void *src, uint64_t src_size,
 
 int compress_blob_lz4(const void *src, uint64_t src_size,
                       void *dst, size_t dst_alloc_size, size_t *dst_size) {
+        return compress_blob_lz4_with_context(NULL, src, src_size, dst, dst_alloc_size, dst_size);
+}
+
+int compress_blob_lz4_with_context(
+                CompressContext *c,
+                const void *src, uint64_t src_size,
+                void *dst, size_t dst_alloc_size, size_t *dst_size) {
 #if HAVE_LZ4
         int r;
 
@@ -121,7 +197,16 @@ int compress_blob_lz4(const void *src, uint64_t src_size,
         if (src_size < 9)
                 return -ENOBUFS;
 
-        r = LZ4_compress_default(src, (char*)dst + 8, src_size, (int) dst_alloc_size - 8);
+        if (c) {
+                if (!c->lz4_state) {
+                        c->lz4_state = malloc(LZ4_sizeofState());
+                        if (!c->lz4_state)
+                                return -ENOMEM;
+                }
+
+                r = LZ4_compress_fast_extState(c->lz4_state, src, (char*)dst + 8, src_size, (int) dst_alloc_size - 8, 1);
+        } else
+                r = LZ4_compress_default(src, (char*)dst + 8, src_size, (int) dst_alloc_size - 8);
         if (r <= 0)
                 return -ENOBUFS;
 
@@ -137,7 +222,16 @@ int compress_blob_lz4(const void *src, uint64_t src_size,
 int compress_blob_zstd(
                 const void *src, uint64_t src_size,
                 void *dst, size_t dst_alloc_size, size_t *dst_size) {
+        return compress_blob_zstd_with_context(NULL, src, src_size, dst, dst_alloc_size, dst_size);
+}
+
+int compress_blob_zstd_with_context(
+                CompressContext *c,
+                const void *src, uint64_t src_size,
+                void *dst, size_t dst_alloc_size, size_t *dst_size) {
 #if HAVE_ZSTD
+        _cleanup_(ZSTD_freeCCtxp) ZSTD_CCtx *tmp = NULL;
+        ZSTD_CCtx *cctx;
         size_t k;
 
         assert(src);
@@ -146,7 +240,11 @@ int compress_blob_zstd(
         assert(dst_alloc_size > 0);
         assert(dst_size);
 
-        k = ZSTD_compress(dst, dst_alloc_size, src, src_size, 0);
+        cctx = zstd_get_cctx(c, &tmp);
+        if (!cctx)
+                return -ENOMEM;
+
+        k = ZSTD_compressCCtx(cctx, dst, dst_alloc_size, src, src_size, 0);
         if (ZSTD_isError(k))
                 return zstd_ret_to_errno(k);
 
@@ -257,11 +355,14 @@ int decompress_blob_lz4(const void *src, uint64_t src_size,
 #endif
 }
 
-int decompress_blob_zstd(
+int decompress_blob_zstd_with_context(
+                CompressContext *c,
                 const void *src, uint64_t src_size,
                 void **dst, size_t *dst_alloc_size, size_t *dst_size, size_t dst_max) {
 
 #if HAVE_ZSTD
+        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *tmp = NULL;
+        ZSTD_DCtx *dctx;
         uint64_t size;
 
         assert(src);
@@ -283,7 +384,7 @@ int decompress_blob_zstd(
         if (!(greedy_realloc(dst, dst_alloc_size, MAX(ZSTD_DStreamOutSize(), size), 1)))
                 return -ENOMEM;
 
-        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        dctx = zstd_get_dctx(c, &tmp);
         if (!dctx)
                 return -ENOMEM;
 
@@ -310,11 +411,27 @@ int decompress_blob_zstd(
 #endif
 }
 
+int decompress_blob_zstd(
+                const void *src, uint64_t src_size,
+                void **dst, size_t *dst_alloc_size, size_t *dst_size, size_t dst_max) {
+
+        return decompress_blob_zstd_with_context(NULL, src, src_size, dst, dst_alloc_size, dst_size, dst_max);
+}
+
 int decompress_blob(
                 int compression,
                 const void *src, uint64_t src_size,
                 void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max) {
 
+        return decompress_blob_with_context(NULL, compression, src, src_size, dst, dst_alloc_size, dst_size, dst_max);
+}
+
+int decompress_blob_with_context(
+                CompressContext *c,
+                int compression,
+                const void *src, uint64_t src_size,
+                void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max) {
+
         if (compression == OBJECT_COMPRESSED_XZ)
                 return decompress_blob_xz(
                                 src, src_size,
@@ -324,7 +441,8 @@ int decompress_blob(
                                 src, src_size,
                                 dst, dst_alloc_size, dst_size, dst_max);
         else if (compression == OBJECT_COMPRESSED_ZSTD)
-                return decompress_blob_zstd(
+                return decompress_blob_zstd_with_context(
+                                c,
                                 src, src_size,
                                 dst, dst_alloc_size, dst_size, dst_max);
         else
@@ -457,7 +575,20 @@ int decompress_startswith_zstd(
                 void **buffer, size_t *buffer_size,
                 const void *prefix, size_t prefix_len,
                 uint8_t extra) {
+
+        return decompress_startswith_zstd_with_context(NULL, src, src_size, buffer, buffer_size, prefix, prefix_len, extra);
+}
+
+int decompress_startswith_zstd_with_context(
+                CompressContext *c,
+                const void *src, uint64_t src_size,
+                void **buffer, size_t *buffer_size,
+                const void *prefix, size_t prefix_len,
+                uint8_t extra) {
 #if HAVE_ZSTD
+        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *tmp = NULL;
+        ZSTD_DCtx *dctx;
+
         assert(src);
         assert(src_size > 0);
         assert(buffer);
@@ -472,7 +603,7 @@ int decompress_startswith_zstd(
         if (size < prefix_len + 1)
                 return 0; /* Decompressed text too short to match the prefix and extra */
 
-        _cleanup_(ZSTD_freeDCtxp) ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        dctx = zstd_get_dctx(c, &tmp);
         if (!dctx)
                 return -ENOMEM;
 
@@ -510,6 +641,17 @@ int decompress_startswith(
                 const void *prefix, size_t prefix_len,
                 uint8_t extra) {
 
+        return decompress_startswith_with_context(NULL, compression, src, src_size, buffer, buffer_size, prefix, prefix_len, extra);
+}
+
+int decompress_startswith_with_context(
+                CompressContext *c,
+                int compression,
+                const void *src, uint64_t src_size,
+                void **buffer, size_t *buffer_size,
+                const void *prefix, size_t prefix_len,
+                uint8_t extra) {
+
         if (compression == OBJECT_COMPRESSED_XZ)
                 return decompress_startswith_xz(
                                 src, src_size,
@@ -524,7 +666,8 @@ int decompress_startswith(
                                 prefix, prefix_len,
                                 extra);
         else if (compression == OBJECT_COMPRESSED_ZSTD)
-                return decompress_startswith_zstd(
+                return decompress_startswith_zstd_with_context(
+                                c,
                                 src, src_size,
                                 buffer, buffer_size,
                                 prefix, prefix_len,
@@ -838,6 +981,11 @@ int decompress_stream_lz4(int in, int out, uint64_t max_bytes) {
 #endif
 }
 
+#if HAVE_ZSTD
+/* How many threads to compress large streams (i.e. coredumps) with at most, if libzstd supports it */
+#define ZSTD_STREAM_WORKERS_MAX 4
+#endif
+
 int compress_stream_zstd(int fdf, int fdt, uint64_t max_bytes) {
 #if HAVE_ZSTD
         _cleanup_(ZSTD_freeCCtxp) ZSTD_CCtx *cctx = NULL;
@@ -862,6 +1010,16 @@ int compress_stream_zstd(int fdf, int fdt, uint64_t max_bytes) {
         if (ZSTD_isError(z))
                 log_debug("Failed to enable ZSTD checksum, ignoring: %s", ZSTD_getErrorName(z));
 
+        /* Streams are big files such as coredumps, for which compression time dominates, hence spread the
+         * work over a couple of threads. This fails if libzstd was built without multithreading support,
+         * in which case we compress in this thread as before. */
+        long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (n_cpus > 1) {
+                z = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, MIN(n_cpus, ZSTD_STREAM_WORKERS_MAX));
+                if (ZSTD_isError(z))
+                        log_debug("Failed to enable multithreaded ZSTD compression, ignoring: %s", ZSTD_getErrorName(z));
+        }
+
         /* This loop read from the input file, compresses that entire chunk,
          * and writes all output produced to the output file.
          */
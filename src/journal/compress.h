@@ -4,26 +4,43 @@
 #include <unistd.h>
 
 #include "journal-def.h"
+#include "macro.h"
 
 const char* object_compressed_to_string(int compression);
 int object_compressed_from_string(const char *compression);
 
+/* Long-lived codec state, so that it doesn't have to be set up again for each blob. The _with_context()
+ * variants of the functions below also accept NULL, in which case temporary state is used. Not thread-safe,
+ * use one object per thread. XZ has no reusable state and ignores the context. */
+typedef struct CompressContext CompressContext;
+
+int compress_context_new(CompressContext **ret);
+CompressContext *compress_context_free(CompressContext *c);
+DEFINE_TRIVIAL_CLEANUP_FUNC(CompressContext*, compress_context_free);
+
 int compress_blob_xz(const void *src, uint64_t src_size,
                      void *dst, size_t dst_alloc_size, size_t *dst_size);
 int compress_blob_lz4(const void *src, uint64_t src_size,
                       void *dst, size_t dst_alloc_size, size_t *dst_size);
 int compress_blob_zstd(const void *src, uint64_t src_size,
                        void *dst, size_t dst_alloc_size, size_t *dst_size);
+int compress_blob_lz4_with_context(CompressContext *c,
+                                   const void *src, uint64_t src_size,
+                                   void *dst, size_t dst_alloc_size, size_t *dst_size);
+int compress_blob_zstd_with_context(CompressContext *c,
+                                    const void *src, uint64_t src_size,
+                                    void *dst, size_t dst_alloc_size, size_t *dst_size);
 
-static inline int compress_blob(const void *src, uint64_t src_size,
-                                void *dst, size_t dst_alloc_size, size_t *dst_size) {
+static inline int compress_blob_with_context(CompressContext *c,
+                                             const void *src, uint64_t src_size,
+                                             void *dst, size_t dst_alloc_size, size_t *dst_size) {
         int r;
 #if HAVE_ZSTD
-        r = compress_blob_zstd(src, src_size, dst, dst_alloc_size, dst_size);
+        r = compress_blob_zstd_with_context(c, src, src_size, dst, dst_alloc_size, dst_size);
         if (r == 0)
                 return OBJECT_COMPRESSED_ZSTD;
 #elif HAVE_LZ4
-        r = compress_blob_lz4(src, src_size, dst, dst_alloc_size, dst_size);
+        r = compress_blob_lz4_with_context(c, src, src_size, dst, dst_alloc_size, dst_size);
         if (r == 0)
                 return OBJECT_COMPRESSED_LZ4;
 #elif HAVE_XZ
@@ -36,15 +53,27 @@ static inline int compress_blob(const void *src, uint64_t src_size,
         return r;
 }
 
+static inline int compress_blob(const void *src, uint64_t src_size,
+                                void *dst, size_t dst_alloc_size, size_t *dst_size) {
+        return compress_blob_with_context(NULL, src, src_size, dst, dst_alloc_size, dst_size);
+}
+
 int decompress_blob_xz(const void *src, uint64_t src_size,
                        void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
 int decompress_blob_lz4(const void *src, uint64_t src_size,
                         void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
 int decompress_blob_zstd(const void *src, uint64_t src_size,
                         void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
+int decompress_blob_zstd_with_context(CompressContext *c,
+                                      const void *src, uint64_t src_size,
+                                      void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
 int decompress_blob(int compression,
                     const void *src, uint64_t src_size,
                     void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
+int decompress_blob_with_context(CompressContext *c,
+                                 int compression,
+                                 const void *src, uint64_t src_size,
+                                 void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max);
 
 int decompress_startswith_xz(const void *src, uint64_t src_size,
                              void **buffer, size_t *buffer_size,
@@ -58,11 +87,22 @@ int decompress_startswith_zstd(const void *src, uint64_t src_size,
                                void **buffer, size_t *buffer_size,
                                const void *prefix, size_t prefix_len,
                                uint8_t extra);
+int decompress_startswith_zstd_with_context(CompressContext *c,
+                                            const void *src, uint64_t src_size,
+                                            void **buffer, size_t *buffer_size,
+                                            const void *prefix, size_t prefix_len,
+                                            uint8_t extra);
 int decompress_startswith(int compression,
                           const void *src, uint64_t src_size,
                           void **buffer, size_t *buffer_size,
                           const void *prefix, size_t prefix_len,
                           uint8_t extra);
+int decompress_startswith_with_context(CompressContext *c,
+                                       int compression,
+                                       const void *src, uint64_t src_size,
+                                       void **buffer, size_t *buffer_size,
+                                       const void *prefix, size_t prefix_len,
+                                       uint8_t extra);
 
 int compress_stream_xz(int fdf, int fdt, uint64_t max_bytes);
 int compress_stream_lz4(int fdf, int fdt, uint64_t max_bytes);
@@ -26,6 +26,7 @@
 #include "lookup3.h"
 #include "memory-util.h"
 #include "path-util.h"
+#include "prioq.h"
 #include "random-util.h"
 #include "set.h"
 #include "sort-util.h"
@@ -70,12 +71,17 @@
 /* n_data was the first entry we added after the initial file format design */
 #define HEADER_SIZE_MIN ALIGN64(offsetof(Header, n_data))
 
-/* How many entries to keep in the entry array chain cache at max */
-#define CHAIN_CACHE_MAX 20
+/* How many entries to keep in the entry array chain cache at max. Writers consult it for every data
+ * object linked into an entry, hence this should cover the fields that repeat across entries. */
+#define CHAIN_CACHE_MAX 64
 
 /* How much to increase the journal file size at once each time we allocate something new. */
 #define FILE_SIZE_INCREASE (8 * 1024 * 1024ULL)          /* 8MB */
 
+/* Larger files are grown by a fraction of their size, up to this much at once, so that the number of
+ * synchronous posix_fallocate() calls on the append path doesn't grow linearly with the file size. */
+#define FILE_SIZE_INCREASE_MAX (64 * 1024 * 1024ULL)     /* 64MB */
+
 /* Reread fstat() of the file for detecting deletions at least this often */
 #define LAST_STAT_REFRESH_USEC (5*USEC_PER_SEC)
 
@@ -122,6 +128,13 @@ static void journal_file_set_offline_internal(JournalFile *f) {
 
                         f->header->state = f->archive ? STATE_ARCHIVED : STATE_OFFLINE;
                         (void) fsync(f->fd);
+
+                        /* Make the rename done by journal_file_archive() durable too, so that the
+                         * caller doesn't have to do that synchronously. */
+                        if (f->archive_sync_directory) {
+                                (void) fsync_directory_of_file(f->fd);
+                                f->archive_sync_directory = false;
+                        }
                         break;
 
                 case OFFLINE_OFFLINING:
@@ -369,6 +382,14 @@ JournalFile* journal_file_close(JournalFile *f) {
 
         journal_file_set_offline(f, true);
 
+        /* If the file wasn't online, taking it offline was a NOP and the rename done by
+         * journal_file_archive() hasn't been synced yet. Do it now. The offline thread is joined at this
+         * point, hence we can look at the flag safely. */
+        if (f->archive_sync_directory && f->fd >= 0) {
+                (void) fsync_directory_of_file(f->fd);
+                f->archive_sync_directory = false;
+        }
+
         if (f->mmap && f->cache_fd)
                 mmap_cache_free_fd(f->mmap, f->cache_fd);
 
@@ -392,8 +413,19 @@ JournalFile* journal_file_close(JournalFile *f) {
 
         ordered_hashmap_free_free(f->chain_cache);
 
+        if (f->data_cache) {
+                if (f->data_cache_hit + f->data_cache_missed > 0)
+                        log_debug("%s: data cache statistics: %u hit, %u miss",
+                                  f->path, f->data_cache_hit, f->data_cache_missed);
+
+                for (size_t i = 0; i < DATA_CACHE_SETS * DATA_CACHE_WAYS; i++)
+                        free(f->data_cache[i].payload);
+                free(f->data_cache);
+        }
+
 #if HAVE_COMPRESSION
         free(f->compress_buffer);
+        compress_context_free(f->compress_context);
 #endif
 
 #if HAVE_GCRYPT
@@ -638,7 +670,7 @@ int journal_file_fstat(JournalFile *f) {
 }
 
 static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size) {
-        uint64_t old_size, new_size, old_header_size, old_arena_size;
+        uint64_t old_size, new_size, old_header_size, old_arena_size, increase, available = UINT64_MAX;
         int r;
 
         assert(f);
@@ -685,8 +717,6 @@ static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size)
                 struct statvfs svfs;
 
                 if (fstatvfs(f->fd, &svfs) >= 0) {
-                        uint64_t available;
-
                         available = LESS_BY((uint64_t) svfs.f_bfree * (uint64_t) svfs.f_bsize, f->metrics.keep_free);
 
                         if (new_size - old_size > available)
@@ -694,8 +724,14 @@ static int journal_file_allocate(JournalFile *f, uint64_t offset, uint64_t size)
                 }
         }
 
-        /* Increase by larger blocks at once */
-        new_size = DIV_ROUND_UP(new_size, FILE_SIZE_INCREASE) * FILE_SIZE_INCREASE;
+        /* Increase by larger blocks at once, by an eighth of the current size for larger files, as long as
+         * that doesn't eat into the space we shall keep free */
+        increase = CLAMP(old_size / 8 / FILE_SIZE_INCREASE * FILE_SIZE_INCREASE,
+                         FILE_SIZE_INCREASE, FILE_SIZE_INCREASE_MAX);
+        if (increase > FILE_SIZE_INCREASE &&
+            DIV_ROUND_UP(new_size, increase) * increase - old_size > available)
+                increase = FILE_SIZE_INCREASE;
+        new_size = DIV_ROUND_UP(new_size, increase) * increase;
         if (f->metrics.max_size > 0 && new_size > f->metrics.max_size)
                 new_size = f->metrics.max_size;
 
@@ -718,6 +754,26 @@ static unsigned type_to_context(ObjectType type) {
         return type > OBJECT_UNUSED && type < _OBJECT_TYPE_MAX ? type : 0;
 }
 
+#if HAVE_COMPRESSION
+CompressContext *journal_file_get_compress_context(JournalFile *f) {
+        assert(f);
+
+        /* Returns NULL if we are out of memory, in which case the compression functions fall back to
+         * temporary state */
+        if (!f->compress_context)
+                (void) compress_context_new(&f->compress_context);
+
+        return f->compress_context;
+}
+#endif
+
+void journal_mmap_cache_set_access(MMapCache *m, ObjectType type, MMapCacheAccess access) {
+        assert(m);
+
+        /* Note that this applies to all files sharing the same MMapCache */
+        mmap_cache_set_access(m, type_to_context(type), access);
+}
+
 static int journal_file_move_to(
                 JournalFile *f,
                 ObjectType type,
@@ -1465,8 +1521,9 @@ int journal_file_find_data_object_with_hash(
 
                         l -= offsetof(Object, data.payload);
 
-                        r = decompress_blob(o->object.flags & OBJECT_COMPRESSION_MASK,
-                                            o->data.payload, l, &f->compress_buffer, &f->compress_buffer_size, &rsize, 0);
+                        r = decompress_blob_with_context(journal_file_get_compress_context(f),
+                                                         o->object.flags & OBJECT_COMPRESSION_MASK,
+                                                         o->data.payload, l, &f->compress_buffer, &f->compress_buffer_size, &rsize, 0);
                         if (r < 0)
                                 return r;
 
@@ -1587,10 +1644,123 @@ static int journal_file_append_field(
         return 0;
 }
 
+static DataCacheItem* journal_file_data_cache_set(JournalFile *f, uint64_t hash) {
+        assert(f);
+        assert(f->data_cache);
+
+        return f->data_cache + (hash % DATA_CACHE_SETS) * DATA_CACHE_WAYS;
+}
+
+static bool journal_file_data_cache_lookup(
+                JournalFile *f,
+                const void *data, uint64_t size, uint64_t hash,
+                uint64_t *ret_offset) {
+
+        DataCacheItem *set;
+
+        assert(f);
+        assert(ret_offset);
+
+        if (!f->data_cache || size > DATA_CACHE_PAYLOAD_MAX)
+                return false;
+
+        set = journal_file_data_cache_set(f, hash);
+        for (size_t i = 0; i < DATA_CACHE_WAYS; i++) {
+                DataCacheItem *c = set + i;
+
+                if (c->offset == 0 || c->hash != hash || c->size != size)
+                        continue;
+
+                if (memcmp_safe(c->payload, data, size) != 0)
+                        continue;
+
+                c->referenced = true;
+                f->data_cache_hit++;
+
+                *ret_offset = c->offset;
+                return true;
+        }
+
+        f->data_cache_missed++;
+        return false;
+}
+
+static void journal_file_data_cache_put(
+                JournalFile *f,
+                const void *data, uint64_t size, uint64_t hash,
+                uint64_t offset) {
+
+        DataCacheItem *set, *c = NULL;
+
+        assert(f);
+        assert(offset > 0);
+
+        if (size > DATA_CACHE_PAYLOAD_MAX)
+                return;
+
+        if (!f->data_cache) {
+                f->data_cache = new0(DataCacheItem, DATA_CACHE_SETS * DATA_CACHE_WAYS);
+                if (!f->data_cache)
+                        return;
+        }
+
+        /* Pick an unused slot if there is one, otherwise sweep over the set CLOCK-style, giving each
+         * slot that was used since the last sweep a second chance. */
+        set = journal_file_data_cache_set(f, hash);
+        for (size_t i = 0; i < DATA_CACHE_WAYS; i++)
+                if (set[i].offset == 0) {
+                        c = set + i;
+                        break;
+                }
+
+        for (size_t i = 0; !c && i < DATA_CACHE_WAYS * 2; i++) {
+                DataCacheItem *k = set + (i % DATA_CACHE_WAYS);
+
+                if (k->referenced)
+                        k->referenced = false;
+                else
+                        c = k;
+        }
+
+        assert(c);
+
+        if (c->allocated < size) {
+                void *n;
+
+                /* Always allocate the maximum size, so that we never need to reallocate this slot again */
+                n = realloc(c->payload, DATA_CACHE_PAYLOAD_MAX);
+                if (!n) {
+                        c->offset = 0;
+                        return;
+                }
+
+                c->payload = n;
+                c->allocated = DATA_CACHE_PAYLOAD_MAX;
+        }
+
+        memcpy_safe(c->payload, data, size);
+        c->hash = hash;
+        c->size = size;
+        c->offset = offset;
+        c->referenced = false;
+}
+
+unsigned journal_file_data_cache_get_hit(JournalFile *f) {
+        assert(f);
+
+        return f->data_cache_hit;
+}
+
+unsigned journal_file_data_cache_get_missed(JournalFile *f) {
+        assert(f);
+
+        return f->data_cache_missed;
+}
+
 static int journal_file_append_data(
                 JournalFile *f,
                 const void *data, uint64_t size,
-                Object **ret, uint64_t *ret_offset) {
+                Object **ret, uint64_t *ret_offset, uint64_t *ret_hash) {
 
         uint64_t hash, p;
         uint64_t osize;
@@ -1603,10 +1773,23 @@ static int journal_file_append_data(
 
         hash = journal_file_hash_data(f, data, size);
 
+        /* If the caller doesn't need the object itself, we can answer from the cache without touching
+         * the file at all. */
+        if (!ret && journal_file_data_cache_lookup(f, data, size, hash, &p)) {
+                if (ret_offset)
+                        *ret_offset = p;
+
+                if (ret_hash)
+                        *ret_hash = hash;
+
+                return 0;
+        }
+
         r = journal_file_find_data_object_with_hash(f, data, size, hash, &o, &p);
         if (r < 0)
                 return r;
         if (r > 0) {
+                journal_file_data_cache_put(f, data, size, hash, p);
 
                 if (ret)
                         *ret = o;
@@ -1614,6 +1797,9 @@ static int journal_file_append_data(
                 if (ret_offset)
                         *ret_offset = p;
 
+                if (ret_hash)
+                        *ret_hash = hash;
+
                 return 0;
         }
 
@@ -1628,7 +1814,8 @@ static int journal_file_append_data(
         if (JOURNAL_FILE_COMPRESS(f) && size >= f->compress_threshold_bytes) {
                 size_t rsize = 0;
 
-                compression = compress_blob(data, size, o->data.payload, size - 1, &rsize);
+                compression = compress_blob_with_context(journal_file_get_compress_context(f),
+                                                         data, size, o->data.payload, size - 1, &rsize);
 
                 if (compression >= 0) {
                         o->object.size = htole64(offsetof(Object, data.payload) + rsize);
@@ -1679,12 +1866,17 @@ static int journal_file_append_data(
                 fo->field.head_data_offset = le64toh(p);
         }
 
+        journal_file_data_cache_put(f, data, size, hash, p);
+
         if (ret)
                 *ret = o;
 
         if (ret_offset)
                 *ret_offset = p;
 
+        if (ret_hash)
+                *ret_hash = hash;
+
         return 0;
 }
 
@@ -1732,12 +1924,60 @@ uint64_t journal_file_hash_table_n_items(Object *o) {
         return (sz - offsetof(Object, hash_table.items)) / sizeof(HashItem);
 }
 
+typedef struct ChainCacheItem {
+        uint64_t first; /* the array at the beginning of the chain */
+        uint64_t array; /* the cached array */
+        uint64_t begin; /* the first item in the cached array */
+        uint64_t total; /* the total number of items in all arrays before this one in the chain */
+        uint64_t last_index; /* the last index we looked at, to optimize locality when bisecting */
+} ChainCacheItem;
+
+static void chain_cache_put(
+                OrderedHashmap *h,
+                ChainCacheItem *ci,
+                uint64_t first,
+                uint64_t array,
+                uint64_t begin,
+                uint64_t total,
+                uint64_t last_index) {
+
+        if (!ci) {
+                /* If the chain item to cache for this chain is the
+                 * first one it's not worth caching anything */
+                if (array == first)
+                        return;
+
+                if (ordered_hashmap_size(h) >= CHAIN_CACHE_MAX) {
+                        ci = ordered_hashmap_steal_first(h);
+                        assert(ci);
+                } else {
+                        ci = new(ChainCacheItem, 1);
+                        if (!ci)
+                                return;
+                }
+
+                ci->first = first;
+
+                if (ordered_hashmap_put(h, &ci->first, ci) < 0) {
+                        free(ci);
+                        return;
+                }
+        } else
+                assert(ci->first == first);
+
+        ci->array = array;
+        ci->begin = begin;
+        ci->total = total;
+        ci->last_index = last_index;
+}
+
 static int link_entry_into_array(JournalFile *f,
                                  le64_t *first,
                                  le64_t *idx,
                                  uint64_t p) {
         int r;
-        uint64_t n = 0, ap = 0, q, i, a, hidx;
+        uint64_t n = 0, ap = 0, q, i, a, hidx, t = 0, begin;
+        ChainCacheItem *ci;
         Object *o;
 
         assert(f);
@@ -1748,6 +1988,17 @@ static int link_entry_into_array(JournalFile *f,
 
         a = le64toh(*first);
         i = hidx = le64toh(READ_NOW(*idx));
+
+        /* New items are always appended at the end of the chain, hence skip right to the array we
+         * filled last time, instead of walking the whole chain again for each entry. Note that we never
+         * bisect here, hence we don't record a last index in the cache. */
+        ci = ordered_hashmap_get(f->chain_cache, &a);
+        if (ci && i > ci->total) {
+                a = ci->array;
+                i -= ci->total;
+                t = ci->total;
+        }
+
         while (a > 0) {
 
                 r = journal_file_move_to_object(f, OBJECT_ENTRY_ARRAY, a, &o);
@@ -1758,10 +2009,13 @@ static int link_entry_into_array(JournalFile *f,
                 if (i < n) {
                         o->entry_array.items[i] = htole64(p);
                         *idx = htole64(hidx + 1);
+
+                        chain_cache_put(f->chain_cache, ci, le64toh(*first), a, le64toh(o->entry_array.items[0]), t, UINT64_MAX);
                         return 0;
                 }
 
                 i -= n;
+                t += n;
                 ap = a;
                 a = le64toh(o->entry_array.next_entry_array_offset);
         }
@@ -1787,6 +2041,7 @@ static int link_entry_into_array(JournalFile *f,
 #endif
 
         o->entry_array.items[i] = htole64(p);
+        begin = le64toh(o->entry_array.items[0]);
 
         if (ap == 0)
                 *first = htole64(q);
@@ -1803,6 +2058,8 @@ static int link_entry_into_array(JournalFile *f,
 
         *idx = htole64(hidx + 1);
 
+        chain_cache_put(f->chain_cache, ci, le64toh(*first), q, begin, t, UINT64_MAX);
+
         return 0;
 }
 
@@ -2038,37 +2295,46 @@ static int entry_item_cmp(const EntryItem *a, const EntryItem *b) {
         return CMP(le64toh(a->object_offset), le64toh(b->object_offset));
 }
 
-int journal_file_append_entry(
+/* Data objects of the previously appended entry in a batch, so that payloads repeated in consecutive entries
+ * (_HOSTNAME=, _BOOT_ID=, _SYSTEMD_UNIT=, …) don't need to be looked up in the data hash table again. */
+typedef struct AppendEntryPrevious {
+        const struct iovec *iovec;
+        size_t n_iovec;
+        EntryItem *items;    /* in iovec order, not sorted */
+        uint64_t *xor_parts; /* the contribution of each item to the XOR hash */
+} AppendEntryPrevious;
+
+static int journal_file_append_entry_one(
                 JournalFile *f,
                 const dual_timestamp *ts,
                 const sd_id128_t *boot_id,
-                const struct iovec iovec[], unsigned n_iovec,
+                const struct iovec iovec[], size_t n_iovec,
+                EntryItem *items,
+                uint64_t *xor_parts,
+                const AppendEntryPrevious *previous,
                 uint64_t *seqnum,
                 Object **ret, uint64_t *ret_offset) {
 
-        unsigned i;
-        EntryItem *items;
-        int r;
+        EntryItem *sorted;
         uint64_t xor_hash = 0;
-        struct dual_timestamp _ts;
+        size_t i;
+        int r;
 
         assert(f);
         assert(f->header);
         assert(iovec || n_iovec == 0);
+        assert(items);
+        assert(xor_parts);
+        assert(ts);
 
-        if (ts) {
-                if (!VALID_REALTIME(ts->realtime))
-                        return log_debug_errno(SYNTHETIC_ERRNO(EBADMSG),
-                                               "Invalid realtime timestamp %" PRIu64 ", refusing entry.",
-                                               ts->realtime);
-                if (!VALID_MONOTONIC(ts->monotonic))
-                        return log_debug_errno(SYNTHETIC_ERRNO(EBADMSG),
-                                               "Invalid monotomic timestamp %" PRIu64 ", refusing entry.",
-                                               ts->monotonic);
-        } else {
-                dual_timestamp_get(&_ts);
-                ts = &_ts;
-        }
+        if (!VALID_REALTIME(ts->realtime))
+                return log_debug_errno(SYNTHETIC_ERRNO(EBADMSG),
+                                       "Invalid realtime timestamp %" PRIu64 ", refusing entry.",
+                                       ts->realtime);
+        if (!VALID_MONOTONIC(ts->monotonic))
+                return log_debug_errno(SYNTHETIC_ERRNO(EBADMSG),
+                                       "Invalid monotomic timestamp %" PRIu64 ", refusing entry.",
+                                       ts->monotonic);
 
 #if HAVE_GCRYPT
         r = journal_file_maybe_append_tag(f, ts->realtime);
@@ -2076,14 +2342,20 @@ int journal_file_append_entry(
                 return r;
 #endif
 
-        /* alloca() can't take 0, hence let's allocate at least one */
-        items = newa(EntryItem, MAX(1u, n_iovec));
-
         for (i = 0; i < n_iovec; i++) {
-                uint64_t p;
-                Object *o;
+                uint64_t p, h;
+
+                if (previous &&
+                    i < previous->n_iovec &&
+                    iovec[i].iov_len == previous->iovec[i].iov_len &&
+                    memcmp_safe(iovec[i].iov_base, previous->iovec[i].iov_base, iovec[i].iov_len) == 0) {
+                        items[i] = previous->items[i];
+                        xor_parts[i] = previous->xor_parts[i];
+                        xor_hash ^= xor_parts[i];
+                        continue;
+                }
 
-                r = journal_file_append_data(f, iovec[i].iov_base, iovec[i].iov_len, &o, &p);
+                r = journal_file_append_data(f, iovec[i].iov_base, iovec[i].iov_len, NULL, &p, &h);
                 if (r < 0)
                         return r;
 
@@ -2097,19 +2369,28 @@ int journal_file_append_entry(
                  * files things are easier, we can just take the value from the stored record directly. */
 
                 if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        xor_hash ^= jenkins_hash64(iovec[i].iov_base, iovec[i].iov_len);
+                        xor_parts[i] = jenkins_hash64(iovec[i].iov_base, iovec[i].iov_len);
                 else
-                        xor_hash ^= le64toh(o->data.hash);
+                        xor_parts[i] = h;
+
+                xor_hash ^= xor_parts[i];
 
                 items[i].object_offset = htole64(p);
-                items[i].hash = o->data.hash;
+                items[i].hash = htole64(h);
         }
 
-        /* Order by the position on disk, in order to improve seek
-         * times for rotating media. */
-        typesafe_qsort(items, n_iovec, entry_item_cmp);
+        /* Order by the position on disk, in order to improve seek times for rotating media. We sort a copy,
+         * so that the items stay in iovec order for the next entry in the batch. alloca() can't take 0,
+         * hence let's allocate at least one. */
+        sorted = newa(EntryItem, MAX(1u, n_iovec));
+        memcpy_safe(sorted, items, n_iovec * sizeof(EntryItem));
+        typesafe_qsort(sorted, n_iovec, entry_item_cmp);
 
-        r = journal_file_append_entry_internal(f, ts, boot_id, xor_hash, items, n_iovec, seqnum, ret, ret_offset);
+        return journal_file_append_entry_internal(f, ts, boot_id, xor_hash, sorted, n_iovec, seqnum, ret, ret_offset);
+}
+
+static int journal_file_append_finish(JournalFile *f, int r) {
+        assert(f);
 
         /* If the memory mapping triggered a SIGBUS then we return an
          * IO error and ignore the error code passed down to us, since
@@ -2127,51 +2408,100 @@ int journal_file_append_entry(
         return r;
 }
 
-typedef struct ChainCacheItem {
-        uint64_t first; /* the array at the beginning of the chain */
-        uint64_t array; /* the cached array */
-        uint64_t begin; /* the first item in the cached array */
-        uint64_t total; /* the total number of items in all arrays before this one in the chain */
-        uint64_t last_index; /* the last index we looked at, to optimize locality when bisecting */
-} ChainCacheItem;
+int journal_file_append_entry(
+                JournalFile *f,
+                const dual_timestamp *ts,
+                const sd_id128_t *boot_id,
+                const struct iovec iovec[], unsigned n_iovec,
+                uint64_t *seqnum,
+                Object **ret, uint64_t *ret_offset) {
 
-static void chain_cache_put(
-                OrderedHashmap *h,
-                ChainCacheItem *ci,
-                uint64_t first,
-                uint64_t array,
-                uint64_t begin,
-                uint64_t total,
-                uint64_t last_index) {
+        struct dual_timestamp _ts;
+        EntryItem *items;
+        uint64_t *xor_parts;
+        int r;
 
-        if (!ci) {
-                /* If the chain item to cache for this chain is the
-                 * first one it's not worth caching anything */
-                if (array == first)
-                        return;
+        assert(f);
+        assert(f->header);
+        assert(iovec || n_iovec == 0);
 
-                if (ordered_hashmap_size(h) >= CHAIN_CACHE_MAX) {
-                        ci = ordered_hashmap_steal_first(h);
-                        assert(ci);
-                } else {
-                        ci = new(ChainCacheItem, 1);
-                        if (!ci)
-                                return;
-                }
+        if (!ts) {
+                dual_timestamp_get(&_ts);
+                ts = &_ts;
+        }
 
-                ci->first = first;
+        /* alloca() can't take 0, hence let's allocate at least one */
+        items = newa(EntryItem, MAX(1u, n_iovec));
+        xor_parts = newa(uint64_t, MAX(1u, n_iovec));
 
-                if (ordered_hashmap_put(h, &ci->first, ci) < 0) {
-                        free(ci);
-                        return;
-                }
-        } else
-                assert(ci->first == first);
+        r = journal_file_append_entry_one(f, ts, boot_id, iovec, n_iovec, items, xor_parts, NULL, seqnum, ret, ret_offset);
 
-        ci->array = array;
-        ci->begin = begin;
-        ci->total = total;
-        ci->last_index = last_index;
+        return journal_file_append_finish(f, r);
+}
+
+int journal_file_append_entries(
+                JournalFile *f,
+                const JournalAppendEntry entries[], size_t n_entries,
+                uint64_t *seqnum,
+                size_t *ret_n_appended) {
+
+        _cleanup_free_ EntryItem *items = NULL, *previous_items = NULL;
+        _cleanup_free_ uint64_t *xor_parts = NULL, *previous_xor_parts = NULL;
+        AppendEntryPrevious previous = {};
+        size_t i, n_max = 1;
+        int r = 0;
+
+        assert(f);
+        assert(f->header);
+        assert(entries || n_entries == 0);
+
+        /* Appends a series of entries in one go. This is equivalent to calling journal_file_append_entry()
+         * for each of them, except that data objects repeated in consecutive entries are only looked up
+         * once, and that the change notification is only posted once for the whole batch. On failure,
+         * returns the number of entries that have been written successfully in ret_n_appended, so that the
+         * caller may retry the rest after rotating. */
+
+        for (i = 0; i < n_entries; i++)
+                n_max = MAX(n_max, entries[i].n_iovec);
+
+        items = new(EntryItem, n_max);
+        previous_items = new(EntryItem, n_max);
+        xor_parts = new(uint64_t, n_max);
+        previous_xor_parts = new(uint64_t, n_max);
+        if (!items || !previous_items || !xor_parts || !previous_xor_parts) {
+                r = -ENOMEM;
+                i = 0;
+                goto finish;
+        }
+
+        for (i = 0; i < n_entries; i++) {
+                assert(entries[i].iovec || entries[i].n_iovec == 0);
+
+                r = journal_file_append_entry_one(
+                                f, &entries[i].ts, NULL,
+                                entries[i].iovec, entries[i].n_iovec,
+                                items, xor_parts,
+                                i > 0 ? &previous : NULL,
+                                seqnum, NULL, NULL);
+                if (r < 0)
+                        break;
+
+                /* Remember what we just wrote, for the next entry in the batch */
+                SWAP_TWO(items, previous_items);
+                SWAP_TWO(xor_parts, previous_xor_parts);
+                previous = (AppendEntryPrevious) {
+                        .iovec = entries[i].iovec,
+                        .n_iovec = entries[i].n_iovec,
+                        .items = previous_items,
+                        .xor_parts = previous_xor_parts,
+                };
+        }
+
+finish:
+        if (ret_n_appended)
+                *ret_n_appended = i;
+
+        return journal_file_append_finish(f, r);
 }
 
 static int generic_array_get(
@@ -3381,6 +3711,7 @@ int journal_file_open(
 #if HAVE_GCRYPT
                 .seal = seal,
 #endif
+                .location_prioq_idx = PRIOQ_IDX_NULL,
         };
 
         /* We turn on keyed hashes by default, but provide an environment variable to turn them off, if
@@ -3632,8 +3963,10 @@ int journal_file_archive(JournalFile *f) {
         if (rename(f->path, p) < 0 && errno != ENOENT)
                 return -errno;
 
-        /* Sync the rename to disk */
-        (void) fsync_directory_of_file(f->fd);
+        /* Sync the rename to disk. This is done when the file is taken offline, which for deferred closes
+         * happens in a separate thread, so that rotating many files doesn't stall the caller. If no offline
+         * transition happens, journal_file_close() takes care of it. */
+        f->archive_sync_directory = true;
 
         /* Set as archive so offlining commits w/state=STATE_ARCHIVED. Previously we would set old_file->header->state
          * to STATE_ARCHIVED directly here, but journal_file_set_offline() short-circuits when state != STATE_ONLINE,
@@ -3817,11 +4150,10 @@ int journal_file_copy_entry(JournalFile *from, JournalFile *to, Object *o, uint6
         items = newa(EntryItem, MAX(1u, n));
 
         for (i = 0; i < n; i++) {
-                uint64_t l, h;
+                uint64_t l, h, hash;
                 le64_t le_hash;
                 size_t t;
                 void *data;
-                Object *u;
 
                 q = le64toh(o->entry.items[i].object_offset);
                 le_hash = o->entry.items[i].hash;
@@ -3848,8 +4180,9 @@ int journal_file_copy_entry(JournalFile *from, JournalFile *to, Object *o, uint6
 #if HAVE_COMPRESSION
                         size_t rsize = 0;
 
-                        r = decompress_blob(o->object.flags & OBJECT_COMPRESSION_MASK,
-                                            o->data.payload, l, &from->compress_buffer, &from->compress_buffer_size, &rsize, 0);
+                        r = decompress_blob_with_context(journal_file_get_compress_context(from),
+                                                         o->object.flags & OBJECT_COMPRESSION_MASK,
+                                                         o->data.payload, l, &from->compress_buffer, &from->compress_buffer_size, &rsize, 0);
                         if (r < 0)
                                 return r;
 
@@ -3861,17 +4194,17 @@ int journal_file_copy_entry(JournalFile *from, JournalFile *to, Object *o, uint6
                 } else
                         data = o->data.payload;
 
-                r = journal_file_append_data(to, data, l, &u, &h);
+                r = journal_file_append_data(to, data, l, NULL, &h, &hash);
                 if (r < 0)
                         return r;
 
                 if (JOURNAL_HEADER_KEYED_HASH(to->header))
                         xor_hash ^= jenkins_hash64(data, l);
                 else
-                        xor_hash ^= le64toh(u->data.hash);
+                        xor_hash ^= hash;
 
                 items[i].object_offset = htole64(h);
-                items[i].hash = u->data.hash;
+                items[i].hash = htole64(hash);
 
                 r = journal_file_move_to_object(from, OBJECT_ENTRY, p, &o);
                 if (r < 0)
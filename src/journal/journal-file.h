@@ -11,6 +11,7 @@
 #include "sd-event.h"
 #include "sd-id128.h"
 
+#include "compress.h"
 #include "hashmap.h"
 #include "journal-def.h"
 #include "mmap-cache.h"
@@ -56,6 +57,21 @@ typedef enum OfflineState {
         OFFLINE_DONE
 } OfflineState;
 
+/* A small per-file cache of recently appended data objects, so that payloads that repeat in every entry
+ * don't need to be looked up in the on-disk data hash table each time. */
+#define DATA_CACHE_SETS 128U
+#define DATA_CACHE_WAYS 2U
+#define DATA_CACHE_PAYLOAD_MAX 256U
+
+typedef struct DataCacheItem {
+        uint64_t hash;
+        uint64_t offset; /* 0 if this slot is unused */
+        size_t size;
+        size_t allocated;
+        void *payload;
+        bool referenced;
+} DataCacheItem;
+
 typedef struct JournalFile {
         int fd;
         MMapFileDescriptor *cache_fd;
@@ -77,6 +93,7 @@ typedef struct JournalFile {
         direction_t last_direction;
         LocationType location_type;
         uint64_t last_n_entries;
+        unsigned location_prioq_idx;
 
         char *path;
         struct stat last_stat;
@@ -101,8 +118,16 @@ typedef struct JournalFile {
 
         OrderedHashmap *chain_cache;
 
+        DataCacheItem *data_cache;
+        unsigned data_cache_hit;
+        unsigned data_cache_missed;
+
         pthread_t offline_thread;
         volatile OfflineState offline_state;
+        /* Set by journal_file_archive(), the directory is synced by the offlining thread, or by
+         * journal_file_close() if the file wasn't online. Not a bit field, since it is cleared from that
+         * thread. */
+        bool archive_sync_directory;
 
         unsigned last_seen_generation;
 
@@ -110,6 +135,7 @@ typedef struct JournalFile {
 #if HAVE_COMPRESSION
         void *compress_buffer;
         size_t compress_buffer_size;
+        CompressContext *compress_context;
 #endif
 
 #if HAVE_GCRYPT
@@ -204,6 +230,11 @@ static inline bool VALID_EPOCH(uint64_t u) {
         FLAGS_SET(le32toh((h)->incompatible_flags), HEADER_INCOMPATIBLE_KEYED_HASH)
 
 int journal_file_move_to_object(JournalFile *f, ObjectType type, uint64_t offset, Object **ret);
+void journal_mmap_cache_set_access(MMapCache *m, ObjectType type, MMapCacheAccess access);
+
+#if HAVE_COMPRESSION
+CompressContext *journal_file_get_compress_context(JournalFile *f);
+#endif
 
 uint64_t journal_file_entry_n_items(Object *o) _pure_;
 uint64_t journal_file_entry_array_n_items(Object *o) _pure_;
@@ -219,6 +250,18 @@ int journal_file_append_entry(
                 Object **ret,
                 uint64_t *offset);
 
+typedef struct JournalAppendEntry {
+        dual_timestamp ts;
+        const struct iovec *iovec;
+        size_t n_iovec;
+} JournalAppendEntry;
+
+int journal_file_append_entries(
+                JournalFile *f,
+                const JournalAppendEntry entries[], size_t n_entries,
+                uint64_t *seqno,
+                size_t *ret_n_appended);
+
 int journal_file_find_data_object(JournalFile *f, const void *data, uint64_t size, Object **ret, uint64_t *offset);
 int journal_file_find_data_object_with_hash(JournalFile *f, const void *data, uint64_t size, uint64_t hash, Object **ret, uint64_t *offset);
 
@@ -272,3 +315,6 @@ static inline bool JOURNAL_FILE_COMPRESS(JournalFile *f) {
 }
 
 uint64_t journal_file_hash_data(JournalFile *f, const void *data, size_t sz);
+
+unsigned journal_file_data_cache_get_hit(JournalFile *f);
+unsigned journal_file_data_cache_get_missed(JournalFile *f);
@@ -12,6 +12,7 @@
 #include "journal-def.h"
 #include "journal-file.h"
 #include "list.h"
+#include "prioq.h"
 #include "set.h"
 
 typedef struct Match Match;
@@ -33,6 +34,7 @@ struct Match {
         char *data;
         size_t size;
         uint64_t hash; /* old-style jenkins hash. New-style siphash is different per file, hence won't be cached here */
+        Hashmap *data_offsets; /* JournalFile* → uint64_t*, offset of the matching data object, 0 if none */
 
         /* For terms */
         LIST_HEAD(Match, matches);
@@ -75,6 +77,14 @@ struct sd_journal {
         IteratedCache *files_cache;
         MMapCache *mmap;
 
+        /* The files with a candidate entry for the next step, ordered by that entry's location in the
+         * current iteration direction, and the files that might still grow, see real_journal_next(). */
+        Prioq *files_by_location;
+        direction_t files_by_location_direction;
+        bool files_by_location_valid;
+        JournalFile **files_unarchived;
+        size_t n_files_unarchived, n_files_unarchived_allocated;
+
         Location current_location;
 
         JournalFile *current_file;
@@ -116,6 +126,10 @@ struct sd_journal {
 
         size_t data_threshold;
 
+        /* The catalog database, kept mapped between sd_journal_get_catalog() calls */
+        void *catalog_map;
+        struct stat catalog_stat;
+
         Hashmap *directories_by_path;
         Hashmap *directories_by_wd;
 
@@ -125,6 +139,9 @@ struct sd_journal {
 char *journal_make_match_string(sd_journal *j);
 void journal_print_header(sd_journal *j);
 
+void journal_set_access(sd_journal *j, ObjectType type, MMapCacheAccess access);
+void journal_set_mmap_windows_min(sd_journal *j, unsigned n);
+
 #define JOURNAL_FOREACH_DATA_RETVAL(j, data, l, retval)                     \
         for (sd_journal_restart_data(j); ((retval) = sd_journal_enumerate_data((j), &(data), &(l))) > 0; )
 
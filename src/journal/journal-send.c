@@ -35,18 +35,29 @@
                 memcpy(*_f + 10, _func, _fl);     \
         } while (false)
 
+static const union sockaddr_union journal_sa = {
+        .un.sun_family = AF_UNIX,
+        .un.sun_path = "/run/systemd/journal/socket",
+};
+
 /* We open a single fd, and we'll share it with the current process,
  * all its threads, and all its subprocesses. This means we need to
  * initialize it atomically, and need to operate on it atomically
  * never assuming we are the only user */
 
-static int journal_fd(void) {
+static int journal_fd(bool *ret_connected) {
+        bool c;
         int fd;
         static int fd_plus_one = 0;
+        static bool connected = false;
 
 retry:
-        if (fd_plus_one > 0)
+        if (fd_plus_one > 0) {
+                /* Note that this might briefly report false for a connected socket while another thread
+                 * initializes it. That's fine, as we can always specify the address explicitly. */
+                *ret_connected = connected;
                 return fd_plus_one - 1;
+        }
 
         fd = socket(AF_UNIX, SOCK_DGRAM|SOCK_CLOEXEC, 0);
         if (fd < 0)
@@ -54,11 +65,20 @@ retry:
 
         fd_inc_sndbuf(fd, SNDBUF_SIZE);
 
+        /* Connect right-away if the journal is around, so that the kernel doesn't have to look up the
+         * socket path for every single message we send. Otherwise, we specify the address with each
+         * message, as before. */
+        c = connect(fd, &journal_sa.sa, SOCKADDR_UN_LEN(journal_sa.un)) >= 0;
+
         if (!__sync_bool_compare_and_swap(&fd_plus_one, 0, fd+1)) {
                 safe_close(fd);
                 goto retry;
         }
 
+        if (c)
+                connected = true;
+
+        *ret_connected = c;
         return fd;
 }
 
@@ -210,17 +230,10 @@ _public_ int sd_journal_sendv(const struct iovec *iov, int n) {
         struct iovec *w;
         uint64_t *l;
         int i, j = 0;
-        static const union sockaddr_union sa = {
-                .un.sun_family = AF_UNIX,
-                .un.sun_path = "/run/systemd/journal/socket",
-        };
-        struct msghdr mh = {
-                .msg_name = (struct sockaddr*) &sa.sa,
-                .msg_namelen = SOCKADDR_UN_LEN(sa.un),
-        };
+        struct msghdr mh = {};
         ssize_t k;
         bool have_syslog_identifier = false;
-        bool seal = true;
+        bool seal = true, connected;
 
         assert_return(iov, -EINVAL);
         assert_return(n > 0, -EINVAL);
@@ -281,17 +294,36 @@ _public_ int sd_journal_sendv(const struct iovec *iov, int n) {
                 w[j++] = IOVEC_MAKE_STRING("\n");
         }
 
-        fd = journal_fd();
+        fd = journal_fd(&connected);
         if (_unlikely_(fd < 0))
                 return fd;
 
         mh.msg_iov = w;
         mh.msg_iovlen = j;
 
+        if (!connected) {
+                mh.msg_name = (struct sockaddr*) &journal_sa.sa;
+                mh.msg_namelen = SOCKADDR_UN_LEN(journal_sa.un);
+        }
+
         k = sendmsg(fd, &mh, MSG_NOSIGNAL);
         if (k >= 0)
                 return 0;
 
+        if (connected && IN_SET(errno, ECONNREFUSED, ENOTCONN)) {
+                /* The socket we were connected to went away, probably because the journal socket was
+                 * recreated. Reconnect to whatever is bound to the path now, and try again. If that
+                 * doesn't work, send to the path directly, which gives us the usual error handling. */
+                (void) connect(fd, &journal_sa.sa, SOCKADDR_UN_LEN(journal_sa.un));
+
+                mh.msg_name = (struct sockaddr*) &journal_sa.sa;
+                mh.msg_namelen = SOCKADDR_UN_LEN(journal_sa.un);
+
+                k = sendmsg(fd, &mh, MSG_NOSIGNAL);
+                if (k >= 0)
+                        return 0;
+        }
+
         /* Fail silently if the journal is not available */
         if (errno == ENOENT)
                 return 0;
@@ -329,7 +361,7 @@ _public_ int sd_journal_sendv(const struct iovec *iov, int n) {
                         return r;
         }
 
-        r = send_one_fd_sa(fd, buffer_fd, mh.msg_name, mh.msg_namelen, 0);
+        r = send_one_fd_sa(fd, buffer_fd, &journal_sa.sa, SOCKADDR_UN_LEN(journal_sa.un), 0);
         if (r == -ENOENT)
                 /* Fail silently if the journal is not available */
                 return 0;
@@ -11,6 +11,7 @@
 #include "fd-util.h"
 #include "format-util.h"
 #include "fs-util.h"
+#include "hashmap.h"
 #include "journal-def.h"
 #include "journal-file.h"
 #include "journal-vacuum.h"
@@ -30,6 +31,67 @@ struct vacuum_info {
         bool have_seqnum;
 };
 
+/* What an earlier run learnt about an archived journal file, so that it doesn't have to be opened again. The
+ * realtime is derived from the file name and timestamps that only ever grow, hence the cached value stays
+ * valid as long as it is still the same inode. */
+struct vacuum_cache_entry {
+        dev_t dev;
+        ino_t ino;
+        uint64_t realtime;
+};
+
+static void vacuum_cache_forget(Hashmap *cache, const char *fn) {
+        void *key = NULL;
+
+        free(hashmap_remove2(cache, fn, &key));
+        free(key);
+}
+
+static int vacuum_cache_remember(
+                Hashmap **cache,
+                Hashmap *old_cache,
+                const char *fn,
+                const struct stat *st,
+                uint64_t realtime) {
+
+        _cleanup_free_ struct vacuum_cache_entry *e = NULL;
+        _cleanup_free_ char *key = NULL;
+        int r;
+
+        assert(cache);
+        assert(fn);
+        assert(st);
+
+        r = hashmap_ensure_allocated(cache, &string_hash_ops);
+        if (r < 0)
+                return r;
+
+        e = hashmap_remove2(old_cache, fn, (void**) &key);
+        if (!e) {
+                e = new(struct vacuum_cache_entry, 1);
+                if (!e)
+                        return -ENOMEM;
+
+                key = strdup(fn);
+                if (!key)
+                        return -ENOMEM;
+        }
+
+        *e = (struct vacuum_cache_entry) {
+                .dev = st->st_dev,
+                .ino = st->st_ino,
+                .realtime = realtime,
+        };
+
+        r = hashmap_put(*cache, key, e);
+        if (r < 0)
+                return r;
+
+        TAKE_PTR(key);
+        TAKE_PTR(e);
+        return 0;
+}
+
 static int vacuum_compare(const struct vacuum_info *a, const struct vacuum_info *b) {
         int r;
 
@@ -49,7 +111,6 @@ static int vacuum_compare(const struct vacuum_info *a, const struct vacuum_info
 
 static void patch_realtime(
                 int fd,
-                const char *fn,
                 const struct stat *st,
                 unsigned long long *realtime) {
 
@@ -60,7 +121,6 @@ static void patch_realtime(
          * suggested... */
 
         assert(fd >= 0);
-        assert(fn);
         assert(st);
         assert(realtime);
 
@@ -81,17 +141,16 @@ static void patch_realtime(
          * unfortunately there's currently no sane API to query
          * it. Hence let's implement this manually... */
 
-        if (fd_getcrtime_at(fd, fn, &crtime, 0) >= 0) {
+        if (fd_getcrtime(fd, &crtime) >= 0) {
                 if (crtime < *realtime)
                         *realtime = crtime;
         }
 }
 
-static int journal_file_empty(int dir_fd, const char *name) {
-        _cleanup_close_ int fd;
-        struct stat st;
-        le64_t n_entries;
-        ssize_t n;
+static int journal_file_open_header(int dir_fd, const char *name) {
+        int fd;
+
+        /* Only the header of the file is looked at, via pread(), hence there's no need to map it */
 
         fd = openat(dir_fd, name, O_RDONLY|O_CLOEXEC|O_NOFOLLOW|O_NONBLOCK|O_NOATIME);
         if (fd < 0) {
@@ -101,11 +160,22 @@ static int journal_file_empty(int dir_fd, const char *name) {
                         return -errno;
         }
 
-        if (fstat(fd, &st) < 0)
-                return -errno;
+        return fd;
+}
+
+static int journal_file_empty(int fd, const struct stat *st) {
+        le64_t n_entries;
+        ssize_t n;
+
+        assert(fd >= 0);
+        assert(st);
+
+        /* The stat data is the one from the directory enumeration. The file might have been replaced
+         * since, but then the file the fd refers to is checked, which is fine, we only look at the header
+         * of it. */
 
         /* If an offline file doesn't even have a header we consider it empty */
-        if (st.st_size < (off_t) sizeof(Header))
+        if (st->st_size < (off_t) sizeof(Header))
                 return 1;
 
         /* If the number of entries is empty, we consider it empty, too */
@@ -118,8 +188,9 @@ static int journal_file_empty(int dir_fd, const char *name) {
         return le64toh(n_entries) <= 0;
 }
 
-int journal_directory_vacuum(
+int journal_directory_vacuum_full(
                 const char *directory,
+                Hashmap **cache,
                 uint64_t max_use,
                 uint64_t n_max_files,
                 usec_t max_retention_usec,
@@ -130,6 +201,7 @@ int journal_directory_vacuum(
         size_t n_list = 0, n_allocated = 0, i;
         _cleanup_closedir_ DIR *d = NULL;
         struct vacuum_info *list = NULL;
+        Hashmap *new_cache = NULL;
         usec_t retention_limit = 0;
         char sbytes[FORMAT_BYTES_MAX];
         struct dirent *de;
@@ -150,6 +222,7 @@ int journal_directory_vacuum(
         FOREACH_DIRENT_ALL(de, d, r = -errno; goto finish) {
 
                 unsigned long long seqnum = 0, realtime;
+                struct vacuum_cache_entry *e;
                 _cleanup_free_ char *p = NULL;
                 sd_id128_t seqnum_id;
                 bool have_seqnum;
@@ -239,28 +312,48 @@ int journal_directory_vacuum(
 
                 size = 512UL * (uint64_t) st.st_blocks;
 
-                r = journal_file_empty(dirfd(d), p);
-                if (r < 0) {
-                        log_debug_errno(r, "Failed check if %s is empty, ignoring: %m", p);
-                        continue;
-                }
-                if (r > 0) {
-                        /* Always vacuum empty non-online files. */
+                e = cache ? hashmap_get(*cache, p) : NULL;
+                if (e && e->dev == st.st_dev && e->ino == st.st_ino)
+                        /* Seen before, and known not to be empty */
+                        realtime = e->realtime;
+                else {
+                        _cleanup_close_ int fd = -1;
 
-                        r = unlinkat_deallocate(dirfd(d), p, 0);
-                        if (r >= 0) {
+                        fd = journal_file_open_header(dirfd(d), p);
+                        if (fd < 0) {
+                                log_debug_errno(fd, "Failed to open %s, ignoring: %m", p);
+                                continue;
+                        }
 
-                                log_full(verbose ? LOG_INFO : LOG_DEBUG,
-                                         "Deleted empty archived journal %s/%s (%s).", directory, p, format_bytes(sbytes, sizeof(sbytes), size));
+                        r = journal_file_empty(fd, &st);
+                        if (r < 0) {
+                                log_debug_errno(r, "Failed check if %s is empty, ignoring: %m", p);
+                                continue;
+                        }
+                        if (r > 0) {
+                                /* Always vacuum empty non-online files. */
 
-                                freed += size;
-                        } else if (r != -ENOENT)
-                                log_warning_errno(r, "Failed to delete empty archived journal %s/%s: %m", directory, p);
+                                r = unlinkat_deallocate(dirfd(d), p, 0);
+                                if (r >= 0) {
 
-                        continue;
+                                        log_full(verbose ? LOG_INFO : LOG_DEBUG,
+                                                 "Deleted empty archived journal %s/%s (%s).", directory, p, format_bytes(sbytes, sizeof(sbytes), size));
+
+                                        freed += size;
+                                } else if (r != -ENOENT)
+                                        log_warning_errno(r, "Failed to delete empty archived journal %s/%s: %m", directory, p);
+
+                                continue;
+                        }
+
+                        patch_realtime(fd, &st, &realtime);
                 }
 
-                patch_realtime(dirfd(d), p, &st, &realtime);
+                if (cache) {
+                        r = vacuum_cache_remember(&new_cache, *cache, p, &st, realtime);
+                        if (r < 0)
+                                goto finish;
+                }
 
                 if (!GREEDY_REALLOC(list, n_allocated, n_list + 1)) {
                         r = -ENOMEM;
@@ -296,6 +389,8 @@ int journal_directory_vacuum(
                         log_full(verbose ? LOG_INFO : LOG_DEBUG, "Deleted archived journal %s/%s (%s).", directory, list[i].filename, format_bytes(sbytes, sizeof(sbytes), list[i].usage));
                         freed += list[i].usage;
 
+                        vacuum_cache_forget(new_cache, list[i].filename);
+
                         if (list[i].usage < sum)
                                 sum -= list[i].usage;
                         else
@@ -311,6 +406,12 @@ int journal_directory_vacuum(
         r = 0;
 
 finish:
+        if (cache) {
+                /* Entries for files that weren't seen this time are dropped with the old cache */
+                hashmap_free_free_free(*cache);
+                *cache = new_cache;
+        }
+
         for (i = 0; i < n_list; i++)
                 free(list[i].filename);
         free(list);
@@ -4,6 +4,13 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include "hashmap.h"
 #include "time-util.h"
 
-int journal_directory_vacuum(const char *directory, uint64_t max_use, uint64_t n_max_files, usec_t max_retention_usec, usec_t *oldest_usec, bool verbose);
+/* If cache is non-NULL, what was learnt about the archived files is kept in *cache across calls, so that
+ * files that were already looked at needn't be opened again. Free it with hashmap_free_free_free(). */
+int journal_directory_vacuum_full(const char *directory, Hashmap **cache, uint64_t max_use, uint64_t n_max_files, usec_t max_retention_usec, usec_t *oldest_usec, bool verbose);
+
+static inline int journal_directory_vacuum(const char *directory, uint64_t max_use, uint64_t n_max_files, usec_t max_retention_usec, usec_t *oldest_usec, bool verbose) {
+        return journal_directory_vacuum_full(directory, NULL, max_use, n_max_files, max_retention_usec, oldest_usec, verbose);
+}
@@ -17,7 +17,6 @@
 #include "lookup3.h"
 #include "macro.h"
 #include "terminal-util.h"
-#include "tmpfile-util.h"
 #include "util.h"
 
 static void draw_progress(uint64_t p, usec_t *last_usec) {
@@ -350,56 +349,83 @@ static int journal_file_object_verify(JournalFile *f, uint64_t offset, Object *o
         return 0;
 }
 
-static int write_uint64(int fd, uint64_t p) {
-        ssize_t k;
-
-        k = write(fd, &p, sizeof(p));
-        if (k < 0)
+/* One bit for each 8 byte aligned offset in the file, marking the start of the objects of one type. A
+ * lookup is a bit test, instead of a bisection through a sorted list of offsets, and the mapping is
+ * anonymous, hence no temporary files are needed. Pages of the bitmap are only populated where objects
+ * of the type are actually placed. */
+typedef struct OffsetBitmap {
+        uint64_t *bits;
+        size_t size;
+        uint64_t n_bits;
+} OffsetBitmap;
+
+static int offset_bitmap_init(OffsetBitmap *b, uint64_t max_offset) {
+        uint64_t n;
+        void *m;
+
+        assert(b);
+
+        n = max_offset / sizeof(uint64_t) + 1;
+        if (DIV_ROUND_UP(n, 64) > SIZE_MAX / sizeof(uint64_t))
+                return -EFBIG;
+
+        m = mmap(NULL, DIV_ROUND_UP(n, 64) * sizeof(uint64_t), PROT_READ|PROT_WRITE,
+                 MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+        if (m == MAP_FAILED)
                 return -errno;
-        if (k != sizeof(p))
-                return -EIO;
+
+        *b = (OffsetBitmap) {
+                .bits = m,
+                .size = DIV_ROUND_UP(n, 64) * sizeof(uint64_t),
+                .n_bits = n,
+        };
 
         return 0;
 }
 
-static int contains_uint64(MMapCache *m, MMapFileDescriptor *f, uint64_t n, uint64_t p) {
-        uint64_t a, b;
-        int r;
+static void offset_bitmap_done(OffsetBitmap *b) {
+        assert(b);
 
-        assert(m);
-        assert(f);
+        if (b->bits)
+                (void) munmap(b->bits, b->size);
 
-        /* Bisection ... */
+        *b = (OffsetBitmap) {};
+}
 
-        a = 0; b = n;
-        while (a < b) {
-                uint64_t c, *z;
+static int offset_bitmap_add(OffsetBitmap *b, uint64_t p) {
+        uint64_t i;
 
-                c = (a + b) / 2;
+        assert(b);
+        assert(VALID64(p));
 
-                r = mmap_cache_get(m, f, PROT_READ|PROT_WRITE, 0, false, c * sizeof(uint64_t), sizeof(uint64_t), NULL, (void **) &z, NULL);
-                if (r < 0)
-                        return r;
+        i = p / sizeof(uint64_t);
+        if (i >= b->n_bits) {
+                error(p, "Object beyond the end of the file");
+                return -EBADMSG;
+        }
 
-                if (*z == p)
-                        return 1;
+        b->bits[i / 64] |= UINT64_C(1) << (i % 64);
+        return 0;
+}
 
-                if (a + 1 >= b)
-                        return 0;
+static bool offset_bitmap_contains(const OffsetBitmap *b, uint64_t p) {
+        uint64_t i;
 
-                if (p < *z)
-                        b = c;
-                else
-                        a = c;
-        }
+        assert(b);
 
-        return 0;
+        if (!VALID64(p))
+                return false;
+
+        i = p / sizeof(uint64_t);
+        if (i >= b->n_bits)
+                return false;
+
+        return b->bits[i / 64] & (UINT64_C(1) << (i % 64));
 }
 
 static int entry_points_to_data(
                 JournalFile *f,
-                MMapFileDescriptor *cache_entry_fd,
-                uint64_t n_entries,
+                const OffsetBitmap *entries,
                 uint64_t entry_p,
                 uint64_t data_p) {
 
@@ -409,9 +435,9 @@ static int entry_points_to_data(
         bool found = false;
 
         assert(f);
-        assert(cache_entry_fd);
+        assert(entries);
 
-        if (!contains_uint64(f->mmap, cache_entry_fd, n_entries, entry_p)) {
+        if (!offset_bitmap_contains(entries, entry_p)) {
                 error(data_p, "Data object references invalid entry at "OFSfmt, entry_p);
                 return -EBADMSG;
         }
@@ -485,16 +511,16 @@ static int entry_points_to_data(
 static int verify_data(
                 JournalFile *f,
                 Object *o, uint64_t p,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays) {
+                const OffsetBitmap *entries,
+                const OffsetBitmap *entry_arrays) {
 
         uint64_t i, n, a, last, q;
         int r;
 
         assert(f);
         assert(o);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
+        assert(entries);
+        assert(entry_arrays);
 
         n = le64toh(o->data.n_entries);
         a = le64toh(o->data.entry_array_offset);
@@ -512,7 +538,7 @@ static int verify_data(
         assert(o->data.entry_offset);
 
         last = q = le64toh(o->data.entry_offset);
-        r = entry_points_to_data(f, cache_entry_fd, n_entries, q, p);
+        r = entry_points_to_data(f, entries, q, p);
         if (r < 0)
                 return r;
 
@@ -525,7 +551,7 @@ static int verify_data(
                         return -EBADMSG;
                 }
 
-                if (!contains_uint64(f->mmap, cache_entry_array_fd, n_entry_arrays, a)) {
+                if (!offset_bitmap_contains(entry_arrays, a)) {
                         error(p, "Invalid array offset "OFSfmt, a);
                         return -EBADMSG;
                 }
@@ -550,7 +576,7 @@ static int verify_data(
                         }
                         last = q;
 
-                        r = entry_points_to_data(f, cache_entry_fd, n_entries, q, p);
+                        r = entry_points_to_data(f, entries, q, p);
                         if (r < 0)
                                 return r;
 
@@ -568,9 +594,9 @@ static int verify_data(
 
 static int verify_hash_table(
                 JournalFile *f,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays,
+                const OffsetBitmap *data,
+                const OffsetBitmap *entries,
+                const OffsetBitmap *entry_arrays,
                 usec_t *last_usec,
                 bool show_progress) {
 
@@ -578,9 +604,9 @@ static int verify_hash_table(
         int r;
 
         assert(f);
-        assert(cache_data_fd);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
+        assert(data);
+        assert(entries);
+        assert(entry_arrays);
         assert(last_usec);
 
         n = le64toh(f->header->data_hash_table_size) / sizeof(HashItem);
@@ -602,7 +628,7 @@ static int verify_hash_table(
                         Object *o;
                         uint64_t next;
 
-                        if (!contains_uint64(f->mmap, cache_data_fd, n_data, p)) {
+                        if (!offset_bitmap_contains(data, p)) {
                                 error(p, "Invalid data object at hash entry %"PRIu64" of %"PRIu64, i, n);
                                 return -EBADMSG;
                         }
@@ -622,7 +648,7 @@ static int verify_hash_table(
                                 return -EBADMSG;
                         }
 
-                        r = verify_data(f, o, p, cache_entry_fd, n_entries, cache_entry_array_fd, n_entry_arrays);
+                        r = verify_data(f, o, p, entries, entry_arrays);
                         if (r < 0)
                                 return r;
 
@@ -674,14 +700,14 @@ static int data_object_in_hash_table(JournalFile *f, uint64_t hash, uint64_t p)
 static int verify_entry(
                 JournalFile *f,
                 Object *o, uint64_t p,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data) {
+                const OffsetBitmap *data) {
 
         uint64_t i, n;
         int r;
 
         assert(f);
         assert(o);
-        assert(cache_data_fd);
+        assert(data);
 
         n = journal_file_entry_n_items(o);
         for (i = 0; i < n; i++) {
@@ -691,7 +717,7 @@ static int verify_entry(
                 q = le64toh(o->entry.items[i].object_offset);
                 h = le64toh(o->entry.items[i].hash);
 
-                if (!contains_uint64(f->mmap, cache_data_fd, n_data, q)) {
+                if (!offset_bitmap_contains(data, q)) {
                         error(p, "Invalid data object of entry");
                         return -EBADMSG;
                 }
@@ -719,9 +745,9 @@ static int verify_entry(
 
 static int verify_entry_array(
                 JournalFile *f,
-                MMapFileDescriptor *cache_data_fd, uint64_t n_data,
-                MMapFileDescriptor *cache_entry_fd, uint64_t n_entries,
-                MMapFileDescriptor *cache_entry_array_fd, uint64_t n_entry_arrays,
+                const OffsetBitmap *data,
+                const OffsetBitmap *entries,
+                const OffsetBitmap *entry_arrays,
                 usec_t *last_usec,
                 bool show_progress) {
 
@@ -729,9 +755,9 @@ static int verify_entry_array(
         int r;
 
         assert(f);
-        assert(cache_data_fd);
-        assert(cache_entry_fd);
-        assert(cache_entry_array_fd);
+        assert(data);
+        assert(entries);
+        assert(entry_arrays);
         assert(last_usec);
 
         n = le64toh(f->header->n_entries);
@@ -748,7 +774,7 @@ static int verify_entry_array(
                         return -EBADMSG;
                 }
 
-                if (!contains_uint64(f->mmap, cache_entry_array_fd, n_entry_arrays, a)) {
+                if (!offset_bitmap_contains(entry_arrays, a)) {
                         error(a, "Invalid array %"PRIu64" of %"PRIu64, i, n);
                         return -EBADMSG;
                 }
@@ -774,7 +800,7 @@ static int verify_entry_array(
                         }
                         last = p;
 
-                        if (!contains_uint64(f->mmap, cache_entry_fd, n_entries, p)) {
+                        if (!offset_bitmap_contains(entries, p)) {
                                 error(a, "Invalid array entry at %"PRIu64" of %"PRIu64, i, n);
                                 return -EBADMSG;
                         }
@@ -783,7 +809,7 @@ static int verify_entry_array(
                         if (r < 0)
                                 return r;
 
-                        r = verify_entry(f, o, p, cache_data_fd, n_data);
+                        r = verify_entry(f, o, p, data);
                         if (r < 0)
                                 return r;
 
@@ -813,11 +839,10 @@ int journal_file_verify(
         bool entry_seqnum_set = false, entry_monotonic_set = false, entry_realtime_set = false, found_main_entry_array = false;
         uint64_t n_weird = 0, n_objects = 0, n_entries = 0, n_data = 0, n_fields = 0, n_data_hash_tables = 0, n_field_hash_tables = 0, n_entry_arrays = 0, n_tags = 0;
         usec_t last_usec = 0;
-        int data_fd = -1, entry_fd = -1, entry_array_fd = -1;
-        MMapFileDescriptor *cache_data_fd = NULL, *cache_entry_fd = NULL, *cache_entry_array_fd = NULL;
+        OffsetBitmap data = {}, entries = {}, entry_arrays = {};
+        uint64_t max_offset;
         unsigned i;
         bool found_last = false;
-        const char *tmp_dir = NULL;
 
 #if HAVE_GCRYPT
         uint64_t last_tag = 0;
@@ -837,46 +862,23 @@ int journal_file_verify(
         } else if (f->seal)
                 return -ENOKEY;
 
-        r = var_tmp_dir(&tmp_dir);
+        /* The tail object offset comes from the file, hence don't trust it for sizing the bitmaps. No object
+         * can start beyond the end of the file anyway. */
+        r = journal_file_fstat(f);
         if (r < 0) {
-                log_error_errno(r, "Failed to determine temporary directory: %m");
+                log_error_errno(r, "Failed to stat journal file: %m");
                 goto fail;
         }
 
-        data_fd = open_tmpfile_unlinkable(tmp_dir, O_RDWR | O_CLOEXEC);
-        if (data_fd < 0) {
-                r = log_error_errno(data_fd, "Failed to create data file: %m");
-                goto fail;
-        }
+        max_offset = MIN(le64toh(f->header->tail_object_offset), (uint64_t) f->last_stat.st_size);
 
-        entry_fd = open_tmpfile_unlinkable(tmp_dir, O_RDWR | O_CLOEXEC);
-        if (entry_fd < 0) {
-                r = log_error_errno(entry_fd, "Failed to create entry file: %m");
-                goto fail;
-        }
-
-        entry_array_fd = open_tmpfile_unlinkable(tmp_dir, O_RDWR | O_CLOEXEC);
-        if (entry_array_fd < 0) {
-                r = log_error_errno(entry_array_fd,
-                                    "Failed to create entry array file: %m");
-                goto fail;
-        }
-
-        cache_data_fd = mmap_cache_add_fd(f->mmap, data_fd);
-        if (!cache_data_fd) {
-                r = log_oom();
-                goto fail;
-        }
-
-        cache_entry_fd = mmap_cache_add_fd(f->mmap, entry_fd);
-        if (!cache_entry_fd) {
-                r = log_oom();
-                goto fail;
-        }
-
-        cache_entry_array_fd = mmap_cache_add_fd(f->mmap, entry_array_fd);
-        if (!cache_entry_array_fd) {
-                r = log_oom();
+        r = offset_bitmap_init(&data, max_offset);
+        if (r >= 0)
+                r = offset_bitmap_init(&entries, max_offset);
+        if (r >= 0)
+                r = offset_bitmap_init(&entry_arrays, max_offset);
+        if (r < 0) {
+                log_error_errno(r, "Failed to allocate object bitmaps: %m");
                 goto fail;
         }
 
@@ -896,6 +898,8 @@ int journal_file_verify(
         /* First iteration: we go through all objects, verify the
          * superficial structure, headers, hashes. */
 
+        journal_mmap_cache_set_access(f->mmap, OBJECT_UNUSED, MMAP_CACHE_ACCESS_SEQUENTIAL);
+
         p = le64toh(f->header->header_size);
         for (;;) {
                 /* Early exit if there are no objects in the file, at all */
@@ -954,7 +958,7 @@ int journal_file_verify(
                 switch (o->object.type) {
 
                 case OBJECT_DATA:
-                        r = write_uint64(data_fd, p);
+                        r = offset_bitmap_add(&data, p);
                         if (r < 0)
                                 goto fail;
 
@@ -972,7 +976,7 @@ int journal_file_verify(
                                 goto fail;
                         }
 
-                        r = write_uint64(entry_fd, p);
+                        r = offset_bitmap_add(&entries, p);
                         if (r < 0)
                                 goto fail;
 
@@ -1059,7 +1063,7 @@ int journal_file_verify(
                         break;
 
                 case OBJECT_ENTRY_ARRAY:
-                        r = write_uint64(entry_array_fd, p);
+                        r = offset_bitmap_add(&entry_arrays, p);
                         if (r < 0)
                                 goto fail;
 
@@ -1249,6 +1253,8 @@ int journal_file_verify(
                 goto fail;
         }
 
+        journal_mmap_cache_set_access(f->mmap, OBJECT_UNUSED, MMAP_CACHE_ACCESS_NORMAL);
+
         /* Second iteration: we follow all objects referenced from the
          * two entry points: the object hash table and the entry
          * array. We also check that everything referenced (directly
@@ -1258,18 +1264,14 @@ int journal_file_verify(
          * referenced is consistent. */
 
         r = verify_entry_array(f,
-                               cache_data_fd, n_data,
-                               cache_entry_fd, n_entries,
-                               cache_entry_array_fd, n_entry_arrays,
+                               &data, &entries, &entry_arrays,
                                &last_usec,
                                show_progress);
         if (r < 0)
                 goto fail;
 
         r = verify_hash_table(f,
-                              cache_data_fd, n_data,
-                              cache_entry_fd, n_entries,
-                              cache_entry_array_fd, n_entry_arrays,
+                              &data, &entries, &entry_arrays,
                               &last_usec,
                               show_progress);
         if (r < 0)
@@ -1278,13 +1280,9 @@ int journal_file_verify(
         if (show_progress)
                 flush_progress();
 
-        mmap_cache_free_fd(f->mmap, cache_data_fd);
-        mmap_cache_free_fd(f->mmap, cache_entry_fd);
-        mmap_cache_free_fd(f->mmap, cache_entry_array_fd);
-
-        safe_close(data_fd);
-        safe_close(entry_fd);
-        safe_close(entry_array_fd);
+        offset_bitmap_done(&data);
+        offset_bitmap_done(&entries);
+        offset_bitmap_done(&entry_arrays);
 
         if (first_contained)
                 *first_contained = le64toh(f->header->head_entry_realtime);
@@ -1299,29 +1297,17 @@ fail:
         if (show_progress)
                 flush_progress();
 
+        journal_mmap_cache_set_access(f->mmap, OBJECT_UNUSED, MMAP_CACHE_ACCESS_NORMAL);
+
         log_error("File corruption detected at %s:"OFSfmt" (of %llu bytes, %"PRIu64"%%).",
                   f->path,
                   p,
                   (unsigned long long) f->last_stat.st_size,
                   100 * p / f->last_stat.st_size);
 
-        if (data_fd >= 0)
-                safe_close(data_fd);
-
-        if (entry_fd >= 0)
-                safe_close(entry_fd);
-
-        if (entry_array_fd >= 0)
-                safe_close(entry_array_fd);
-
-        if (cache_data_fd)
-                mmap_cache_free_fd(f->mmap, cache_data_fd);
-
-        if (cache_entry_fd)
-                mmap_cache_free_fd(f->mmap, cache_entry_fd);
-
-        if (cache_entry_array_fd)
-                mmap_cache_free_fd(f->mmap, cache_entry_array_fd);
+        offset_bitmap_done(&data);
+        offset_bitmap_done(&entries);
+        offset_bitmap_done(&entry_arrays);
 
         return r;
 }
@@ -2445,6 +2445,11 @@ int main(int argc, char *argv[]) {
                 goto finish;
         }
 
+        /* Exports walk through the files front to back, tell the mmap cache to map large windows and read
+         * ahead for entry objects */
+        if (arg_output == OUTPUT_EXPORT && !arg_reverse)
+                journal_set_access(j, OBJECT_ENTRY, MMAP_CACHE_ACCESS_SEQUENTIAL);
+
         /* Opening the fd now means the first sd_journal_wait() will actually wait */
         if (arg_follow) {
                 poll_fd = sd_journal_get_fd(j);
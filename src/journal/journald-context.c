@@ -14,10 +14,12 @@
 #include "io-util.h"
 #include "journal-util.h"
 #include "journald-context.h"
+#include "memory-util.h"
 #include "parse-util.h"
 #include "path-util.h"
 #include "process-util.h"
 #include "procfs-util.h"
+#include "stdio-util.h"
 #include "string-util.h"
 #include "syslog-util.h"
 #include "unaligned.h"
@@ -66,6 +68,9 @@
 #define CACHE_MAX_MAX (16*1024U)
 #define CACHE_MAX_MIN 64U
 
+/* The number of trusted fields client_context_serialize_fields() generates at most */
+#define N_IOVEC_CONTEXT_FIELDS 18
+
 static size_t cache_max(void) {
         static size_t cached = -1;
 
@@ -185,6 +190,10 @@ static void client_context_reset(Server *s, ClientContext *c) {
 
         c->log_ratelimit_interval = s->ratelimit_interval;
         c->log_ratelimit_burst = s->ratelimit_burst;
+
+        c->fields_iovec = mfree(c->fields_iovec);
+        c->fields_n_iovec = 0;
+        c->fields_data = mfree(c->fields_data);
 }
 
 static ClientContext* client_context_free(Server *s, ClientContext *c) {
@@ -506,6 +515,118 @@ static int client_context_read_log_ratelimit_burst(ClientContext *c) {
         return safe_atou(value, &c->log_ratelimit_burst);
 }
 
+typedef struct FieldsBuilder {
+        struct iovec iovec[N_IOVEC_CONTEXT_FIELDS];
+        size_t n_iovec;
+        char *data;
+        size_t size, allocated;
+} FieldsBuilder;
+
+static int fields_builder_add(FieldsBuilder *b, const char *field, const void *value, size_t value_size) {
+        size_t l;
+        char *p;
+
+        assert(b);
+        assert(field);
+        assert(b->n_iovec < N_IOVEC_CONTEXT_FIELDS);
+
+        l = strlen(field);
+
+        if (!GREEDY_REALLOC(b->data, b->allocated, b->size + l + value_size))
+                return -ENOMEM;
+
+        p = mempcpy(b->data + b->size, field, l);
+        memcpy_safe(p, value, value_size);
+
+        /* The buffer might move while we add more fields, hence store the offset for now */
+        b->iovec[b->n_iovec++] = IOVEC_MAKE((void*) (uintptr_t) b->size, l + value_size);
+        b->size += l + value_size;
+
+        return 0;
+}
+
+#define FIELDS_BUILDER_ADD_NUMERIC(b, value, type, isset, format, field) \
+        if (isset(value)) {                                             \
+                char k[DECIMAL_STR_MAX(type) + 1];                     \
+                xsprintf(k, format, value);                            \
+                r = fields_builder_add(b, field "=", k, strlen(k));   \
+                if (r < 0)                                              \
+                        goto finish;                                    \
+        }
+
+#define FIELDS_BUILDER_ADD_STRING(b, value, field)                      \
+        if (!isempty(value)) {                                          \
+                r = fields_builder_add(b, field "=", value, strlen(value)); \
+                if (r < 0)                                              \
+                        goto finish;                                    \
+        }
+
+static int client_context_serialize_fields(ClientContext *c) {
+        FieldsBuilder b = {};
+        int r;
+
+        assert(c);
+
+        /* Formats all trusted fields of the context once, so that dispatching a message only needs to copy
+         * the resulting iovecs. On failure the block is left unset, and the fields are formatted for each
+         * message instead. */
+
+        c->fields_iovec = mfree(c->fields_iovec);
+        c->fields_n_iovec = 0;
+        c->fields_data = mfree(c->fields_data);
+
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->pid, pid_t, pid_is_valid, PID_FMT, "_PID");
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->uid, uid_t, uid_is_valid, UID_FMT, "_UID");
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->gid, gid_t, gid_is_valid, GID_FMT, "_GID");
+
+        FIELDS_BUILDER_ADD_STRING(&b, c->comm, "_COMM");
+        FIELDS_BUILDER_ADD_STRING(&b, c->exe, "_EXE");
+        FIELDS_BUILDER_ADD_STRING(&b, c->cmdline, "_CMDLINE");
+        FIELDS_BUILDER_ADD_STRING(&b, c->capeff, "_CAP_EFFECTIVE");
+
+        if (c->label_size > 0) {
+                r = fields_builder_add(&b, "_SELINUX_CONTEXT=", c->label, c->label_size);
+                if (r < 0)
+                        goto finish;
+        }
+
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->auditid, uint32_t, audit_session_is_valid, "%" PRIu32, "_AUDIT_SESSION");
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->loginuid, uid_t, uid_is_valid, UID_FMT, "_AUDIT_LOGINUID");
+
+        FIELDS_BUILDER_ADD_STRING(&b, c->cgroup, "_SYSTEMD_CGROUP");
+        FIELDS_BUILDER_ADD_STRING(&b, c->session, "_SYSTEMD_SESSION");
+        FIELDS_BUILDER_ADD_NUMERIC(&b, c->owner_uid, uid_t, uid_is_valid, UID_FMT, "_SYSTEMD_OWNER_UID");
+        FIELDS_BUILDER_ADD_STRING(&b, c->unit, "_SYSTEMD_UNIT");
+        FIELDS_BUILDER_ADD_STRING(&b, c->user_unit, "_SYSTEMD_USER_UNIT");
+        FIELDS_BUILDER_ADD_STRING(&b, c->slice, "_SYSTEMD_SLICE");
+        FIELDS_BUILDER_ADD_STRING(&b, c->user_slice, "_SYSTEMD_USER_SLICE");
+
+        if (!sd_id128_is_null(c->invocation_id)) {
+                char k[SD_ID128_STRING_MAX];
+
+                r = fields_builder_add(&b, "_SYSTEMD_INVOCATION_ID=", sd_id128_to_string(c->invocation_id, k), SD_ID128_STRING_MAX - 1);
+                if (r < 0)
+                        goto finish;
+        }
+
+        c->fields_iovec = newdup(struct iovec, b.iovec, b.n_iovec);
+        if (!c->fields_iovec) {
+                r = -ENOMEM;
+                goto finish;
+        }
+
+        for (size_t i = 0; i < b.n_iovec; i++)
+                c->fields_iovec[i].iov_base = b.data + (uintptr_t) b.iovec[i].iov_base;
+
+        c->fields_n_iovec = b.n_iovec;
+        c->fields_data = TAKE_PTR(b.data);
+        r = 0;
+
+finish:
+        free(b.data);
+        return r;
+}
+
 static void client_context_really_refresh(
                 Server *s,
                 ClientContext *c,
@@ -535,6 +656,8 @@ static void client_context_really_refresh(
         (void) client_context_read_log_ratelimit_interval(c);
         (void) client_context_read_log_ratelimit_burst(c);
 
+        (void) client_context_serialize_fields(c);
+
         c->timestamp = timestamp;
 
         if (c->in_lru) {
@@ -7,6 +7,7 @@
 
 #include "sd-id128.h"
 
+#include "journald-rate-limit.h"
 #include "time-util.h"
 
 typedef struct ClientContext ClientContext;
@@ -55,6 +56,12 @@ struct ClientContext {
 
         usec_t log_ratelimit_interval;
         unsigned log_ratelimit_burst;
+        JournalRateLimitRef ratelimit_ref;
+
+        /* The trusted fields above, serialized into one block whenever the context is refreshed */
+        struct iovec *fields_iovec;
+        size_t fields_n_iovec;
+        char *fields_data;
 };
 
 int client_context_get(
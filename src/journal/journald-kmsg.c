@@ -22,6 +22,7 @@
 #include "process-util.h"
 #include "stdio-util.h"
 #include "string-util.h"
+#include "strv.h"
 
 void server_forward_kmsg(
                 Server *s,
@@ -94,6 +95,72 @@ static bool is_us(const char *identifier, const char *pid) {
                streq(identifier, program_invocation_short_name);
 }
 
+/* How long the udev fields of a device are reused for further kernel messages about the same device */
+#define DEV_KMSG_DEVICE_CACHE_USEC (1*USEC_PER_SEC)
+
+/* How many records to read from /dev/kmsg per wakeup at most */
+#define DEV_KMSG_READ_MAX 64U
+
+static char** dev_kmsg_device_fields(Server *s, const char *device_id) {
+        _cleanup_(sd_device_unrefp) sd_device *d = NULL;
+        _cleanup_strv_free_ char **l = NULL;
+        _cleanup_free_ char *id = NULL;
+        usec_t n;
+
+        assert(s);
+        assert(device_id);
+
+        /* Looking up a device hits sysfs and the udev database. When the kernel floods the log about a
+         * device, that's done again and again for the same one, hence remember the result for the last
+         * device for a short while. The udev database might change in the meantime, for example when a
+         * device was just added, but the fields are only allowed to be out of date for a moment, after
+         * which they are looked up again. Devices that can't be found are remembered as well. */
+
+        n = now(CLOCK_MONOTONIC);
+
+        if (streq_ptr(s->dev_kmsg_device_id, device_id) &&
+            n < usec_add(s->dev_kmsg_device_timestamp, DEV_KMSG_DEVICE_CACHE_USEC))
+                return s->dev_kmsg_device_fields;
+
+        id = strdup(device_id);
+        if (!id)
+                return NULL;
+
+        l = strv_new(NULL);
+        if (!l)
+                return NULL;
+
+        if (sd_device_new_from_device_id(&d, device_id) >= 0) {
+                const char *g;
+                size_t j = 0;
+
+                if (sd_device_get_devname(d, &g) >= 0)
+                        if (strv_consume(&l, strjoin("_UDEV_DEVNODE=", g)) < 0)
+                                return NULL;
+
+                if (sd_device_get_sysname(d, &g) >= 0)
+                        if (strv_consume(&l, strjoin("_UDEV_SYSNAME=", g)) < 0)
+                                return NULL;
+
+                FOREACH_DEVICE_DEVLINK(d, g) {
+
+                        if (j >= N_IOVEC_UDEV_FIELDS)
+                                break;
+
+                        if (strv_consume(&l, strjoin("_UDEV_DEVLINK=", g)) < 0)
+                                return NULL;
+
+                        j++;
+                }
+        }
+
+        free_and_replace(s->dev_kmsg_device_id, id);
+        strv_free_and_replace(s->dev_kmsg_device_fields, l);
+        s->dev_kmsg_device_timestamp = n;
+
+        return s->dev_kmsg_device_fields;
+}
+
 void dev_kmsg_record(Server *s, char *p, size_t l) {
 
         _cleanup_free_ char *message = NULL, *syslog_priority = NULL, *syslog_pid = NULL, *syslog_facility = NULL, *syslog_identifier = NULL, *source_time = NULL, *identifier = NULL, *pid = NULL;
@@ -210,43 +277,11 @@ void dev_kmsg_record(Server *s, char *p, size_t l) {
         }
 
         if (kernel_device) {
-                _cleanup_(sd_device_unrefp) sd_device *d = NULL;
-
-                if (sd_device_new_from_device_id(&d, kernel_device) >= 0) {
-                        const char *g;
-                        char *b;
-
-                        if (sd_device_get_devname(d, &g) >= 0) {
-                                b = strjoin("_UDEV_DEVNODE=", g);
-                                if (b) {
-                                        iovec[n++] = IOVEC_MAKE_STRING(b);
-                                        z++;
-                                }
-                        }
-
-                        if (sd_device_get_sysname(d, &g) >= 0) {
-                                b = strjoin("_UDEV_SYSNAME=", g);
-                                if (b) {
-                                        iovec[n++] = IOVEC_MAKE_STRING(b);
-                                        z++;
-                                }
-                        }
-
-                        j = 0;
-                        FOREACH_DEVICE_DEVLINK(d, g) {
-
-                                if (j >= N_IOVEC_UDEV_FIELDS)
-                                        break;
-
-                                b = strjoin("_UDEV_DEVLINK=", g);
-                                if (b) {
-                                        iovec[n++] = IOVEC_MAKE_STRING(b);
-                                        z++;
-                                }
-
-                                j++;
-                        }
-                }
+                char **i;
+
+                /* These are owned by the cache, hence not counted in z */
+                STRV_FOREACH(i, dev_kmsg_device_fields(s, kernel_device))
+                        iovec[n++] = IOVEC_MAKE_STRING(*i);
         }
 
         if (asprintf(&source_time, "_SOURCE_MONOTONIC_TIMESTAMP=%llu", usec) >= 0)
@@ -360,7 +395,22 @@ static int dispatch_dev_kmsg(sd_event_source *es, int fd, uint32_t revents, void
         if (!(revents & EPOLLIN))
                 log_error("Got invalid event from epoll for /dev/kmsg: %"PRIx32, revents);
 
-        return server_read_dev_kmsg(s);
+        /* Each read() returns exactly one record. Read a bunch of them while we are at it, instead of
+         * going back to the event loop for every single one, but not an unbounded number, so that the
+         * other sources still get their turn during a flood. */
+        for (unsigned i = 0; i < DEV_KMSG_READ_MAX; i++) {
+                int r;
+
+                r = server_read_dev_kmsg(s);
+                if (r <= 0)
+                        return r;
+
+                /* The event source might have been disabled while reading */
+                if (!s->dev_kmsg_event_source)
+                        break;
+        }
+
+        return 0;
 }
 
 int server_open_dev_kmsg(Server *s) {
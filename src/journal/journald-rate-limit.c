@@ -7,12 +7,12 @@
 #include "journald-rate-limit.h"
 #include "list.h"
 #include "random-util.h"
+#include "string-table.h"
 #include "string-util.h"
 #include "time-util.h"
 
 #define POOLS_MAX 5
 #define BUCKETS_MAX 127
-#define GROUPS_MAX 2047
 
 static const int priority_map[] = {
         [LOG_EMERG]   = 0,
@@ -26,12 +26,15 @@ static const int priority_map[] = {
 };
 
 typedef struct JournalRateLimitPool JournalRateLimitPool;
-typedef struct JournalRateLimitGroup JournalRateLimitGroup;
 
 struct JournalRateLimitPool {
+        /* The beginning of the current window, or in token bucket mode the time of the last refill */
         usec_t begin;
         unsigned num;
         unsigned suppressed;
+
+        /* In token bucket mode: the credit left, where each message costs the interval length */
+        uint64_t credit;
 };
 
 struct JournalRateLimitGroup {
@@ -56,6 +59,9 @@ struct JournalRateLimit {
 
         unsigned n_groups;
 
+        /* Increased whenever a group is freed, see JournalRateLimitRef */
+        uint64_t generation;
+
         uint8_t hash_key[16];
 };
 
@@ -84,6 +90,7 @@ static void journal_ratelimit_group_free(JournalRateLimitGroup *g) {
                 LIST_REMOVE(bucket, g->parent->buckets[g->hash % BUCKETS_MAX], g);
 
                 g->parent->n_groups--;
+                g->parent->generation++;
         }
 
         free(g->id);
@@ -117,7 +124,7 @@ static void journal_ratelimit_vacuum(JournalRateLimit *r, usec_t ts) {
         /* Makes room for at least one new item, but drop all
          * expored items too. */
 
-        while (r->n_groups >= GROUPS_MAX ||
+        while (r->n_groups >= JOURNAL_RATELIMIT_GROUPS_MAX ||
                (r->lru_tail && journal_ratelimit_group_expired(r->lru_tail, ts)))
                 journal_ratelimit_group_free(r->lru_tail);
 }
@@ -184,12 +191,84 @@ static unsigned burst_modulate(unsigned burst, uint64_t available) {
         return burst;
 }
 
-int journal_ratelimit_test(JournalRateLimit *r, const char *id, usec_t rl_interval, unsigned rl_burst, int priority, uint64_t available) {
-        uint64_t h;
+static int pool_test_window(JournalRateLimitPool *p, usec_t ts, usec_t rl_interval, unsigned burst) {
+        assert(p);
+
+        if (p->begin <= 0) {
+                p->suppressed = 0;
+                p->num = 1;
+                p->begin = ts;
+                return 1;
+        }
+
+        if (p->begin + rl_interval < ts) {
+                unsigned s;
+
+                s = p->suppressed;
+                p->suppressed = 0;
+                p->num = 1;
+                p->begin = ts;
+
+                return 1 + s;
+        }
+
+        if (p->num < burst) {
+                p->num++;
+                return 1;
+        }
+
+        p->suppressed++;
+        return 0;
+}
+
+static int pool_test_token_bucket(JournalRateLimitPool *p, usec_t ts, usec_t rl_interval, unsigned burst) {
+        uint64_t max;
+        unsigned s;
+
+        assert(p);
+
+        /* The bucket holds up to burst messages and is refilled continuously at a rate of burst messages
+         * per interval. Hence a unit may log burst messages at once after being quiet, and keeps logging
+         * at the average rate afterwards, without the hard cut-off until the end of a fixed window. To
+         * avoid fractions, credit is accounted in units of 1/interval of a message. */
+
+        max = (uint64_t) burst * rl_interval;
+
+        if (p->begin <= 0)
+                p->credit = max;
+        else if (ts > p->begin)
+                /* Never refill by more than the maximum, which also protects against overflows */
+                p->credit = MIN(max, p->credit + (uint64_t) MIN(ts - p->begin, rl_interval) * burst);
+
+        p->begin = ts;
+
+        if (p->credit < rl_interval) {
+                p->suppressed++;
+                return 0;
+        }
+
+        p->credit -= rl_interval;
+
+        s = p->suppressed;
+        p->suppressed = 0;
+
+        return 1 + s;
+}
+
+int journal_ratelimit_test(
+                JournalRateLimit *r,
+                const char *id,
+                JournalRateLimitRef *ref,
+                JournalRateLimitMode mode,
+                usec_t rl_interval,
+                unsigned rl_burst,
+                int priority,
+                uint64_t available,
+                usec_t ts) {
+
         JournalRateLimitGroup *g;
         JournalRateLimitPool *p;
         unsigned burst;
-        usec_t ts;
 
         assert(id);
 
@@ -198,19 +277,26 @@ int journal_ratelimit_test(JournalRateLimit *r, const char *id, usec_t rl_interv
          * 0     → the log message shall be suppressed,
          * 1 + n → the log message shall be permitted, and n messages were dropped from the peer before
          * < 0   → error
+         *
+         * ts is the current time in CLOCK_MONOTONIC.
          */
 
         if (!r)
                 return 1;
 
-        ts = now(CLOCK_MONOTONIC);
+        if (ref && ref->group && ref->generation == r->generation && streq(ref->group->id, id))
+                /* The group is still around, no need to hash the id */
+                g = ref->group;
+        else {
+                uint64_t h;
 
-        h = siphash24_string(id, r->hash_key);
-        g = r->buckets[h % BUCKETS_MAX];
+                h = siphash24_string(id, r->hash_key);
+                g = r->buckets[h % BUCKETS_MAX];
 
-        LIST_FOREACH(bucket, g, g)
-                if (streq(g->id, id))
-                        break;
+                LIST_FOREACH(bucket, g, g)
+                        if (streq(g->id, id))
+                                break;
+        }
 
         if (!g) {
                 g = journal_ratelimit_group_new(r, id, rl_interval, ts);
@@ -219,6 +305,12 @@ int journal_ratelimit_test(JournalRateLimit *r, const char *id, usec_t rl_interv
         } else
                 g->interval = rl_interval;
 
+        if (ref)
+                *ref = (JournalRateLimitRef) {
+                        .group = g,
+                        .generation = r->generation,
+                };
+
         if (rl_interval == 0 || rl_burst == 0)
                 return 1;
 
@@ -226,29 +318,15 @@ int journal_ratelimit_test(JournalRateLimit *r, const char *id, usec_t rl_interv
 
         p = &g->pools[priority_map[priority]];
 
-        if (p->begin <= 0) {
-                p->suppressed = 0;
-                p->num = 1;
-                p->begin = ts;
-                return 1;
-        }
+        if (mode == JOURNAL_RATELIMIT_TOKEN_BUCKET)
+                return pool_test_token_bucket(p, ts, rl_interval, burst);
 
-        if (p->begin + rl_interval < ts) {
-                unsigned s;
-
-                s = p->suppressed;
-                p->suppressed = 0;
-                p->num = 1;
-                p->begin = ts;
-
-                return 1 + s;
-        }
+        return pool_test_window(p, ts, rl_interval, burst);
+}
 
-        if (p->num < burst) {
-                p->num++;
-                return 1;
-        }
+static const char* const journal_ratelimit_mode_table[_JOURNAL_RATELIMIT_MODE_MAX] = {
+        [JOURNAL_RATELIMIT_WINDOW] = "window",
+        [JOURNAL_RATELIMIT_TOKEN_BUCKET] = "token-bucket",
+};
 
-        p->suppressed++;
-        return 0;
-}
+DEFINE_STRING_TABLE_LOOKUP(journal_ratelimit_mode, JournalRateLimitMode);
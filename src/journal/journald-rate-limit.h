@@ -1,10 +1,41 @@
 /* SPDX-License-Identifier: LGPL-2.1+ */
 #pragma once
 
+#include "macro.h"
 #include "time-util.h"
 
+/* The maximum number of clients accounted at the same time, the least recently added ones are dropped */
+#define JOURNAL_RATELIMIT_GROUPS_MAX 2047
+
 typedef struct JournalRateLimit JournalRateLimit;
+typedef struct JournalRateLimitGroup JournalRateLimitGroup;
+
+typedef enum JournalRateLimitMode {
+        JOURNAL_RATELIMIT_WINDOW,       /* At most burst messages per fixed interval */
+        JOURNAL_RATELIMIT_TOKEN_BUCKET, /* Credit for burst messages, refilled continuously over the interval */
+        _JOURNAL_RATELIMIT_MODE_MAX,
+        _JOURNAL_RATELIMIT_MODE_INVALID = -1,
+} JournalRateLimitMode;
+
+/* Remembers the group a client was accounted to last time, so that it doesn't have to be looked up by hash
+ * again. Only used as long as no group was freed in the meantime, which the generation tells. */
+typedef struct JournalRateLimitRef {
+        JournalRateLimitGroup *group;
+        uint64_t generation;
+} JournalRateLimitRef;
 
 JournalRateLimit *journal_ratelimit_new(void);
 void journal_ratelimit_free(JournalRateLimit *r);
-int journal_ratelimit_test(JournalRateLimit *r, const char *id, usec_t rl_interval, unsigned rl_burst, int priority, uint64_t available);
+int journal_ratelimit_test(
+                JournalRateLimit *r,
+                const char *id,
+                JournalRateLimitRef *ref,
+                JournalRateLimitMode mode,
+                usec_t rl_interval,
+                unsigned rl_burst,
+                int priority,
+                uint64_t available,
+                usec_t ts);
+
+const char *journal_ratelimit_mode_to_string(JournalRateLimitMode m) _const_;
+JournalRateLimitMode journal_ratelimit_mode_from_string(const char *s) _pure_;
@@ -474,6 +474,8 @@ static int do_rotate(
 static void server_process_deferred_closes(Server *s) {
         JournalFile *f;
 
+        s->n_deferred_closes_peak = MAX(s->n_deferred_closes_peak, set_size(s->deferred_closes));
+
         /* Perform any deferred closes which aren't still offlining. */
         SET_FOREACH(f, s->deferred_closes) {
                 if (journal_file_is_offlining(f))
@@ -500,6 +502,7 @@ static void server_vacuum_deferred_closes(Server *s) {
 
                 assert_se(f = set_steal_first(s->deferred_closes));
                 journal_file_close(f);
+                s->n_deferred_closes_forced++;
         }
 }
 
@@ -633,12 +636,20 @@ void server_rotate(Server *s) {
                 (void) vacuum_offline_user_journals(s);
 
         server_process_deferred_closes(s);
+
+        log_debug("Rotation done, %u journal files still being taken offline in the background "
+                  "(at most %u so far, %u closed synchronously since the queue was full).",
+                  set_size(s->deferred_closes), s->n_deferred_closes_peak, s->n_deferred_closes_forced);
 }
 
 void server_sync(Server *s) {
         JournalFile *f;
         int r;
 
+        /* Release any rotated files whose offlining completed in the meantime, so that they don't linger
+         * until the next rotation. */
+        server_process_deferred_closes(s);
+
         if (s->system_journal) {
                 r = journal_file_set_offline(s->system_journal, false);
                 if (r < 0)
@@ -672,9 +683,9 @@ static void do_vacuum(Server *s, JournalStorage *storage, bool verbose) {
         if (verbose)
                 server_space_usage_message(s, storage);
 
-        r = journal_directory_vacuum(storage->path, storage->space.limit,
-                                     storage->metrics.n_max_files, s->max_retention_usec,
-                                     &s->oldest_file_usec, verbose);
+        r = journal_directory_vacuum_full(storage->path, &storage->vacuum_cache, storage->space.limit,
+                                          storage->metrics.n_max_files, s->max_retention_usec,
+                                          &s->oldest_file_usec, verbose);
         if (r < 0 && r != -ENOENT)
                 log_warning_errno(r, "Failed to vacuum %s, ignoring: %m", storage->path);
 
@@ -788,14 +799,15 @@ static bool shall_try_append_again(JournalFile *f, int r) {
         }
 }
 
-static void write_to_journal(Server *s, uid_t uid, struct iovec *iovec, size_t n, int priority) {
-        bool vacuumed = false, rotate = false;
+static void write_entries_to_journal(Server *s, uid_t uid, JournalAppendEntry *entries, size_t n, int priority) {
+        bool vacuumed = false, retried = false, rotate = false, written = false;
         struct dual_timestamp ts;
         JournalFile *f;
+        size_t i, k;
         int r;
 
         assert(s);
-        assert(iovec);
+        assert(entries);
         assert(n > 0);
 
         /* Get the closest, linearized time we have for this log event from the event loop. (Note that we do not use
@@ -804,6 +816,9 @@ static void write_to_journal(Server *s, uid_t uid, struct iovec *iovec, size_t n
         assert_se(sd_event_now(s->event, CLOCK_REALTIME, &ts.realtime) >= 0);
         assert_se(sd_event_now(s->event, CLOCK_MONOTONIC, &ts.monotonic) >= 0);
 
+        for (i = 0; i < n; i++)
+                entries[i].ts = ts;
+
         if (ts.realtime < s->last_realtime_clock) {
                 /* When the time jumps backwards, let's immediately rotate. Of course, this should not happen during
                  * regular operation. However, when it does happen, then we should make sure that we start fresh files
@@ -836,30 +851,154 @@ static void write_to_journal(Server *s, uid_t uid, struct iovec *iovec, size_t n
 
         s->last_realtime_clock = ts.realtime;
 
-        r = journal_file_append_entry(f, &ts, NULL, iovec, n, &s->seqnum, NULL, NULL);
-        if (r >= 0) {
+        while (n > 0) {
+                r = journal_file_append_entries(f, entries, n, &s->seqnum, &k);
+                written = written || k > 0;
+                if (r >= 0)
+                        break;
+
+                if (vacuumed || !shall_try_append_again(f, r)) {
+                        if (retried)
+                                log_error_errno(r, "Failed to write entry (%zu items, %zu bytes) despite vacuuming, ignoring: %m",
+                                                entries[k].n_iovec, IOVEC_TOTAL_SIZE(entries[k].iovec, entries[k].n_iovec));
+                        else
+                                log_error_errno(r, "Failed to write entry (%zu items, %zu bytes), ignoring: %m",
+                                                entries[k].n_iovec, IOVEC_TOTAL_SIZE(entries[k].iovec, entries[k].n_iovec));
+
+                        /* Skip over the entry that failed, and try the rest of the batch */
+                        entries += k + 1;
+                        n -= k + 1;
+                        continue;
+                }
+
+                /* Everything before the failed entry made it to the old file, retry the rest */
+                entries += k;
+                n -= k;
+
+                server_rotate(s);
+                server_vacuum(s, false);
+                vacuumed = retried = true;
+
+                f = find_journal(s, uid);
+                if (!f)
+                        return;
+
+                log_debug("Retrying write.");
+        }
+
+        if (written)
                 server_schedule_sync(s, priority);
+}
+
+static void server_flush_batch(Server *s) {
+        JournalAppendEntry *e;
+        struct iovec *i;
+        ServerBatch *b;
+
+        assert(s);
+
+        b = &s->batch;
+        if (b->n_entries == 0)
                 return;
+
+        /* The buffers might have been reallocated while we collected the entries, hence we only stored
+         * offsets so far. Now that everything is in place, turn them into pointers. */
+        i = b->iovec;
+        for (e = b->entries; e < b->entries + b->n_entries; e++) {
+                size_t j;
+
+                e->iovec = i;
+                for (j = 0; j < e->n_iovec; j++, i++)
+                        i->iov_base = b->buffer + (uintptr_t) i->iov_base;
         }
 
-        if (vacuumed || !shall_try_append_again(f, r)) {
-                log_error_errno(r, "Failed to write entry (%zu items, %zu bytes), ignoring: %m", n, IOVEC_TOTAL_SIZE(iovec, n));
-                return;
+        /* Messages generated while writing (e.g. about rotation) are written out directly */
+        b->flushing = true;
+        write_entries_to_journal(s, b->uid, b->entries, b->n_entries, b->priority);
+        b->flushing = false;
+
+        b->n_entries = b->n_iovec = b->buffer_size = 0;
+}
+
+static int server_batch_add(Server *s, uid_t uid, const struct iovec *iovec, size_t n, int priority) {
+        ServerBatch *b;
+        size_t i, sz;
+
+        assert(s);
+
+        b = &s->batch;
+
+        /* Entries for different journal files need to go in different batches */
+        if (b->n_entries > 0 && b->uid != uid)
+                server_flush_batch(s);
+
+        sz = IOVEC_TOTAL_SIZE(iovec, n);
+
+        if (!GREEDY_REALLOC(b->entries, b->n_entries_allocated, b->n_entries + 1) ||
+            !GREEDY_REALLOC(b->iovec, b->n_iovec_allocated, b->n_iovec + n) ||
+            !GREEDY_REALLOC(b->buffer, b->buffer_allocated, b->buffer_size + sz))
+                return -ENOMEM;
+
+        if (b->n_entries == 0) {
+                b->uid = uid;
+                b->priority = priority;
+        } else
+                b->priority = MIN(b->priority, priority);
+
+        b->entries[b->n_entries++] = (JournalAppendEntry) {
+                .n_iovec = n,
+        };
+
+        for (i = 0; i < n; i++) {
+                b->iovec[b->n_iovec++] = IOVEC_MAKE((void*) (uintptr_t) b->buffer_size, iovec[i].iov_len);
+                memcpy_safe(b->buffer + b->buffer_size, iovec[i].iov_base, iovec[i].iov_len);
+                b->buffer_size += iovec[i].iov_len;
         }
 
-        server_rotate(s);
-        server_vacuum(s, false);
+        if (b->n_entries >= SERVER_BATCH_ENTRIES_MAX || b->buffer_size >= SERVER_BATCH_SIZE_MAX)
+                server_flush_batch(s);
+
+        return 0;
+}
+
+void server_begin_batch(Server *s) {
+        assert(s);
+
+        s->batch.n_open++;
+}
+
+void server_end_batch(Server *s) {
+        assert(s);
+        assert(s->batch.n_open > 0);
 
-        f = find_journal(s, uid);
-        if (!f)
+        if (--s->batch.n_open > 0)
                 return;
 
-        log_debug("Retrying write.");
-        r = journal_file_append_entry(f, &ts, NULL, iovec, n, &s->seqnum, NULL, NULL);
-        if (r < 0)
-                log_error_errno(r, "Failed to write entry (%zu items, %zu bytes) despite vacuuming, ignoring: %m", n, IOVEC_TOTAL_SIZE(iovec, n));
-        else
-                server_schedule_sync(s, priority);
+        server_flush_batch(s);
+}
+
+static void write_to_journal(Server *s, uid_t uid, struct iovec *iovec, size_t n, int priority) {
+        JournalAppendEntry e;
+
+        assert(s);
+        assert(iovec);
+        assert(n > 0);
+
+        if (s->batch.n_open > 0 && !s->batch.flushing) {
+                if (server_batch_add(s, uid, iovec, n, priority) >= 0)
+                        return;
+
+                /* If we can't queue the entry, write out what we have and then this one directly */
+                log_oom();
+                server_flush_batch(s);
+        }
+
+        e = (JournalAppendEntry) {
+                .iovec = iovec,
+                .n_iovec = n,
+        };
+
+        write_entries_to_journal(s, uid, &e, 1, priority);
 }
 
 #define IOVEC_ADD_NUMERIC_FIELD(iovec, n, value, type, isset, format, field)  \
@@ -914,7 +1053,11 @@ static void dispatch_message_real(
                (pid_is_valid(object_pid) ? N_IOVEC_OBJECT_FIELDS : 0) +
                client_context_extra_fields_n_iovec(c) <= m);
 
-        if (c) {
+        if (c && c->fields_iovec) {
+                /* The common case: the trusted fields have been formatted already */
+                memcpy(iovec + n, c->fields_iovec, c->fields_n_iovec * sizeof(struct iovec));
+                n += c->fields_n_iovec;
+        } else if (c) {
                 IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->pid, pid_t, pid_is_valid, PID_FMT, "_PID");
                 IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->uid, uid_t, uid_is_valid, UID_FMT, "_UID");
                 IOVEC_ADD_NUMERIC_FIELD(iovec, n, c->gid, gid_t, gid_is_valid, GID_FMT, "_GID");
@@ -941,11 +1084,11 @@ static void dispatch_message_real(
                 IOVEC_ADD_STRING_FIELD(iovec, n, c->user_slice, "_SYSTEMD_USER_SLICE");
 
                 IOVEC_ADD_ID128_FIELD(iovec, n, c->invocation_id, "_SYSTEMD_INVOCATION_ID");
+        }
 
-                if (c->extra_fields_n_iovec > 0) {
-                        memcpy(iovec + n, c->extra_fields_iovec, c->extra_fields_n_iovec * sizeof(struct iovec));
-                        n += c->extra_fields_n_iovec;
-                }
+        if (c && c->extra_fields_n_iovec > 0) {
+                memcpy(iovec + n, c->extra_fields_iovec, c->extra_fields_n_iovec * sizeof(struct iovec));
+                n += c->extra_fields_n_iovec;
         }
 
         assert(n <= m);
@@ -1095,7 +1238,9 @@ void server_dispatch_message(
         if (c && c->unit) {
                 (void) determine_space(s, &available, NULL);
 
-                rl = journal_ratelimit_test(s->ratelimit, c->unit, c->log_ratelimit_interval, c->log_ratelimit_burst, priority & LOG_PRIMASK, available);
+                rl = journal_ratelimit_test(s->ratelimit, c->unit, &c->ratelimit_ref, s->ratelimit_mode,
+                                            c->log_ratelimit_interval, c->log_ratelimit_burst,
+                                            priority & LOG_PRIMASK, available, now(CLOCK_MONOTONIC));
                 if (rl == 0)
                         return;
 
@@ -1247,76 +1392,41 @@ static int server_relinquish_var(Server *s) {
         return 0;
 }
 
-int server_process_datagram(
-                sd_event_source *es,
+/* We use NAME_MAX space for the SELinux label here. The kernel currently enforces no limit, but according
+ * to suggestions from the SELinux people this will change and it will probably be identical to NAME_MAX. For
+ * now we use that, but this should be updated one day when the final limit is known. */
+typedef CMSG_BUFFER_TYPE(CMSG_SPACE(sizeof(struct ucred)) +
+                         CMSG_SPACE(sizeof(struct timeval)) +
+                         CMSG_SPACE(sizeof(int)) + /* fd */
+                         CMSG_SPACE(NAME_MAX) /* selinux label */) DatagramControl;
+
+static size_t datagram_buffer_size(int v) {
+        /* Fix it up, if it is too small. We use the same fixed value as auditd here. Awful! */
+        return PAGE_ALIGN(MAX3((size_t) v + 1,
+                               (size_t) LINE_MAX,
+                               ALIGN(sizeof(struct nlmsghdr)) + ALIGN((size_t) MAX_AUDIT_MESSAGE_LENGTH)) + 1);
+}
+
+static void server_process_datagram_one(
+                Server *s,
                 int fd,
-                uint32_t revents,
-                void *userdata) {
+                char *buffer,
+                size_t n,
+                struct msghdr *msghdr) {
 
-        Server *s = userdata;
         struct ucred *ucred = NULL;
         struct timeval *tv = NULL;
         struct cmsghdr *cmsg;
         char *label = NULL;
-        size_t label_len = 0, m;
-        struct iovec iovec;
-        ssize_t n;
-        int *fds = NULL, v = 0;
+        size_t label_len = 0;
+        int *fds = NULL;
         size_t n_fds = 0;
 
-        /* We use NAME_MAX space for the SELinux label here. The kernel currently enforces no limit, but
-         * according to suggestions from the SELinux people this will change and it will probably be
-         * identical to NAME_MAX. For now we use that, but this should be updated one day when the final
-         * limit is known. */
-        CMSG_BUFFER_TYPE(CMSG_SPACE(sizeof(struct ucred)) +
-                         CMSG_SPACE(sizeof(struct timeval)) +
-                         CMSG_SPACE(sizeof(int)) + /* fd */
-                         CMSG_SPACE(NAME_MAX) /* selinux label */) control;
-
-        union sockaddr_union sa = {};
-
-        struct msghdr msghdr = {
-                .msg_iov = &iovec,
-                .msg_iovlen = 1,
-                .msg_control = &control,
-                .msg_controllen = sizeof(control),
-                .msg_name = &sa,
-                .msg_namelen = sizeof(sa),
-        };
-
         assert(s);
-        assert(fd == s->native_fd || fd == s->syslog_fd || fd == s->audit_fd);
-
-        if (revents != EPOLLIN)
-                return log_error_errno(SYNTHETIC_ERRNO(EIO),
-                                       "Got invalid event from epoll for datagram fd: %" PRIx32,
-                                       revents);
-
-        /* Try to get the right size, if we can. (Not all sockets support SIOCINQ, hence we just try, but don't rely on
-         * it.) */
-        (void) ioctl(fd, SIOCINQ, &v);
-
-        /* Fix it up, if it is too small. We use the same fixed value as auditd here. Awful! */
-        m = PAGE_ALIGN(MAX3((size_t) v + 1,
-                            (size_t) LINE_MAX,
-                            ALIGN(sizeof(struct nlmsghdr)) + ALIGN((size_t) MAX_AUDIT_MESSAGE_LENGTH)) + 1);
-
-        if (!GREEDY_REALLOC(s->buffer, s->buffer_size, m))
-                return log_oom();
-
-        iovec = IOVEC_MAKE(s->buffer, s->buffer_size - 1); /* Leave room for trailing NUL we add later */
-
-        n = recvmsg_safe(fd, &msghdr, MSG_DONTWAIT|MSG_CMSG_CLOEXEC);
-        if (IN_SET(n, -EINTR, -EAGAIN))
-                return 0;
-        if (n == -EXFULL) {
-                log_warning("Got message with truncated control data (too many fds sent?), ignoring.");
-                return 0;
-        }
-        if (n < 0)
-                return log_error_errno(n, "recvmsg() failed: %m");
+        assert(buffer);
+        assert(msghdr);
 
-        CMSG_FOREACH(cmsg, &msghdr)
+        CMSG_FOREACH(cmsg, msghdr)
                 if (cmsg->cmsg_level == SOL_SOCKET &&
                     cmsg->cmsg_type == SCM_CREDENTIALS &&
                     cmsg->cmsg_len == CMSG_LEN(sizeof(struct ucred))) {
@@ -1340,17 +1450,17 @@ int server_process_datagram(
                 }
 
         /* And a trailing NUL, just in case */
-        s->buffer[n] = 0;
+        buffer[n] = 0;
 
         if (fd == s->syslog_fd) {
                 if (n > 0 && n_fds == 0)
-                        server_process_syslog_message(s, s->buffer, n, ucred, tv, label, label_len);
+                        server_process_syslog_message(s, buffer, n, ucred, tv, label, label_len);
                 else if (n_fds > 0)
                         log_warning("Got file descriptors via syslog socket. Ignoring.");
 
         } else if (fd == s->native_fd) {
                 if (n > 0 && n_fds == 0)
-                        server_process_native_message(s, s->buffer, n, ucred, tv, label, label_len);
+                        server_process_native_message(s, buffer, n, ucred, tv, label, label_len);
                 else if (n == 0 && n_fds == 1)
                         server_process_native_file(s, fds[0], ucred, tv, label, label_len);
                 else if (n_fds > 0)
@@ -1360,17 +1470,213 @@ int server_process_datagram(
                 assert(fd == s->audit_fd);
 
                 if (n > 0 && n_fds == 0)
-                        server_process_audit_message(s, s->buffer, n, ucred, &sa, msghdr.msg_namelen);
+                        server_process_audit_message(s, buffer, n, ucred, msghdr->msg_name, msghdr->msg_namelen);
                 else if (n_fds > 0)
                         log_warning("Got file descriptors via audit socket. Ignoring.");
         }
 
         close_many(fds, n_fds);
+}
+
+/* Reads a single datagram into a buffer sized for it. Returns 1 if a datagram was processed, 0 if there
+ * was nothing to read or the datagram was ignored, and negative on error. */
+static int server_receive_datagram(Server *s, int fd) {
+        DatagramControl control;
+        union sockaddr_union sa = {};
+        struct iovec iovec;
+        ssize_t n;
+        size_t m;
+        int v = 0;
+
+        struct msghdr msghdr = {
+                .msg_iov = &iovec,
+                .msg_iovlen = 1,
+                .msg_control = &control,
+                .msg_controllen = sizeof(control),
+                .msg_name = &sa,
+                .msg_namelen = sizeof(sa),
+        };
+
+        assert(s);
+
+        /* Try to get the right size, if we can. (Not all sockets support SIOCINQ, hence we just try, but don't rely on
+         * it.) */
+        (void) ioctl(fd, SIOCINQ, &v);
+
+        m = datagram_buffer_size(v);
+        if (!GREEDY_REALLOC(s->buffer, s->buffer_size, m))
+                return log_oom();
+
+        iovec = IOVEC_MAKE(s->buffer, s->buffer_size - 1); /* Leave room for trailing NUL we add later */
+
+        n = recvmsg_safe(fd, &msghdr, MSG_DONTWAIT|MSG_CMSG_CLOEXEC);
+        if (IN_SET(n, -EINTR, -EAGAIN))
+                return 0;
+        if (n == -EXFULL) {
+                log_warning("Got message with truncated control data (too many fds sent?), ignoring.");
+                return 0;
+        }
+        if (n < 0)
+                return log_error_errno(n, "recvmsg() failed: %m");
+
+        server_process_datagram_one(s, fd, s->buffer, n, &msghdr);
+        return 1;
+}
+
+static int server_allocate_datagram_batch(Server *s) {
+        assert(s);
+
+        if (s->mmsg)
+                return 0;
+
+        s->mmsg_slot_size = datagram_buffer_size(0);
+
+        s->mmsg = new0(struct mmsghdr, DATAGRAM_BATCH_MAX);
+        s->mmsg_iovec = new(struct iovec, DATAGRAM_BATCH_MAX);
+        s->mmsg_sockaddr = new(union sockaddr_union, DATAGRAM_BATCH_MAX);
+        s->mmsg_control = new(DatagramControl, DATAGRAM_BATCH_MAX);
+        s->mmsg_buffer = malloc(s->mmsg_slot_size * DATAGRAM_BATCH_MAX);
+        if (!s->mmsg || !s->mmsg_iovec || !s->mmsg_sockaddr || !s->mmsg_control || !s->mmsg_buffer) {
+                s->mmsg = mfree(s->mmsg);
+                s->mmsg_iovec = mfree(s->mmsg_iovec);
+                s->mmsg_sockaddr = mfree(s->mmsg_sockaddr);
+                s->mmsg_control = mfree(s->mmsg_control);
+                s->mmsg_buffer = mfree(s->mmsg_buffer);
+                return -ENOMEM;
+        }
 
-        server_refresh_idle_timer(s);
         return 0;
 }
 
+static void server_grow_datagram_batch(Server *s, size_t n) {
+        size_t m;
+        char *b;
+
+        assert(s);
+
+        /* A datagram of n bytes didn't fit into a slot. Make the slots large enough for the next ones, but
+         * at least double them, in case the kernel didn't tell us the real size. */
+        m = MIN(MAX(datagram_buffer_size(n), s->mmsg_slot_size * 2), PAGE_ALIGN(DATAGRAM_SLOT_SIZE_MAX));
+        if (m <= s->mmsg_slot_size)
+                return;
+
+        b = malloc(m * DATAGRAM_BATCH_MAX);
+        if (!b)
+                return; /* Let's keep the old slots then */
+
+        free_and_replace(s->mmsg_buffer, b);
+        s->mmsg_slot_size = m;
+}
+
+/* Reads as many datagrams as we have slots for with a single recvmmsg() call. Only used for the syslog and
+ * audit sockets, whose datagrams are usually small. We only know the size of the first datagram in advance,
+ * later ones that don't fit into a slot are truncated, which would corrupt native protocol messages. If
+ * that happens we warn and grow the slots, so that it doesn't happen again for datagrams of that size. */
+static int server_receive_datagrams(Server *s, int fd) {
+        DatagramControl *control;
+        size_t slot, truncated = 0;
+        int n, v = 0;
+
+        assert(s);
+
+        if (server_allocate_datagram_batch(s) < 0)
+                return server_receive_datagram(s, fd);
+
+        /* If the next datagram doesn't fit into a slot, read it on its own first, so that at least the
+         * message the kernel told us about isn't truncated. */
+        (void) ioctl(fd, SIOCINQ, &v);
+        if (datagram_buffer_size(v) > s->mmsg_slot_size)
+                return server_receive_datagram(s, fd);
+
+        slot = s->mmsg_slot_size;
+        control = s->mmsg_control;
+
+        for (size_t i = 0; i < DATAGRAM_BATCH_MAX; i++) {
+                s->mmsg_iovec[i] = IOVEC_MAKE(s->mmsg_buffer + i * slot, slot - 1); /* Leave room for trailing NUL */
+                s->mmsg_sockaddr[i] = (union sockaddr_union) {};
+                s->mmsg[i] = (struct mmsghdr) {
+                        .msg_hdr = {
+                                .msg_iov = s->mmsg_iovec + i,
+                                .msg_iovlen = 1,
+                                .msg_control = control + i,
+                                .msg_controllen = sizeof(DatagramControl),
+                                .msg_name = s->mmsg_sockaddr + i,
+                                .msg_namelen = sizeof(union sockaddr_union),
+                        },
+                };
+        }
+
+        /* With MSG_TRUNC the kernel reports the real size of truncated datagrams */
+        n = recvmmsg(fd, s->mmsg, DATAGRAM_BATCH_MAX, MSG_DONTWAIT|MSG_CMSG_CLOEXEC|MSG_TRUNC, NULL);
+        if (n < 0) {
+                if (IN_SET(errno, EINTR, EAGAIN))
+                        return 0;
+
+                return log_error_errno(errno, "recvmmsg() failed: %m");
+        }
+
+        for (int i = 0; i < n; i++) {
+                struct msghdr *mh = &s->mmsg[i].msg_hdr;
+
+                if (FLAGS_SET(mh->msg_flags, MSG_CTRUNC)) {
+                        cmsg_close_all(mh);
+                        log_warning("Got message with truncated control data (too many fds sent?), ignoring.");
+                        continue;
+                }
+
+                if (FLAGS_SET(mh->msg_flags, MSG_TRUNC)) {
+                        log_warning("Got datagram of %u bytes, larger than the %zu bytes we have room for, truncating.",
+                                    s->mmsg[i].msg_len, slot - 1);
+                        truncated = MAX(truncated, (size_t) s->mmsg[i].msg_len);
+                }
+
+                server_process_datagram_one(s, fd, mh->msg_iov->iov_base, MIN((size_t) s->mmsg[i].msg_len, slot - 1), mh);
+        }
+
+        /* Only now, as the slots were in use until here */
+        if (truncated > 0)
+                server_grow_datagram_batch(s, truncated);
+
+        return n;
+}
+
+int server_process_datagram(
+                sd_event_source *es,
+                int fd,
+                uint32_t revents,
+                void *userdata) {
+
+        Server *s = userdata;
+        int r = 0;
+
+        assert(s);
+        assert(fd == s->native_fd || fd == s->syslog_fd || fd == s->audit_fd);
+
+        if (revents != EPOLLIN)
+                return log_error_errno(SYNTHETIC_ERRNO(EIO),
+                                       "Got invalid event from epoll for datagram fd: %" PRIx32,
+                                       revents);
+
+        /* Drain up to DATAGRAM_BATCH_MAX datagrams per wakeup, and write them to the journal in one go. For
+         * the native socket we don't know the size of the datagrams beyond the first one in advance, hence
+         * read them one by one, each into a buffer that's large enough. */
+        server_begin_batch(s);
+
+        if (fd == s->native_fd)
+                for (unsigned i = 0; i < DATAGRAM_BATCH_MAX; i++) {
+                        r = server_receive_datagram(s, fd);
+                        if (r <= 0)
+                                break;
+                }
+        else
+                r = server_receive_datagrams(s, fd);
+
+        server_end_batch(s);
+
+        server_refresh_idle_timer(s);
+        return r < 0 ? r : 0;
+}
+
 static void server_full_flush(Server *s) {
         assert(s);
 
@@ -2196,6 +2502,7 @@ int server_init(Server *s, const char *namespace) {
 
                 .ratelimit_interval = DEFAULT_RATE_LIMIT_INTERVAL,
                 .ratelimit_burst = DEFAULT_RATE_LIMIT_BURST,
+                .ratelimit_mode = JOURNAL_RATELIMIT_WINDOW,
 
                 .forward_to_wall = true,
 
@@ -2267,6 +2574,10 @@ int server_init(Server *s, const char *namespace) {
         if (r < 0)
                 return log_error_errno(r, "Failed to create event loop: %m");
 
+        /* We usually have lots of busy stream and datagram sources of the same priority, dispatch them in
+         * batches instead of polling again after each one. */
+        (void) sd_event_set_poll_batch(s->event, true);
+
         n = sd_listen_fds(true);
         if (n < 0)
                 return log_error_errno(n, "Failed to read listening file descriptors from environment: %m");
@@ -2494,11 +2805,23 @@ void server_done(Server *s) {
                 munmap(s->kernel_seqnum, sizeof(uint64_t));
 
         free(s->buffer);
+        free(s->mmsg);
+        free(s->mmsg_iovec);
+        free(s->mmsg_sockaddr);
+        free(s->mmsg_control);
+        free(s->mmsg_buffer);
+        free(s->batch.entries);
+        free(s->batch.iovec);
+        free(s->batch.buffer);
         free(s->tty_path);
         free(s->cgroup_root);
         free(s->hostname_field);
+        free(s->dev_kmsg_device_id);
+        strv_free(s->dev_kmsg_device_fields);
         free(s->runtime_storage.path);
         free(s->system_storage.path);
+        hashmap_free_free_free(s->runtime_storage.vacuum_cache);
+        hashmap_free_free_free(s->system_storage.vacuum_cache);
         free(s->runtime_directory);
 
         mmap_cache_unref(s->mmap);
@@ -2523,6 +2846,8 @@ static const char* const split_mode_table[_SPLIT_MAX] = {
 DEFINE_STRING_TABLE_LOOKUP(split_mode, SplitMode);
 DEFINE_CONFIG_PARSE_ENUM(config_parse_split_mode, split_mode, SplitMode, "Failed to parse split mode setting");
 
+DEFINE_CONFIG_PARSE_ENUM(config_parse_ratelimit_mode, journal_ratelimit_mode, JournalRateLimitMode, "Failed to parse rate limit mode setting");
+
 int config_parse_line_max(
                 const char* unit,
                 const char *filename,
@@ -16,6 +16,7 @@ typedef struct Server Server;
 #include "journald-stream.h"
 #include "list.h"
 #include "prioq.h"
+#include "socket-util.h"
 #include "time-util.h"
 #include "varlink.h"
 
@@ -57,8 +58,40 @@ typedef struct JournalStorage {
 
         JournalMetrics metrics;
         JournalStorageSpace space;
+
+        /* Archived files seen by earlier vacuum runs, see journal_directory_vacuum_full() */
+        Hashmap *vacuum_cache;
 } JournalStorage;
 
+/* Entries dispatched while a batch is open are collected here, and written to the journal file in one go
+ * once the batch is closed, see server_begin_batch() and server_end_batch(). */
+typedef struct ServerBatch {
+        unsigned n_open;
+        bool flushing;
+
+        uid_t uid;
+        int priority;
+
+        JournalAppendEntry *entries;
+        size_t n_entries, n_entries_allocated;
+
+        struct iovec *iovec;
+        size_t n_iovec, n_iovec_allocated;
+
+        char *buffer;
+        size_t buffer_size, buffer_allocated;
+} ServerBatch;
+
+/* How many datagrams to read per wakeup of a datagram socket */
+#define DATAGRAM_BATCH_MAX 16U
+
+/* The slots for reading multiple datagrams in one go grow up to this size if larger datagrams are seen */
+#define DATAGRAM_SLOT_SIZE_MAX (256U*1024U)
+
+/* Write out a batch early, once it reaches either of these limits */
+#define SERVER_BATCH_ENTRIES_MAX 128U
+#define SERVER_BATCH_SIZE_MAX (1024U*1024U)
+
 struct Server {
         char *namespace;
 
@@ -97,10 +130,19 @@ struct Server {
         char *buffer;
         size_t buffer_size;
 
+        /* Preallocated slots for reading multiple datagrams in one go, see server_process_datagram() */
+        struct mmsghdr *mmsg;
+        struct iovec *mmsg_iovec;
+        union sockaddr_union *mmsg_sockaddr;
+        void *mmsg_control;
+        char *mmsg_buffer;
+        size_t mmsg_slot_size;
+
         JournalRateLimit *ratelimit;
         usec_t sync_interval_usec;
         usec_t ratelimit_interval;
         unsigned ratelimit_burst;
+        JournalRateLimitMode ratelimit_mode;
 
         JournalStorage runtime_storage;
         JournalStorage system_storage;
@@ -140,6 +182,10 @@ struct Server {
         MMapCache *mmap;
 
         Set *deferred_closes;
+        /* How many deferred closes had to be completed synchronously since the queue was full, and the
+         * highest number of files that were pending at once */
+        unsigned n_deferred_closes_forced;
+        unsigned n_deferred_closes_peak;
 
         uint64_t *kernel_seqnum;
         bool dev_kmsg_readable:1;
@@ -152,6 +198,11 @@ struct Server {
         char boot_id_field[sizeof("_BOOT_ID=") + 32];
         char *hostname_field;
         char *namespace_field;
+
+        /* The _UDEV_ fields of the device the last kernel message was about */
+        char *dev_kmsg_device_id;
+        char **dev_kmsg_device_fields;
+        usec_t dev_kmsg_device_timestamp;
         char *runtime_directory;
 
         /* Cached cgroup root, so that we don't have to query that all the time */
@@ -173,6 +224,8 @@ struct Server {
         ClientContext *pid1_context; /* the context of PID 1 */
 
         VarlinkServer *varlink_server;
+
+        ServerBatch batch;
 };
 
 #define SERVER_MACHINE_ID(s) ((s)->machine_id_field + STRLEN("_MACHINE_ID="))
@@ -195,6 +248,9 @@ struct Server {
 void server_dispatch_message(Server *s, struct iovec *iovec, size_t n, size_t m, ClientContext *c, const struct timeval *tv, int priority, pid_t object_pid);
 void server_driver_message(Server *s, pid_t object_pid, const char *message_id, const char *format, ...) _sentinel_ _printf_(4,0);
 
+void server_begin_batch(Server *s);
+void server_end_batch(Server *s);
+
 /* gperf lookup function */
 const struct ConfigPerfItem* journald_gperf_lookup(const char *key, GPERF_LEN_TYPE length);
 
@@ -210,6 +266,8 @@ CONFIG_PARSER_PROTOTYPE(config_parse_split_mode);
 const char *split_mode_to_string(SplitMode s) _const_;
 SplitMode split_mode_from_string(const char *s) _pure_;
 
+CONFIG_PARSER_PROTOTYPE(config_parse_ratelimit_mode);
+
 int server_init(Server *s, const char *namespace);
 void server_done(Server *s);
 void server_sync(Server *s);
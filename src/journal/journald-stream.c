@@ -39,6 +39,19 @@
 
 #define STDOUT_STREAMS_MAX 4096
 
+/* Event source priorities for stdout streams: normally the same as the datagram sockets, but streams that
+ * keep filling their whole read buffer for a while are demoted, so that they can't starve the other log
+ * sources. */
+#define STDOUT_STREAM_PRIORITY_NORMAL (SD_EVENT_PRIORITY_NORMAL+5)
+#define STDOUT_STREAM_PRIORITY_BUSY (SD_EVENT_PRIORITY_NORMAL+10)
+
+/* After this many consecutive wakeups with a full read buffer a stream is considered busy */
+#define STDOUT_STREAM_BUSY_WAKEUPS 16U
+
+/* Room kept free in front of the read data, so that the MESSAGE= field can be formed in place in front of
+ * any line, see stdout_stream_log() */
+#define STDOUT_STREAM_HEADROOM STRLEN("MESSAGE=")
+
 typedef enum StdoutStreamState {
         STDOUT_STREAM_IDENTIFIER,
         STDOUT_STREAM_UNIT_ID,
@@ -72,6 +85,7 @@ struct StdoutStream {
         struct ucred ucred;
         char *label;
         char *identifier;
+        char *identifier_field;
         char *unit_id;
         int priority;
         bool level_prefix:1;
@@ -81,6 +95,9 @@ struct StdoutStream {
 
         bool fdstore:1;
         bool in_notify_queue:1;
+        bool demoted:1;
+
+        unsigned n_full_reads;
 
         char *buffer;
         size_t length;
@@ -125,6 +142,7 @@ void stdout_stream_free(StdoutStream *s) {
         safe_close(s->fd);
         free(s->label);
         free(s->identifier);
+        free(s->identifier_field);
         free(s->unit_id);
         free(s->state_file);
         free(s->buffer);
@@ -243,14 +261,15 @@ fail:
 
 static int stdout_stream_log(
                 StdoutStream *s,
-                const char *p,
+                char *p,
                 LineBreak line_break) {
 
         struct iovec *iovec;
         int priority;
         char syslog_priority[] = "PRIORITY=\0";
         char syslog_facility[STRLEN("SYSLOG_FACILITY=") + DECIMAL_STR_MAX(int) + 1];
-        _cleanup_free_ char *message = NULL, *syslog_identifier = NULL;
+        char saved[STDOUT_STREAM_HEADROOM];
+        char *message;
         size_t n = 0, m;
         int r;
 
@@ -271,7 +290,7 @@ static int stdout_stream_log(
         priority = s->priority;
 
         if (s->level_prefix)
-                syslog_parse_priority(&p, &priority, false);
+                syslog_parse_priority((const char**) &p, &priority, false);
 
         if (!client_context_test_priority(s->context, priority))
                 return 0;
@@ -305,11 +324,11 @@ static int stdout_stream_log(
                 iovec[n++] = IOVEC_MAKE_STRING(syslog_facility);
         }
 
-        if (s->identifier) {
-                syslog_identifier = strjoin("SYSLOG_IDENTIFIER=", s->identifier);
-                if (syslog_identifier)
-                        iovec[n++] = IOVEC_MAKE_STRING(syslog_identifier);
-        }
+        /* The identifier doesn't change once the stream is set up, hence format the field only once */
+        if (s->identifier && !s->identifier_field)
+                s->identifier_field = strjoin("SYSLOG_IDENTIFIER=", s->identifier);
+        if (s->identifier_field)
+                iovec[n++] = IOVEC_MAKE_STRING(s->identifier_field);
 
         static const char * const line_break_field_table[_LINE_BREAK_MAX] = {
                 [LINE_BREAK_NEWLINE]    = NULL, /* Do not add field if traditional newline */
@@ -326,11 +345,18 @@ static int stdout_stream_log(
         if (c)
                 iovec[n++] = IOVEC_MAKE_STRING(c);
 
-        message = strjoin("MESSAGE=", p);
-        if (message)
-                iovec[n++] = IOVEC_MAKE_STRING(message);
+        /* The line is always located in our read buffer, with at least STDOUT_STREAM_HEADROOM bytes in
+         * front of it that either belong to lines processed already or are kept free for this purpose.
+         * Hence, rather than copying the line, temporarily put the field name in front of it. The server
+         * copies whatever it needs to keep, so we can restore the buffer right after. */
+        message = p - STDOUT_STREAM_HEADROOM;
+        memcpy(saved, message, STDOUT_STREAM_HEADROOM);
+        memcpy(message, "MESSAGE=", STDOUT_STREAM_HEADROOM);
+        iovec[n++] = IOVEC_MAKE_STRING(message);
 
         server_dispatch_message(s->server, iovec, n, m, s->context, NULL, priority, 0);
+
+        memcpy(message, saved, STDOUT_STREAM_HEADROOM);
         return 0;
 }
 
@@ -471,6 +497,9 @@ static int stdout_stream_scan(
         assert(s);
         assert(p);
 
+        /* Write out all lines we find in one go */
+        server_begin_batch(s->server);
+
         for (;;) {
                 LineBreak line_break;
                 size_t skip, found;
@@ -498,7 +527,7 @@ static int stdout_stream_scan(
 
                 r = stdout_stream_found(s, p, found, line_break);
                 if (r < 0)
-                        return r;
+                        goto finish;
 
                 p += skip;
                 consumed += skip;
@@ -508,7 +537,7 @@ static int stdout_stream_scan(
         if (force_flush >= 0 && remaining > 0) {
                 r = stdout_stream_found(s, p, remaining, force_flush);
                 if (r < 0)
-                        return r;
+                        goto finish;
 
                 consumed += remaining;
         }
@@ -516,7 +545,40 @@ static int stdout_stream_scan(
         if (ret_consumed)
                 *ret_consumed = consumed;
 
-        return 0;
+        r = 0;
+
+finish:
+        server_end_batch(s->server);
+        return r;
+}
+
+static void stdout_stream_update_priority(StdoutStream *s, bool full) {
+        bool busy;
+        int r;
+
+        assert(s);
+
+        /* Keep track of streams that send us more than we can read in one go, all the time. Readers of other
+         * streams and sockets get preference over those, so that one chatty service doesn't delay logging
+         * of everybody else. The demoted stream is still served whenever nothing else is pending, and
+         * returns to normal priority as soon as it quiets down. */
+
+        if (full)
+                s->n_full_reads = MIN(s->n_full_reads + 1, STDOUT_STREAM_BUSY_WAKEUPS);
+        else
+                s->n_full_reads = 0;
+
+        busy = s->n_full_reads >= STDOUT_STREAM_BUSY_WAKEUPS;
+        if (busy == s->demoted)
+                return;
+
+        r = sd_event_source_set_priority(s->event_source, busy ? STDOUT_STREAM_PRIORITY_BUSY : STDOUT_STREAM_PRIORITY_NORMAL);
+        if (r < 0) {
+                log_debug_errno(r, "Failed to change stdout stream event source priority, ignoring: %m");
+                return;
+        }
+
+        s->demoted = busy;
 }
 
 static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents, void *userdata) {
@@ -526,7 +588,7 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
         struct ucred *ucred;
         struct iovec iovec;
         ssize_t l;
-        char *p;
+        char *data, *p;
         int r;
 
         struct msghdr msghdr = {
@@ -544,8 +606,8 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
         }
 
         /* If the buffer is almost full, add room for another 1K */
-        if (s->length + 512 >= s->allocated) {
-                if (!GREEDY_REALLOC(s->buffer, s->allocated, s->length + 1 + 1024)) {
+        if (STDOUT_STREAM_HEADROOM + s->length + 512 >= s->allocated) {
+                if (!GREEDY_REALLOC(s->buffer, s->allocated, STDOUT_STREAM_HEADROOM + s->length + 1 + 1024)) {
                         log_oom();
                         goto terminate;
                 }
@@ -553,9 +615,10 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
 
         /* Try to make use of the allocated buffer in full, but never read more than the configured line size. Also,
          * always leave room for a terminating NUL we might need to add. */
-        limit = MIN(s->allocated - 1, s->server->line_max);
+        limit = MIN(s->allocated - STDOUT_STREAM_HEADROOM - 1, s->server->line_max);
         assert(s->length <= limit);
-        iovec = IOVEC_MAKE(s->buffer + s->length, limit - s->length);
+        data = s->buffer + STDOUT_STREAM_HEADROOM;
+        iovec = IOVEC_MAKE(data + s->length, limit - s->length);
 
         l = recvmsg(s->fd, &msghdr, MSG_DONTWAIT|MSG_CMSG_CLOEXEC);
         if (l < 0) {
@@ -568,10 +631,12 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
         cmsg_close_all(&msghdr);
 
         if (l == 0) {
-                (void) stdout_stream_scan(s, s->buffer, s->length, /* force_flush = */ LINE_BREAK_EOF, NULL);
+                (void) stdout_stream_scan(s, data, s->length, /* force_flush = */ LINE_BREAK_EOF, NULL);
                 goto terminate;
         }
 
+        stdout_stream_update_priority(s, (size_t) l >= iovec.iov_len);
+
         /* Invalidate the context if the PID of the sender changed. This happens when a forked process
          * inherits stdout/stderr from a parent. In this case getpeercred() returns the ucred of the parent,
          * which can be invalid if the parent has exited in the meantime. */
@@ -579,15 +644,15 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
         if (ucred && ucred->pid != s->ucred.pid) {
                 /* Force out any previously half-written lines from a different process, before we switch to
                  * the new ucred structure for everything we just added */
-                r = stdout_stream_scan(s, s->buffer, s->length, /* force_flush = */ LINE_BREAK_PID_CHANGE, NULL);
+                r = stdout_stream_scan(s, data, s->length, /* force_flush = */ LINE_BREAK_PID_CHANGE, NULL);
                 if (r < 0)
                         goto terminate;
 
                 s->context = client_context_release(s->server, s->context);
 
-                p = s->buffer + s->length;
+                p = data + s->length;
         } else {
-                p = s->buffer;
+                p = data;
                 l += s->length;
         }
 
@@ -602,7 +667,7 @@ static int stdout_stream_process(sd_event_source *es, int fd, uint32_t revents,
         /* Move what wasn't consumed to the front of the buffer */
         assert(consumed <= (size_t) l);
         s->length = l - consumed;
-        memmove(s->buffer, p + consumed, s->length);
+        memmove(data, p + consumed, s->length);
 
         return 1;
 
@@ -654,7 +719,7 @@ int stdout_stream_install(Server *s, int fd, StdoutStream **ret) {
         if (r < 0)
                 return log_error_errno(r, "Failed to add stream to event loop: %m");
 
-        r = sd_event_source_set_priority(stream->event_source, SD_EVENT_PRIORITY_NORMAL+5);
+        r = sd_event_source_set_priority(stream->event_source, STDOUT_STREAM_PRIORITY_NORMAL);
         if (r < 0)
                 return log_error_errno(r, "Failed to adjust stdout event source priority: %m");
 
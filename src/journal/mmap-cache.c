@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: LGPL-2.1+ */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 
@@ -56,11 +57,16 @@ struct MMapFileDescriptor {
 struct MMapCache {
         unsigned n_ref;
         unsigned n_windows;
+        unsigned n_windows_min;
+
+        uint64_t n_bytes;
+        uint64_t n_bytes_max;
 
         unsigned n_hit, n_missed;
 
         Hashmap *fds;
         Context *contexts[MMAP_CACHE_MAX_CONTEXTS];
+        MMapCacheAccess access[MMAP_CACHE_MAX_CONTEXTS];
 
         LIST_HEAD(Window, unused);
         Window *last_unused;
@@ -71,10 +77,17 @@ struct MMapCache {
 #if ENABLE_DEBUG_MMAP_CACHE
 /* Tiny windows increase mmap activity and the chance of exposing unsafe use. */
 # define WINDOW_SIZE (page_size())
+# define WINDOW_SIZE_SEQUENTIAL (page_size())
 #else
 # define WINDOW_SIZE (8ULL*1024ULL*1024ULL)
+# define WINDOW_SIZE_SEQUENTIAL (32ULL*1024ULL*1024ULL)
 #endif
 
+/* Budget for the total size of all mapped windows. Unused windows beyond it are unmapped right-away, least
+ * recently used first, so that large sequential windows or many open files can't make the mapped set
+ * grow unbounded. */
+#define WINDOWS_BYTES_MAX (WINDOWS_MIN * WINDOW_SIZE)
+
 MMapCache* mmap_cache_new(void) {
         MMapCache *m;
 
@@ -83,6 +96,8 @@ MMapCache* mmap_cache_new(void) {
                 return NULL;
 
         m->n_ref = 1;
+        m->n_windows_min = WINDOWS_MIN;
+        m->n_bytes_max = WINDOWS_BYTES_MAX;
         return m;
 }
 
@@ -91,9 +106,13 @@ static void window_unlink(Window *w) {
 
         assert(w);
 
-        if (w->ptr)
+        if (w->ptr) {
                 munmap(w->ptr, w->size);
 
+                assert(w->cache->n_bytes >= w->size);
+                w->cache->n_bytes -= w->size;
+        }
+
         if (w->fd)
                 LIST_REMOVE(by_fd, w->fd->windows, w);
 
@@ -159,7 +178,7 @@ static Window *window_add(MMapCache *m, MMapFileDescriptor *f, int prot, bool ke
         assert(m);
         assert(f);
 
-        if (!m->last_unused || m->n_windows <= WINDOWS_MIN) {
+        if (!m->last_unused || m->n_windows <= m->n_windows_min) {
 
                 /* Allocate a new window */
                 w = new(Window, 1);
@@ -184,6 +203,11 @@ static Window *window_add(MMapCache *m, MMapFileDescriptor *f, int prot, bool ke
         };
 
         LIST_PREPEND(by_fd, f->windows, w);
+        m->n_bytes += size;
+
+        /* Stay within the byte budget by dropping the least recently used windows nobody refers to */
+        while (m->n_bytes > m->n_bytes_max && m->last_unused)
+                window_free(m->last_unused);
 
         return w;
 }
@@ -418,6 +442,36 @@ static int mmap_try_harder(MMapCache *m, void *addr, MMapFileDescriptor *f, int
         return 0;
 }
 
+static void window_advise(MMapFileDescriptor *f, MMapCacheAccess access, void *ptr, uint64_t woffset, uint64_t wsize, const struct stat *st) {
+        uint64_t next;
+
+        assert(f);
+        assert(ptr);
+
+        /* The hints are purely advisory, hence ignore any failures */
+
+        switch (access) {
+
+        case MMAP_CACHE_ACCESS_SEQUENTIAL:
+                (void) madvise(ptr, wsize, MADV_SEQUENTIAL);
+                (void) madvise(ptr, wsize, MADV_WILLNEED);
+
+                /* Let the kernel read the following window in the background, so that it is already in
+                 * the page cache by the time the reader advances to it. */
+                next = woffset + wsize;
+                if (!st || next < (uint64_t) st->st_size)
+                        (void) posix_fadvise(f->fd, next, WINDOW_SIZE_SEQUENTIAL, POSIX_FADV_WILLNEED);
+                break;
+
+        case MMAP_CACHE_ACCESS_RANDOM:
+                (void) madvise(ptr, wsize, MADV_RANDOM);
+                break;
+
+        default:
+                break;
+        }
+}
+
 static int add_mmap(
                 MMapCache *m,
                 MMapFileDescriptor *f,
@@ -430,7 +484,8 @@ static int add_mmap(
                 void **ret,
                 size_t *ret_size) {
 
-        uint64_t woffset, wsize;
+        uint64_t woffset, wsize, window_size;
+        MMapCacheAccess access;
         Context *c;
         Window *w;
         void *d;
@@ -442,21 +497,29 @@ static int add_mmap(
         assert(size > 0);
         assert(ret);
 
+        access = m->access[context];
+        window_size = access == MMAP_CACHE_ACCESS_SEQUENTIAL ? WINDOW_SIZE_SEQUENTIAL : WINDOW_SIZE;
+
         woffset = offset & ~((uint64_t) page_size() - 1ULL);
         wsize = size + (offset - woffset);
         wsize = PAGE_ALIGN(wsize);
 
-        if (wsize < WINDOW_SIZE) {
+        if (wsize < window_size) {
                 uint64_t delta;
 
-                delta = PAGE_ALIGN((WINDOW_SIZE - wsize) / 2);
+                /* When reading sequentially there's no point in mapping what is before the requested
+                 * offset, hence only extend the window forward in that case. */
+                if (access == MMAP_CACHE_ACCESS_SEQUENTIAL)
+                        delta = 0;
+                else
+                        delta = PAGE_ALIGN((window_size - wsize) / 2);
 
                 if (delta > offset)
                         woffset = 0;
                 else
                         woffset -= delta;
 
-                wsize = WINDOW_SIZE;
+                wsize = window_size;
         }
 
         if (st) {
@@ -475,6 +538,8 @@ static int add_mmap(
         if (r < 0)
                 return r;
 
+        window_advise(f, access, d, woffset, wsize, st);
+
         c = context_add(m, context);
         if (!c)
                 goto outofmem;
@@ -537,6 +602,43 @@ int mmap_cache_get(
         return add_mmap(m, f, prot, context, keep_always, offset, size, st, ret, ret_size);
 }
 
+void mmap_cache_set_access(MMapCache *m, unsigned context, MMapCacheAccess access) {
+        assert(m);
+        assert(context < MMAP_CACHE_MAX_CONTEXTS);
+        assert(access >= 0 && access < _MMAP_CACHE_ACCESS_MAX);
+
+        /* Only affects windows mapped from now on, on behalf of the specified context */
+        m->access[context] = access;
+}
+
+void mmap_cache_set_windows_min(MMapCache *m, unsigned n) {
+        assert(m);
+
+        /* The number of windows we allocate before we start recycling unused ones. Raise the byte budget
+         * to match, as otherwise it would unmap the unused windows before there are that many. */
+        m->n_windows_min = MAX(n, 1U);
+        m->n_bytes_max = MAX(m->n_bytes_max, (uint64_t) m->n_windows_min * WINDOW_SIZE);
+}
+
+void mmap_cache_set_bytes_max(MMapCache *m, uint64_t n) {
+        assert(m);
+
+        /* The total size of mapped windows above which we unmap unused ones right-away */
+        m->n_bytes_max = n;
+}
+
+unsigned mmap_cache_get_n_windows(MMapCache *m) {
+        assert(m);
+
+        return m->n_windows;
+}
+
+uint64_t mmap_cache_get_n_bytes(MMapCache *m) {
+        assert(m);
+
+        return m->n_bytes;
+}
+
 unsigned mmap_cache_get_hit(MMapCache *m) {
         assert(m);
 
@@ -10,6 +10,14 @@
 typedef struct MMapCache MMapCache;
 typedef struct MMapFileDescriptor MMapFileDescriptor;
 
+typedef enum MMapCacheAccess {
+        MMAP_CACHE_ACCESS_NORMAL,
+        MMAP_CACHE_ACCESS_SEQUENTIAL,  /* larger windows, read-ahead of the following window */
+        MMAP_CACHE_ACCESS_RANDOM,      /* no read-ahead by the kernel */
+        _MMAP_CACHE_ACCESS_MAX,
+        _MMAP_CACHE_ACCESS_INVALID = -1,
+} MMapCacheAccess;
+
 MMapCache* mmap_cache_new(void);
 MMapCache* mmap_cache_ref(MMapCache *m);
 MMapCache* mmap_cache_unref(MMapCache *m);
@@ -28,6 +36,13 @@ int mmap_cache_get(
 MMapFileDescriptor * mmap_cache_add_fd(MMapCache *m, int fd);
 void mmap_cache_free_fd(MMapCache *m, MMapFileDescriptor *f);
 
+void mmap_cache_set_access(MMapCache *m, unsigned context, MMapCacheAccess access);
+void mmap_cache_set_windows_min(MMapCache *m, unsigned n);
+void mmap_cache_set_bytes_max(MMapCache *m, uint64_t n);
+
+unsigned mmap_cache_get_n_windows(MMapCache *m);
+uint64_t mmap_cache_get_n_bytes(MMapCache *m);
+
 unsigned mmap_cache_get_hit(MMapCache *m);
 unsigned mmap_cache_get_missed(MMapCache *m);
 
@@ -7,6 +7,7 @@
 #include <poll.h>
 #include <stddef.h>
 #include <sys/inotify.h>
+#include <sys/mman.h>
 #include <sys/vfs.h>
 #include <unistd.h>
 
@@ -104,11 +105,16 @@ static int journal_put_error(sd_journal *j, int r, const char *path) {
         return 0;
 }
 
+static void invalidate_files_by_location(sd_journal *j);
+static void drop_file_by_location(sd_journal *j, JournalFile *f);
+
 static void detach_location(sd_journal *j) {
         JournalFile *f;
 
         assert(j);
 
+        invalidate_files_by_location(j);
+
         j->current_file = NULL;
         j->current_field = 0;
 
@@ -146,8 +152,11 @@ static void set_location(sd_journal *j, JournalFile *f, Object *o) {
         j->current_file = f;
         j->current_field = 0;
 
-        /* Let f know its candidate entry was picked. */
+        /* Let f know its candidate entry was picked. This makes f incomparable to the other files, hence
+         * take it out of the priority queue, so that removing or invalidating files before the next
+         * iteration step doesn't compare against it. The next step puts it back anyway. */
         assert(f->location_type == LOCATION_SEEK);
+        drop_file_by_location(j, f);
         f->location_type = LOCATION_DISCRETE;
 }
 
@@ -226,10 +235,76 @@ static void match_free(Match *m) {
         if (m->parent)
                 LIST_REMOVE(matches, m->parent->matches, m);
 
+        hashmap_free_free(m->data_offsets);
         free(m->data);
         free(m);
 }
 
+static void match_forget_file(Match *m, JournalFile *f) {
+        Match *i;
+
+        assert(m);
+        assert(f);
+
+        free(hashmap_remove(m->data_offsets, f));
+
+        LIST_FOREACH(matches, i, m->matches)
+                match_forget_file(i, f);
+}
+
+static int match_find_data_object(Match *m, JournalFile *f, uint64_t *ret_offset) {
+        _cleanup_free_ uint64_t *cached = NULL;
+        uint64_t dp, hash, *c;
+        int r;
+
+        assert(m);
+        assert(m->type == MATCH_DISCRETE);
+        assert(f);
+        assert(ret_offset);
+
+        /* Looks up the data object for a discrete match in the specified file. The result is remembered, so
+         * that iterating through a file doesn't need to walk the data hash chain for each entry again. Data
+         * objects never go away, hence positive results stay valid. Negative results are only remembered
+         * for archived files, since more data might still be appended to all others. */
+
+        c = hashmap_get(m->data_offsets, f);
+        if (c) {
+                if (*c == 0)
+                        return 0;
+
+                *ret_offset = *c;
+                return 1;
+        }
+
+        /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise
+         * we can use what we pre-calculated. */
+        if (JOURNAL_HEADER_KEYED_HASH(f->header))
+                hash = journal_file_hash_data(f, m->data, m->size);
+        else
+                hash = m->hash;
+
+        r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, NULL, &dp);
+        if (r < 0)
+                return r;
+        if (r == 0 && f->header->state != STATE_ARCHIVED)
+                return 0;
+
+        cached = new(uint64_t, 1);
+        if (cached) {
+                *cached = r > 0 ? dp : 0;
+
+                if (hashmap_ensure_allocated(&m->data_offsets, NULL) >= 0 &&
+                    hashmap_put(m->data_offsets, f, cached) >= 0)
+                        TAKE_PTR(cached);
+        }
+
+        if (r == 0)
+                return 0;
+
+        *ret_offset = dp;
+        return 1;
+}
+
 static void match_free_if_empty(Match *m) {
         if (!m || m->matches)
                 return;
@@ -502,16 +577,9 @@ static int next_for_match(
         assert(f);
 
         if (m->type == MATCH_DISCRETE) {
-                uint64_t dp, hash;
+                uint64_t dp;
 
-                /* If the keyed hash logic is used, we need to calculate the hash fresh per file. Otherwise
-                 * we can use what we pre-calculated. */
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
-
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, NULL, &dp);
+                r = match_find_data_object(m, f, &dp);
                 if (r <= 0)
                         return r;
 
@@ -598,14 +666,9 @@ static int find_location_for_match(
         assert(f);
 
         if (m->type == MATCH_DISCRETE) {
-                uint64_t dp, hash;
-
-                if (JOURNAL_HEADER_KEYED_HASH(f->header))
-                        hash = journal_file_hash_data(f, m->data, m->size);
-                else
-                        hash = m->hash;
+                uint64_t dp;
 
-                r = journal_file_find_data_object_with_hash(f, m->data, m->size, hash, NULL, &dp);
+                r = match_find_data_object(m, f, &dp);
                 if (r <= 0)
                         return r;
 
@@ -687,6 +750,38 @@ static int find_location_for_match(
         }
 }
 
+static bool file_may_have_entries_beyond_location(sd_journal *j, JournalFile *f, direction_t direction) {
+        assert(j);
+        assert(f);
+        assert(f->header);
+
+        /* Checks the header of the file to see if there's any chance of finding an entry beyond the current
+         * location. This mirrors the order of checks in find_location_with_matches(), and allows us to skip
+         * files (typically: archived ones, when --since= is used) without bisecting their entry arrays. */
+
+        if (le64toh(READ_NOW(f->header->n_entries)) == 0)
+                return false;
+
+        if (IN_SET(j->current_location.type, LOCATION_HEAD, LOCATION_TAIL))
+                return true;
+
+        if (j->current_location.seqnum_set && sd_id128_equal(j->current_location.seqnum_id, f->header->seqnum_id))
+                return direction == DIRECTION_DOWN ?
+                        le64toh(READ_NOW(f->header->tail_entry_seqnum)) >= j->current_location.seqnum :
+                        le64toh(READ_NOW(f->header->head_entry_seqnum)) <= j->current_location.seqnum;
+
+        /* Monotonic timestamps are only comparable within one boot, which the header doesn't tell us */
+        if (j->current_location.monotonic_set)
+                return true;
+
+        if (j->current_location.realtime_set)
+                return direction == DIRECTION_DOWN ?
+                        le64toh(READ_NOW(f->header->tail_entry_realtime)) >= j->current_location.realtime :
+                        le64toh(READ_NOW(f->header->head_entry_realtime)) <= j->current_location.realtime;
+
+        return true;
+}
+
 static int find_location_with_matches(
                 sd_journal *j,
                 JournalFile *f,
@@ -701,6 +796,9 @@ static int find_location_with_matches(
         assert(ret);
         assert(offset);
 
+        if (!file_may_have_entries_beyond_location(j, f, direction))
+                return 0;
+
         if (!j->level0) {
                 /* No matches is simple */
 
@@ -816,56 +914,180 @@ static int next_beyond_location(sd_journal *j, JournalFile *f, direction_t direc
         }
 }
 
-static int real_journal_next(sd_journal *j, direction_t direction) {
-        JournalFile *new_file = NULL;
+static int compare_files_down(const void *a, const void *b) {
+        return journal_file_compare_locations((JournalFile*) a, (JournalFile*) b);
+}
+
+static int compare_files_up(const void *a, const void *b) {
+        return journal_file_compare_locations((JournalFile*) b, (JournalFile*) a);
+}
+
+static void invalidate_files_by_location(sd_journal *j) {
+        JournalFile *f;
+
+        assert(j);
+
+        while ((f = prioq_pop(j->files_by_location)))
+                f->location_prioq_idx = PRIOQ_IDX_NULL;
+
+        j->n_files_unarchived = 0;
+        j->files_by_location_valid = false;
+}
+
+static void drop_file_by_location(sd_journal *j, JournalFile *f) {
+        assert(j);
+        assert(f);
+
+        /* prioq_remove() doesn't reset the index of the removed item, do so here, so that the file is put
+         * back when it gets a new candidate. */
+        if (f->location_prioq_idx != PRIOQ_IDX_NULL) {
+                (void) prioq_remove(j->files_by_location, f, &f->location_prioq_idx);
+                f->location_prioq_idx = PRIOQ_IDX_NULL;
+        }
+}
+
+static int update_file_by_location(sd_journal *j, JournalFile *f, direction_t direction) {
+        int r;
+
+        assert(j);
+        assert(f);
+
+        /* Moves the file to its next candidate entry beyond the current location, and updates its position
+         * in the priority queue accordingly. Returns > 0 if the file has a candidate. */
+
+        r = next_beyond_location(j, f, direction);
+        if (r < 0) {
+                log_debug_errno(r, "Can't iterate through %s, ignoring: %m", f->path);
+                drop_file_by_location(j, f);
+                remove_file_real(j, f);
+                return 0;
+        }
+        if (r == 0) {
+                f->location_type = LOCATION_TAIL;
+                drop_file_by_location(j, f);
+                return 0;
+        }
+
+        if (f->location_prioq_idx == PRIOQ_IDX_NULL)
+                r = prioq_put(j->files_by_location, f, &f->location_prioq_idx);
+        else
+                r = prioq_reshuffle(j->files_by_location, f, &f->location_prioq_idx);
+        if (r < 0)
+                return r;
+
+        return 1;
+}
+
+static int rebuild_files_by_location(sd_journal *j, direction_t direction) {
         unsigned i, n_files;
         const void **files;
-        Object *o;
         int r;
 
-        assert_return(j, -EINVAL);
-        assert_return(!journal_pid_changed(j), -ECHILD);
+        assert(j);
+
+        invalidate_files_by_location(j);
+
+        if (direction != j->files_by_location_direction)
+                j->files_by_location = prioq_free(j->files_by_location);
+
+        r = prioq_ensure_allocated(&j->files_by_location,
+                                   direction == DIRECTION_DOWN ? compare_files_down : compare_files_up);
+        if (r < 0)
+                return r;
+
+        j->files_by_location_direction = direction;
 
         r = iterated_cache_get(j->files_cache, NULL, &files, &n_files);
         if (r < 0)
                 return r;
 
+        if (!GREEDY_REALLOC(j->files_unarchived, j->n_files_unarchived_allocated, n_files))
+                return -ENOMEM;
+
+        /* Removing a broken file below resets this again */
+        j->files_by_location_valid = true;
+
         for (i = 0; i < n_files; i++) {
                 JournalFile *f = (JournalFile *)files[i];
-                bool found;
 
-                r = next_beyond_location(j, f, direction);
+                /* Archived files never change again, all others might gain entries while we iterate */
+                if (f->header->state != STATE_ARCHIVED)
+                        j->files_unarchived[j->n_files_unarchived++] = f;
+
+                r = update_file_by_location(j, f, direction);
                 if (r < 0) {
-                        log_debug_errno(r, "Can't iterate through %s, ignoring: %m", f->path);
-                        remove_file_real(j, f);
-                        continue;
-                } else if (r == 0) {
-                        f->location_type = LOCATION_TAIL;
-                        continue;
+                        invalidate_files_by_location(j);
+                        return r;
                 }
+        }
 
-                if (!new_file)
-                        found = true;
-                else {
-                        int k;
+        return 0;
+}
 
-                        k = journal_file_compare_locations(f, new_file);
+static int real_journal_next(sd_journal *j, direction_t direction) {
+        JournalFile *f;
+        Object *o;
+        int r;
 
-                        found = direction == DIRECTION_DOWN ? k < 0 : k > 0;
-                }
+        assert_return(j, -EINVAL);
+        assert_return(!journal_pid_changed(j), -ECHILD);
 
-                if (found)
-                        new_file = f;
+        /* We keep the files ordered by their next candidate entry in a priority queue, so that each step
+         * only needs to advance the file whose entry we returned last, instead of looking at all of them.
+         * Whenever anything changes that might affect more than that file (seeking, changed matches,
+         * added or removed files, a different direction), we start from scratch. */
+
+        if (!j->files_by_location_valid ||
+            j->files_by_location_direction != direction ||
+            !j->current_file ||
+            j->current_location.type != LOCATION_DISCRETE) {
+
+                r = rebuild_files_by_location(j, direction);
+                if (r < 0)
+                        return r;
+        } else {
+                r = update_file_by_location(j, j->current_file, direction);
+                if (r < 0)
+                        return r;
+
+                /* Files that hit the end before might have gained entries in the meantime */
+                for (size_t i = 0; j->files_by_location_valid && i < j->n_files_unarchived; i++) {
+                        f = j->files_unarchived[i];
+
+                        if (f->location_prioq_idx != PRIOQ_IDX_NULL || f == j->current_file)
+                                continue;
+
+                        r = update_file_by_location(j, f, direction);
+                        if (r < 0)
+                                return r;
+                }
         }
 
-        if (!new_file)
-                return 0;
+        /* The candidates of all files but the one we advanced might be stale, i.e. not beyond the current
+         * location anymore, if the same entry exists in multiple files. Stale candidates are never later
+         * than the real next entry of their file, hence it's sufficient to validate the top of the queue
+         * until it is stable. */
+        for (;;) {
+                uint64_t offset;
+
+                f = prioq_peek(j->files_by_location);
+                if (!f)
+                        return 0;
+
+                offset = f->current_offset;
+
+                r = update_file_by_location(j, f, direction);
+                if (r < 0)
+                        return r;
+                if (r > 0 && f->current_offset == offset)
+                        break;
+        }
 
-        r = journal_file_move_to_object(new_file, OBJECT_ENTRY, new_file->current_offset, &o);
+        r = journal_file_move_to_object(f, OBJECT_ENTRY, f->current_offset, &o);
         if (r < 0)
                 return r;
 
-        set_location(j, new_file, o);
+        set_location(j, f, o);
 
         return 1;
 }
@@ -1361,6 +1583,7 @@ static int add_any_file(
         track_file_disposition(j, f);
         check_network(j, f->fd);
 
+        invalidate_files_by_location(j);
         j->current_invalidate_counter++;
 
         log_debug("File %s added.", f->path);
@@ -1429,6 +1652,11 @@ static void remove_file_real(sd_journal *j, JournalFile *f) {
 
         log_debug("File %s removed.", f->path);
 
+        /* This might be called while we iterate through the files, hence only drop this one file here, and
+         * have the next iteration step start from scratch. */
+        drop_file_by_location(j, f);
+        j->files_by_location_valid = false;
+
         if (j->current_file == f) {
                 j->current_file = NULL;
                 j->current_field = 0;
@@ -1449,6 +1677,9 @@ static void remove_file_real(sd_journal *j, JournalFile *f) {
                         j->fields_file_lost = true;
         }
 
+        if (j->level0)
+                match_forget_file(j->level0, f);
+
         (void) journal_file_close(f);
 
         j->current_invalidate_counter++;
@@ -2146,6 +2377,17 @@ fail:
         return r;
 }
 
+static void journal_unmap_catalog(sd_journal *j) {
+        assert(j);
+
+        if (!j->catalog_map)
+                return;
+
+        (void) munmap(j->catalog_map, j->catalog_stat.st_size);
+        j->catalog_map = NULL;
+        j->catalog_stat = (struct stat) {};
+}
+
 _public_ void sd_journal_close(sd_journal *j) {
         Directory *d;
 
@@ -2154,6 +2396,9 @@ _public_ void sd_journal_close(sd_journal *j) {
 
         sd_journal_flush_matches(j);
 
+        prioq_free(j->files_by_location);
+        free(j->files_unarchived);
+
         ordered_hashmap_free_with_destructor(j->files, journal_file_close);
         iterated_cache_free(j->files_cache);
 
@@ -2169,7 +2414,9 @@ _public_ void sd_journal_close(sd_journal *j) {
         safe_close(j->inotify_fd);
 
         if (j->mmap) {
-                log_debug("mmap cache statistics: %u hit, %u miss", mmap_cache_get_hit(j->mmap), mmap_cache_get_missed(j->mmap));
+                log_debug("mmap cache statistics: %u hit, %u miss, %u windows, %" PRIu64 " bytes mapped",
+                          mmap_cache_get_hit(j->mmap), mmap_cache_get_missed(j->mmap),
+                          mmap_cache_get_n_windows(j->mmap), mmap_cache_get_n_bytes(j->mmap));
                 mmap_cache_unref(j->mmap);
         }
 
@@ -2180,6 +2427,7 @@ _public_ void sd_journal_close(sd_journal *j) {
         free(j->namespace);
         free(j->unique_field);
         free(j->fields_buffer);
+        journal_unmap_catalog(j);
         free(j);
 }
 
@@ -2321,10 +2569,11 @@ _public_ int sd_journal_get_data(sd_journal *j, const char *field, const void **
                 compression = o->object.flags & OBJECT_COMPRESSION_MASK;
                 if (compression) {
 #if HAVE_COMPRESSION
-                        r = decompress_startswith(compression,
-                                                  o->data.payload, l,
-                                                  &f->compress_buffer, &f->compress_buffer_size,
-                                                  field, field_length, '=');
+                        r = decompress_startswith_with_context(journal_file_get_compress_context(f),
+                                                               compression,
+                                                               o->data.payload, l,
+                                                               &f->compress_buffer, &f->compress_buffer_size,
+                                                               field, field_length, '=');
                         if (r < 0)
                                 log_debug_errno(r, "Cannot decompress %s object of length %"PRIu64" at offset "OFSfmt": %m",
                                                 object_compressed_to_string(compression), l, p);
@@ -2332,10 +2581,11 @@ _public_ int sd_journal_get_data(sd_journal *j, const char *field, const void **
 
                                 size_t rsize;
 
-                                r = decompress_blob(compression,
-                                                    o->data.payload, l,
-                                                    &f->compress_buffer, &f->compress_buffer_size, &rsize,
-                                                    j->data_threshold);
+                                r = decompress_blob_with_context(journal_file_get_compress_context(f),
+                                                                 compression,
+                                                                 o->data.payload, l,
+                                                                 &f->compress_buffer, &f->compress_buffer_size, &rsize,
+                                                                 j->data_threshold);
                                 if (r < 0)
                                         return r;
 
@@ -2391,9 +2641,10 @@ static int return_data(sd_journal *j, JournalFile *f, Object *o, const void **da
                 size_t rsize;
                 int r;
 
-                r = decompress_blob(compression,
-                                    o->data.payload, l, &f->compress_buffer,
-                                    &f->compress_buffer_size, &rsize, j->data_threshold);
+                r = decompress_blob_with_context(journal_file_get_compress_context(f),
+                                                 compression,
+                                                 o->data.payload, l, &f->compress_buffer,
+                                                 &f->compress_buffer_size, &rsize, j->data_threshold);
                 if (r < 0)
                         return r;
 
@@ -2615,9 +2866,15 @@ static void process_inotify_event(sd_journal *j, const struct inotify_event *e)
 
                         /* Event for a journal file */
 
-                        if (e->mask & (IN_CREATE|IN_MOVED_TO|IN_MODIFY|IN_ATTRIB))
-                                (void) add_file_by_name(j, d->path, e->name);
-                        else if (e->mask & (IN_DELETE|IN_MOVED_FROM|IN_UNMOUNT))
+                        if (e->mask & (IN_CREATE|IN_MOVED_TO|IN_MODIFY|IN_ATTRIB)) {
+                                /* Writers trigger a plain modification for every batch of entries, in
+                                 * journal_file_post_change(). If we already track the file it is still the
+                                 * same one, and new entries are found through the mmap, which refreshes the
+                                 * size as needed. Hence don't reopen and stat it for those. */
+                                if ((e->mask & (IN_CREATE|IN_MOVED_TO|IN_ATTRIB)) ||
+                                    !ordered_hashmap_contains(j->files, prefix_roota(d->path, e->name)))
+                                        (void) add_file_by_name(j, d->path, e->name);
+                        } else if (e->mask & (IN_DELETE|IN_MOVED_FROM|IN_UNMOUNT))
                                 remove_file_by_name(j, d->path, e->name);
 
                 } else if (!d->is_root && e->len == 0) {
@@ -2824,6 +3081,20 @@ _public_ int sd_journal_get_cutoff_monotonic_usec(sd_journal *j, sd_id128_t boot
         return found;
 }
 
+void journal_set_access(sd_journal *j, ObjectType type, MMapCacheAccess access) {
+        assert(j);
+
+        /* All files share the same MMapCache */
+        journal_mmap_cache_set_access(j->mmap, type, access);
+}
+
+void journal_set_mmap_windows_min(sd_journal *j, unsigned n) {
+        assert(j);
+
+        /* All files share the same MMapCache. Its byte budget is raised to match. */
+        mmap_cache_set_windows_min(j->mmap, n);
+}
+
 void journal_print_header(sd_journal *j) {
         JournalFile *f;
         bool newline = false;
@@ -3198,6 +3469,28 @@ static char *lookup_field(const char *field, void *userdata) {
         return strndup((const char*) data + d, size - d);
 }
 
+static int journal_map_catalog(sd_journal *j) {
+        struct stat st;
+
+        assert(j);
+
+        /* Mapping the database costs a lot more than looking up an entry in it, and "journalctl -x" does
+         * that for every entry shown. Hence keep it mapped, and only map it again if it was replaced.
+         * catalog_update() renames a new file into place, so a changed inode is all we need to look for. */
+
+        if (stat(CATALOG_DATABASE, &st) < 0) {
+                journal_unmap_catalog(j);
+                return -errno;
+        }
+
+        if (j->catalog_map && stat_inode_unmodified(&st, &j->catalog_stat))
+                return 0;
+
+        journal_unmap_catalog(j);
+
+        return catalog_map(CATALOG_DATABASE, &j->catalog_map, &j->catalog_stat);
+}
+
 _public_ int sd_journal_get_catalog(sd_journal *j, char **ret) {
         const void *data;
         size_t size;
@@ -3222,7 +3515,11 @@ _public_ int sd_journal_get_catalog(sd_journal *j, char **ret) {
         if (r < 0)
                 return r;
 
-        r = catalog_get(CATALOG_DATABASE, id, &text);
+        r = journal_map_catalog(j);
+        if (r < 0)
+                return r;
+
+        r = catalog_get_mapped(j->catalog_map, id, &text);
         if (r < 0)
                 return r;
 
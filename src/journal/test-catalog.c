@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <locale.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include "sd-messages.h"
@@ -166,6 +167,26 @@ static void test_catalog_update(const char *database) {
         assert_se(r == 0);
 }
 
+static void test_catalog_get_mapped(const char *database) {
+        _cleanup_free_ char *a = NULL, *b = NULL, *c = NULL;
+        struct stat st;
+        void *p;
+
+        assert_se(catalog_map(database, &p, &st) >= 0);
+
+        assert_se(catalog_get_mapped(p, SD_MESSAGE_COREDUMP, &a) >= 0);
+        assert_se(catalog_get_mapped(p, SD_MESSAGE_COREDUMP, &b) >= 0);
+        assert_se(streq(a, b));
+
+        assert_se(catalog_get_mapped(p, SD_ID128_MAKE(f0,00,00,00,00,00,00,00,00,00,00,00,00,00,00,00), &c) == -ENOENT);
+        assert_se(!c);
+
+        assert_se(munmap(p, st.st_size) >= 0);
+
+        assert_se(catalog_get(database, SD_MESSAGE_COREDUMP, &c) >= 0);
+        assert_se(streq(a, c));
+}
+
 static void test_catalog_file_lang(void) {
         _cleanup_free_ char *lang = NULL, *lang2 = NULL, *lang3 = NULL, *lang4 = NULL;
 
@@ -221,6 +242,7 @@ int main(int argc, char *argv[]) {
         assert_se(mkostemp_safe(database) >= 0);
 
         test_catalog_update(database);
+        test_catalog_get_mapped(database);
 
         r = catalog_list(stdout, database, true);
         assert_se(r >= 0);
@@ -21,6 +21,7 @@ typedef int (decompress_t)(const void *src, uint64_t src_size,
 
 static usec_t arg_duration;
 static size_t arg_start;
+static CompressContext *arg_context;
 
 #define MAX_SIZE (1024*1024LU)
 #define PRIME 1048571  /* A prime close enough to one megabyte that mod 4 == 3 */
@@ -73,6 +74,26 @@ static char* make_buf(size_t count, const char *type) {
         return buf;
 }
 
+/* Wrappers that reuse the codec state across calls, to compare with the plain functions */
+#if HAVE_LZ4
+static int compress_blob_lz4_reuse(const void *src, uint64_t src_size, void *dst,
+                                   size_t dst_alloc_size, size_t *dst_size) {
+        return compress_blob_lz4_with_context(arg_context, src, src_size, dst, dst_alloc_size, dst_size);
+}
+#endif
+
+#if HAVE_ZSTD
+static int compress_blob_zstd_reuse(const void *src, uint64_t src_size, void *dst,
+                                    size_t dst_alloc_size, size_t *dst_size) {
+        return compress_blob_zstd_with_context(arg_context, src, src_size, dst, dst_alloc_size, dst_size);
+}
+
+static int decompress_blob_zstd_reuse(const void *src, uint64_t src_size,
+                                      void **dst, size_t *dst_alloc_size, size_t* dst_size, size_t dst_max) {
+        return decompress_blob_zstd_with_context(arg_context, src, src_size, dst, dst_alloc_size, dst_size, dst_max);
+}
+#endif
+
 static void test_compress_decompress(const char* label, const char* type,
                                      compress_t compress, decompress_t decompress) {
         usec_t n, n2 = 0;
@@ -160,6 +181,10 @@ int main(int argc, char *argv[]) {
         else
                 arg_start = getpid_cached();
 
+        _cleanup_(compress_context_freep) CompressContext *c = NULL;
+        assert_se(compress_context_new(&c) >= 0);
+        arg_context = c;
+
         const char *i;
         NULSTR_FOREACH(i, "zeros\0simple\0random\0") {
 #if HAVE_XZ
@@ -167,9 +192,11 @@ int main(int argc, char *argv[]) {
 #endif
 #if HAVE_LZ4
                 test_compress_decompress("LZ4", i, compress_blob_lz4, decompress_blob_lz4);
+                test_compress_decompress("LZ4/reuse", i, compress_blob_lz4_reuse, decompress_blob_lz4);
 #endif
 #if HAVE_ZSTD
                 test_compress_decompress("ZSTD", i, compress_blob_zstd, decompress_blob_zstd);
+                test_compress_decompress("ZSTD/reuse", i, compress_blob_zstd_reuse, decompress_blob_zstd_reuse);
 #endif
         }
         return 0;
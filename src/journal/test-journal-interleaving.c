@@ -196,6 +196,73 @@ static void test_skip(void (*setup)(void)) {
         puts("------------------------------------------------------------");
 }
 
+static void test_remove_file(void) {
+        char t[] = "/var/tmp/journal-remove-XXXXXX";
+        const char *names[] = { "one.journal", "two.journal", "three.journal", "four.journal" };
+        JournalFile *f[ELEMENTSOF(names)];
+        sd_journal *j;
+
+        mkdtemp_chdir_chattr(t);
+
+        for (size_t i = 0; i < ELEMENTSOF(names); i++)
+                f[i] = test_open(names[i]);
+        for (int n = 1; n <= 8; n++)
+                append_number(f[(n - 1) % ELEMENTSOF(names)], n, NULL);
+        for (size_t i = 0; i < ELEMENTSOF(names); i++)
+                test_close(f[i]);
+
+        assert_ret(sd_journal_open_directory(&j, t, 0));
+        assert_ret(sd_journal_get_fd(j));
+
+        assert_ret(sd_journal_seek_head(j));
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 1);
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 2);
+
+        /* Drop some files other than the current one while we are in the middle of iterating */
+        assert_se(unlink("three.journal") >= 0);
+        assert_se(unlink("four.journal") >= 0);
+        assert_ret(sd_journal_process(j));
+
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 5);
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 6);
+        assert_se(sd_journal_next(j) == 0);
+
+        /* And seek again, the removed files must be gone for good */
+        assert_ret(sd_journal_seek_head(j));
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 1);
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 2);
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 5);
+
+        /* Drop the current file too */
+        assert_se(unlink("one.journal") >= 0);
+        assert_ret(sd_journal_process(j));
+
+        assert_ret(sd_journal_seek_head(j));
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 2);
+        assert_se(sd_journal_next(j) == 1);
+        test_check_number(j, 6);
+        assert_se(sd_journal_next(j) == 0);
+
+        sd_journal_close(j);
+
+        log_info("Done...");
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                assert_se(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL) >= 0);
+
+        puts("------------------------------------------------------------");
+}
+
 static void test_sequence_numbers(void) {
 
         char t[] = "/var/tmp/journal-seq-XXXXXX";
@@ -290,6 +357,8 @@ int main(int argc, char *argv[]) {
         test_skip(setup_sequential);
         test_skip(setup_interleaved);
 
+        test_remove_file();
+
         test_sequence_numbers();
 
         return 0;
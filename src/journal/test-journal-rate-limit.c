@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include "journald-rate-limit.h"
+#include "macro.h"
+#include "stdio-util.h"
+#include "tests.h"
+
+/* Time is passed in explicitly. Start well after zero, as a pool that was never used begins at zero. */
+#define T0 (1000 * USEC_PER_SEC)
+
+#define INTERVAL (1 * USEC_PER_SEC)
+
+/* With this little disk space the burst is not modulated */
+#define AVAILABLE 1
+
+static int ratelimit_test(JournalRateLimit *r, const char *id, JournalRateLimitRef *ref, JournalRateLimitMode mode, unsigned burst, usec_t ts) {
+        return journal_ratelimit_test(r, id, ref, mode, INTERVAL, burst, LOG_INFO, AVAILABLE, ts);
+}
+
+static void add_groups(JournalRateLimit *r, unsigned n, usec_t ts) {
+        for (unsigned i = 0; i < n; i++) {
+                char id[STRLEN("other-") + DECIMAL_STR_MAX(unsigned)];
+
+                xsprintf(id, "other-%u", i);
+                assert_se(ratelimit_test(r, id, NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 1);
+        }
+}
+
+static void test_burst(JournalRateLimitMode mode) {
+        JournalRateLimit *r;
+
+        log_info("/* %s(%s) */", __func__, journal_ratelimit_mode_to_string(mode));
+
+        assert_se(r = journal_ratelimit_new());
+
+        for (unsigned i = 0; i < 10; i++)
+                assert_se(ratelimit_test(r, "a", NULL, mode, 10, T0) == 1);
+        for (unsigned i = 0; i < 5; i++)
+                assert_se(ratelimit_test(r, "a", NULL, mode, 10, T0) == 0);
+
+        /* Other clients and other priorities are accounted separately */
+        assert_se(ratelimit_test(r, "b", NULL, mode, 10, T0) == 1);
+        assert_se(journal_ratelimit_test(r, "a", NULL, mode, INTERVAL, 10, LOG_ERR, AVAILABLE, T0) == 1);
+
+        /* No limit at all */
+        for (unsigned i = 0; i < 100; i++) {
+                assert_se(journal_ratelimit_test(r, "c", NULL, mode, 0, 10, LOG_INFO, AVAILABLE, T0) == 1);
+                assert_se(ratelimit_test(r, "c", NULL, mode, 0, T0) == 1);
+        }
+
+        journal_ratelimit_free(r);
+}
+
+static void test_refill(void) {
+        JournalRateLimit *r;
+        usec_t ts = T0;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(r = journal_ratelimit_new());
+
+        for (unsigned i = 0; i < 10; i++) {
+                assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 1);
+                assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 1);
+        }
+        assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 0);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 0);
+
+        /* A fifth of the interval refills the bucket by exactly two messages, but the window is still
+         * closed. The first message let through reports the one suppressed before. */
+        ts += INTERVAL / 5;
+        assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 0);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 2);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 1);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 0);
+
+        /* Credit accumulates over several steps */
+        ts += INTERVAL / 20;
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 0);
+        ts += INTERVAL / 20;
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 1 + 2);
+
+        /* After a full interval both let a full burst through again, but the bucket doesn't get more
+         * than that, however long it was quiet */
+        ts += 100 * INTERVAL;
+        assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 1 + 2);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 1);
+        for (unsigned i = 1; i < 10; i++) {
+                assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 1);
+                assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 1);
+        }
+        assert_se(ratelimit_test(r, "window", NULL, JOURNAL_RATELIMIT_WINDOW, 10, ts) == 0);
+        assert_se(ratelimit_test(r, "bucket", NULL, JOURNAL_RATELIMIT_TOKEN_BUCKET, 10, ts) == 0);
+
+        journal_ratelimit_free(r);
+}
+
+static void test_ref(void) {
+        JournalRateLimitRef ref = {}, old;
+        JournalRateLimit *r;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(r = journal_ratelimit_new());
+
+        /* The first message fills in the reference, and later ones use the same group through it */
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 2, T0) == 1);
+        assert_se(ref.group);
+        old = ref;
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 2, T0) == 1);
+        assert_se(ref.group == old.group);
+        assert_se(ref.generation == old.generation);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 2, T0) == 0);
+
+        /* A reference to another client's group is not used for this one */
+        assert_se(ratelimit_test(r, "b", &ref, JOURNAL_RATELIMIT_WINDOW, 2, T0) == 1);
+        assert_se(ref.group != old.group);
+        assert_se(ratelimit_test(r, "a", NULL, JOURNAL_RATELIMIT_WINDOW, 2, T0) == 0);
+
+        journal_ratelimit_free(r);
+}
+
+static void test_evict(void) {
+        JournalRateLimitRef ref = {}, old;
+        JournalRateLimit *r;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(r = journal_ratelimit_new());
+
+        /* When the table is full, the oldest group is dropped. "x" goes first, and the reference to "a"
+         * becomes stale. The group is then looked up by name again, and still remembers the burst. */
+        assert_se(ratelimit_test(r, "x", NULL, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 1);
+        assert_se(ratelimit_test(r, "x", NULL, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 0);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 1);
+        old = ref;
+
+        add_groups(r, JOURNAL_RATELIMIT_GROUPS_MAX - 1, T0);
+
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 0);
+        assert_se(ref.group == old.group);
+        assert_se(ref.generation != old.generation);
+
+        /* "x" starts from scratch. Adding it back drops "a", which is the oldest one now. */
+        assert_se(ratelimit_test(r, "x", NULL, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 1);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 1);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 0);
+
+        journal_ratelimit_free(r);
+}
+
+static void test_expire(void) {
+        JournalRateLimitRef ref = {}, old;
+        JournalRateLimit *r;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(r = journal_ratelimit_new());
+
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 1);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0) == 0);
+        old = ref;
+
+        /* Groups are kept while their interval lasts */
+        assert_se(ratelimit_test(r, "b", NULL, JOURNAL_RATELIMIT_WINDOW, 1, T0 + INTERVAL) == 1);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0 + INTERVAL) == 0);
+        assert_se(ref.generation == old.generation);
+
+        /* Groups that saw no message for longer are dropped when a new one is added */
+        assert_se(ratelimit_test(r, "c", NULL, JOURNAL_RATELIMIT_WINDOW, 1, T0 + 2 * INTERVAL) == 1);
+        assert_se(ratelimit_test(r, "a", &ref, JOURNAL_RATELIMIT_WINDOW, 1, T0 + 2 * INTERVAL) == 1);
+        assert_se(ref.generation != old.generation);
+
+        journal_ratelimit_free(r);
+}
+
+int main(int argc, char *argv[]) {
+        test_setup_logging(LOG_DEBUG);
+
+        test_burst(JOURNAL_RATELIMIT_WINDOW);
+        test_burst(JOURNAL_RATELIMIT_TOKEN_BUCKET);
+        test_refill();
+        test_ref();
+        test_evict();
+        test_expire();
+
+        return 0;
+}
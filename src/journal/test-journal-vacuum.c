@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "chattr-util.h"
+#include "copy.h"
+#include "fd-util.h"
+#include "hashmap.h"
+#include "io-util.h"
+#include "journal-file.h"
+#include "journal-vacuum.h"
+#include "log.h"
+#include "rm-rf.h"
+#include "tests.h"
+
+static void append_and_rotate(JournalFile **f) {
+        static const char test[] = "TEST1=1";
+        dual_timestamp ts;
+        struct iovec iovec;
+
+        assert_se(dual_timestamp_get(&ts));
+
+        iovec = IOVEC_MAKE_STRING(test);
+        assert_se(journal_file_append_entry(*f, &ts, NULL, &iovec, 1, NULL, NULL, NULL) == 0);
+
+        assert_se(journal_file_rotate(f, false, (uint64_t) -1, false, NULL) >= 0);
+}
+
+static void make_empty(const char *fn) {
+        _cleanup_close_ int fd = -1;
+        le64_t n_entries = 0;
+
+        /* Pretend the file has no entries, without replacing it */
+        assert_se((fd = open(fn, O_WRONLY|O_CLOEXEC)) >= 0);
+        assert_se(pwrite(fd, &n_entries, sizeof(n_entries), offsetof(Header, n_entries)) == sizeof(n_entries));
+}
+
+static void test_vacuum_cache(void) {
+        _cleanup_free_ char *a = NULL, *b = NULL;
+        char t[] = "/var/tmp/journal-vacuum-XXXXXX";
+        Hashmap *cache = NULL;
+        JournalFile *f;
+        const char *fn;
+        void *e;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(mkdtemp(t));
+        assert_se(chdir(t) >= 0);
+        (void) chattr_path(t, FS_NOCOW_FL, FS_NOCOW_FL, NULL);
+
+        assert_se(journal_file_open(-1, "test.journal", O_RDWR|O_CREAT, 0666, false, (uint64_t) -1, false, NULL, NULL, NULL, NULL, &f) == 0);
+        append_and_rotate(&f);
+        append_and_rotate(&f);
+        (void) journal_file_close(f);
+
+        /* Nothing to delete, but both archives are remembered. The active file is not. */
+        assert_se(journal_directory_vacuum_full(".", &cache, (uint64_t) -1, 0, 0, NULL, true) >= 0);
+        assert_se(hashmap_size(cache) == 2);
+
+        HASHMAP_FOREACH_KEY(e, fn, cache)
+                if (!a)
+                        assert_se(a = strdup(fn));
+                else
+                        assert_se(b = strdup(fn));
+        assert_se(a && b);
+
+        /* A known file is not opened again, hence it is not found empty */
+        make_empty(a);
+        assert_se(journal_directory_vacuum_full(".", &cache, (uint64_t) -1, 0, 0, NULL, true) >= 0);
+        assert_se(access(a, F_OK) >= 0);
+        assert_se(hashmap_size(cache) == 2);
+
+        /* Unless it was replaced in the meantime */
+        assert_se(copy_file(a, "copy.tmp", 0, 0644, 0, 0, 0) >= 0);
+        assert_se(rename("copy.tmp", a) >= 0);
+        assert_se(journal_directory_vacuum_full(".", &cache, (uint64_t) -1, 0, 0, NULL, true) >= 0);
+        assert_se(access(a, F_OK) < 0 && errno == ENOENT);
+        assert_se(hashmap_size(cache) == 1);
+        assert_se(!hashmap_get(cache, a));
+        assert_se(hashmap_get(cache, b));
+
+        /* Files removed behind our back are forgotten */
+        assert_se(unlink(b) >= 0);
+        assert_se(journal_directory_vacuum_full(".", &cache, (uint64_t) -1, 0, 0, NULL, true) >= 0);
+        assert_se(hashmap_isempty(cache));
+
+        /* And so are files we delete */
+        assert_se(journal_file_open(-1, "test.journal", O_RDWR|O_CREAT, 0666, false, (uint64_t) -1, false, NULL, NULL, NULL, NULL, &f) == 0);
+        append_and_rotate(&f);
+        (void) journal_file_close(f);
+        assert_se(journal_directory_vacuum_full(".", &cache, (uint64_t) -1, 0, 0, NULL, true) >= 0);
+        assert_se(hashmap_size(cache) == 1);
+        assert_se(journal_directory_vacuum_full(".", &cache, 1, 0, 0, NULL, true) >= 0);
+        assert_se(hashmap_isempty(cache));
+
+        hashmap_free_free_free(cache);
+
+        assert_se(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL) >= 0);
+}
+
+int main(int argc, char *argv[]) {
+        test_setup_logging(LOG_DEBUG);
+
+        /* journal_file_open requires a valid machine id */
+        if (access("/etc/machine-id", F_OK) != 0)
+                return log_tests_skipped("/etc/machine-id not found");
+
+        test_vacuum_cache();
+
+        return 0;
+}
@@ -51,6 +51,10 @@ static void test_non_empty(void) {
         iovec = IOVEC_MAKE_STRING(test);
         assert_se(journal_file_append_entry(f, &ts, &fake_boot_id, &iovec, 1, NULL, NULL, NULL) == 0);
 
+        /* The repeated payload should have been found in the data cache */
+        assert_se(journal_file_data_cache_get_hit(f) == 1);
+        assert_se(journal_file_data_cache_get_missed(f) == 1);
+
 #if HAVE_GCRYPT
         journal_file_append_tag(f);
 #endif
@@ -116,6 +120,76 @@ static void test_non_empty(void) {
         puts("------------------------------------------------------------");
 }
 
+static void test_append_entries(void) {
+        static const char test[] = "TEST1=1", test2[] = "TEST2=2", test3[] = "TEST3=3";
+        JournalAppendEntry entries[3];
+        struct iovec iovec[3][2];
+        dual_timestamp ts;
+        JournalFile *f;
+        Object *o;
+        uint64_t p, seqnum = 0;
+        size_t n = 0;
+        char t[] = "/var/tmp/journal-XXXXXX";
+
+        test_setup_logging(LOG_DEBUG);
+
+        mkdtemp_chdir_chattr(t);
+
+        assert_se(journal_file_open(-1, "test.journal", O_RDWR|O_CREAT, 0666, true, (uint64_t) -1, true, NULL, NULL, NULL, NULL, &f) == 0);
+
+        assert_se(dual_timestamp_get(&ts));
+
+        /* The first field repeats across all entries and should be shared, the second one doesn't */
+        iovec[0][0] = iovec[1][0] = iovec[2][0] = IOVEC_MAKE_STRING(test);
+        iovec[0][1] = IOVEC_MAKE_STRING(test2);
+        iovec[1][1] = IOVEC_MAKE_STRING(test3);
+        iovec[2][1] = IOVEC_MAKE_STRING(test2);
+
+        for (size_t i = 0; i < ELEMENTSOF(entries); i++)
+                entries[i] = (JournalAppendEntry) {
+                        .ts = ts,
+                        .iovec = iovec[i],
+                        .n_iovec = 2,
+                };
+
+        assert_se(journal_file_append_entries(f, entries, ELEMENTSOF(entries), &seqnum, &n) == 0);
+        assert_se(n == ELEMENTSOF(entries));
+        assert_se(seqnum == 3);
+
+        journal_file_dump(f);
+
+        assert_se(le64toh(f->header->n_entries) == 3);
+        assert_se(le64toh(f->header->n_data) == 3);
+
+        assert_se(journal_file_find_data_object(f, test, strlen(test), &o, &p) == 1);
+        assert_se(le64toh(o->data.n_entries) == 3);
+        assert_se(journal_file_next_entry_for_data(f, NULL, 0, p, DIRECTION_UP, &o, NULL) == 1);
+        assert_se(le64toh(o->entry.seqnum) == 3);
+
+        assert_se(journal_file_find_data_object(f, test2, strlen(test2), &o, &p) == 1);
+        assert_se(le64toh(o->data.n_entries) == 2);
+
+        assert_se(journal_file_find_data_object(f, test3, strlen(test3), &o, &p) == 1);
+        assert_se(le64toh(o->data.n_entries) == 1);
+        assert_se(journal_file_next_entry_for_data(f, NULL, 0, p, DIRECTION_DOWN, &o, NULL) == 1);
+        assert_se(le64toh(o->entry.seqnum) == 2);
+
+        /* Invalid timestamps are refused, but everything before the bad entry is written */
+        entries[1].ts.realtime = 0;
+        assert_se(journal_file_append_entries(f, entries, ELEMENTSOF(entries), &seqnum, &n) == -EBADMSG);
+        assert_se(n == 1);
+        assert_se(le64toh(f->header->n_entries) == 4);
+
+        (void) journal_file_close(f);
+
+        if (arg_keep)
+                log_info("Not removing %s", t);
+        else
+                assert_se(rm_rf(t, REMOVE_ROOT|REMOVE_PHYSICAL) >= 0);
+
+        puts("------------------------------------------------------------");
+}
+
 static void test_empty(void) {
         JournalFile *f1, *f2, *f3, *f4;
         char t[] = "/var/tmp/journal-XXXXXX";
@@ -250,6 +324,7 @@ int main(int argc, char *argv[]) {
                 return log_tests_skipped("/etc/machine-id not found");
 
         test_non_empty();
+        test_append_entries();
         test_empty();
 #if HAVE_COMPRESSION
         test_min_compress_size();
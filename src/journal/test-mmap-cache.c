@@ -11,6 +11,48 @@
 #include "tmpfile-util.h"
 #include "util.h"
 
+static void test_bytes_max(int fd) {
+        MMapFileDescriptor *f;
+        MMapCache *m;
+        void *p;
+
+        assert_se(m = mmap_cache_new());
+        assert_se(f = mmap_cache_add_fd(m, fd));
+
+        /* With a budget smaller than a single window, every window nobody refers to anymore is unmapped
+         * right-away, hence only the one of the context remains */
+        mmap_cache_set_bytes_max(m, 1);
+
+        for (unsigned i = 0; i < 4; i++)
+                assert_se(mmap_cache_get(m, f, PROT_READ, 0, false, i * 16ULL*1024ULL*1024ULL, 2, NULL, &p, NULL) >= 0);
+
+        assert_se(mmap_cache_get_n_windows(m) == 1);
+        assert_se(mmap_cache_get_n_bytes(m) > 0);
+
+        mmap_cache_free_fd(m, f);
+        mmap_cache_unref(m);
+}
+
+static void test_windows_min(int fd) {
+        MMapFileDescriptor *f;
+        MMapCache *m;
+        void *p;
+
+        assert_se(m = mmap_cache_new());
+        assert_se(f = mmap_cache_add_fd(m, fd));
+
+        /* More windows than the default budget covers are kept around when asked for */
+        mmap_cache_set_windows_min(m, 128);
+
+        for (unsigned i = 0; i < 100; i++)
+                assert_se(mmap_cache_get(m, f, PROT_READ, 0, false, i * 16ULL*1024ULL*1024ULL, 2, NULL, &p, NULL) >= 0);
+
+        assert_se(mmap_cache_get_n_windows(m) == 100);
+
+        mmap_cache_free_fd(m, f);
+        mmap_cache_unref(m);
+}
+
 int main(int argc, char *argv[]) {
         MMapFileDescriptor *fx;
         int x, y, z, r;
@@ -55,9 +97,32 @@ int main(int argc, char *argv[]) {
 
         assert_se((uint8_t*) p + 1 == (uint8_t*) q);
 
+        /* Sequential windows start at the requested page, hence the second request is covered by the
+         * window of the first one */
+        mmap_cache_set_access(m, 2, MMAP_CACHE_ACCESS_SEQUENTIAL);
+        mmap_cache_set_windows_min(m, 4);
+
+        r = mmap_cache_get(m, fx, PROT_READ, 2, false, 64ULL*1024ULL*1024ULL, 2, NULL, &p, NULL);
+        assert_se(r >= 0);
+
+        r = mmap_cache_get(m, fx, PROT_READ, 2, false, 72ULL*1024ULL*1024ULL, 2, NULL, &q, NULL);
+        assert_se(r >= 0);
+
+#if !ENABLE_DEBUG_MMAP_CACHE
+        assert_se((uint8_t*) p + 8ULL*1024ULL*1024ULL == (uint8_t*) q);
+#endif
+
+        mmap_cache_set_access(m, 2, MMAP_CACHE_ACCESS_RANDOM);
+
+        r = mmap_cache_get(m, fx, PROT_READ, 2, false, 128ULL*1024ULL*1024ULL, 2, NULL, &p, NULL);
+        assert_se(r >= 0);
+
         mmap_cache_free_fd(m, fx);
         mmap_cache_unref(m);
 
+        test_bytes_max(x);
+        test_windows_min(x);
+
         safe_close(x);
         safe_close(y);
         safe_close(z);
@@ -22,6 +22,9 @@
 #define DHCP_DEFAULT_LEASE_TIME_USEC USEC_PER_HOUR
 #define DHCP_MAX_LEASE_TIME_USEC (USEC_PER_HOUR*12)
 
+/* How many messages to process at most before returning to the event loop */
+#define DHCP_SERVER_MESSAGES_PER_WAKEUP_MAX 16U
+
 static DHCPLease *dhcp_lease_free(DHCPLease *lease) {
         if (!lease)
                 return NULL;
@@ -951,11 +954,9 @@ int dhcp_server_handle_message(sd_dhcp_server *server, DHCPMessage *message,
         return 0;
 }
 
-static int server_receive_message(sd_event_source *s, int fd,
-                                  uint32_t revents, void *userdata) {
+static int server_receive_one_message(sd_dhcp_server *server, int fd) {
         _cleanup_free_ DHCPMessage *message = NULL;
         CMSG_BUFFER_TYPE(CMSG_SPACE(sizeof(struct in_pktinfo))) control;
-        sd_dhcp_server *server = userdata;
         struct iovec iov = {};
         struct msghdr msg = {
                 .msg_iov = &iov,
@@ -980,8 +981,6 @@ static int server_receive_message(sd_event_source *s, int fd,
         iov = IOVEC_MAKE(message, buflen);
 
         len = recvmsg_safe(fd, &msg, 0);
-        if (IN_SET(len, -EAGAIN, -EINTR))
-                return 0;
         if (len < 0)
                 return len;
         if ((size_t) len < sizeof(DHCPMessage))
@@ -1009,6 +1008,33 @@ static int server_receive_message(sd_event_source *s, int fd,
         return 0;
 }
 
+static int server_receive_message(sd_event_source *s, int fd,
+                                  uint32_t revents, void *userdata) {
+        _unused_ _cleanup_(sd_dhcp_server_unrefp) sd_dhcp_server *ref = NULL;
+        sd_dhcp_server *server = userdata;
+        int r;
+
+        assert(server);
+
+        /* When many clients renew at the same time, process a couple of queued messages per wakeup, so
+         * that we don't need one poll for each of them. The lease callback might stop or unref the server,
+         * hence keep a reference and check that it is still running. */
+        ref = sd_dhcp_server_ref(server);
+
+        for (unsigned i = 0; i < DHCP_SERVER_MESSAGES_PER_WAKEUP_MAX; i++) {
+                if (server->fd != fd)
+                        break;
+
+                r = server_receive_one_message(server, fd);
+                if (IN_SET(r, -EAGAIN, -EINTR))
+                        return 0; /* Queue drained */
+                if (r < 0)
+                        return r;
+        }
+
+        return 0;
+}
+
 int sd_dhcp_server_start(sd_dhcp_server *server) {
         int r;
 
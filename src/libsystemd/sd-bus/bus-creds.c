@@ -785,29 +785,35 @@ int bus_creds_add_more(sd_bus_creds *c, uint64_t mask, pid_t pid, pid_t tid) {
                 c->mask |= SD_BUS_CREDS_TID;
         }
 
-        if (missing & (SD_BUS_CREDS_PPID |
-                       SD_BUS_CREDS_UID | SD_BUS_CREDS_EUID | SD_BUS_CREDS_SUID | SD_BUS_CREDS_FSUID |
-                       SD_BUS_CREDS_GID | SD_BUS_CREDS_EGID | SD_BUS_CREDS_SGID | SD_BUS_CREDS_FSGID |
-                       SD_BUS_CREDS_SUPPLEMENTARY_GIDS |
-                       SD_BUS_CREDS_EFFECTIVE_CAPS | SD_BUS_CREDS_INHERITABLE_CAPS |
-                       SD_BUS_CREDS_PERMITTED_CAPS | SD_BUS_CREDS_BOUNDING_CAPS)) {
-
+        uint64_t status_missing = missing & (SD_BUS_CREDS_PPID |
+                                             SD_BUS_CREDS_UID | SD_BUS_CREDS_EUID | SD_BUS_CREDS_SUID | SD_BUS_CREDS_FSUID |
+                                             SD_BUS_CREDS_GID | SD_BUS_CREDS_EGID | SD_BUS_CREDS_SGID | SD_BUS_CREDS_FSGID |
+                                             SD_BUS_CREDS_SUPPLEMENTARY_GIDS |
+                                             SD_BUS_CREDS_EFFECTIVE_CAPS | SD_BUS_CREDS_INHERITABLE_CAPS |
+                                             SD_BUS_CREDS_PERMITTED_CAPS | SD_BUS_CREDS_BOUNDING_CAPS);
+        if (status_missing != 0) {
                 _cleanup_fclose_ FILE *f = NULL;
                 const char *p;
 
                 p = procfs_file_alloca(pid, "status");
 
-                f = fopen(p, "re");
-                if (!f) {
-                        if (errno == ENOENT)
+                r = fopen_unlocked(p, "re", &f);
+                if (r < 0) {
+                        if (r == -ENOENT)
                                 return -ESRCH;
-                        else if (!IN_SET(errno, EPERM, EACCES))
-                                return -errno;
+                        else if (!IN_SET(r, -EPERM, -EACCES))
+                                return r;
                 } else {
 
                         for (;;) {
                                 _cleanup_free_ char *line = NULL;
 
+                                /* Stop as soon as we have everything we were asked for, the file is long and
+                                 * the capability sets are right at the end, after lots of memory and signal
+                                 * fields nobody is interested in here. */
+                                if ((c->mask & status_missing) == status_missing)
+                                        break;
+
                                 r = read_line(f, LONG_LINE_MAX, &line);
                                 if (r < 0)
                                         return r;
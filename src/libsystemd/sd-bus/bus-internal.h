@@ -96,12 +96,17 @@ struct node_vtable {
         struct node *node;
 
         bool is_fallback:1;
+        bool introspection_trusted:1;
         unsigned last_iteration;
 
         char *interface;
         const sd_bus_vtable *vtable;
         sd_bus_object_find_t find;
 
+        /* The introspection data of the members of the vtable. The vtable cannot change while it is
+         * registered, hence we format it only once, and keep it until the vtable is removed again. */
+        char *introspection;
+
         LIST_FIELDS(struct node_vtable, vtables);
 };
 
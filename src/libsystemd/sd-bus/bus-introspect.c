@@ -187,23 +187,13 @@ static int introspect_write_arguments(struct introspect *i, const char *signatur
         }
 }
 
-int introspect_write_interface(
-                struct introspect *i,
-                const char *interface_name,
-                const sd_bus_vtable *v) {
-
+static void introspect_write_members(struct introspect *i, const sd_bus_vtable *v) {
         const sd_bus_vtable *vtable = v;
         const char *names = "";
-        int r;
 
         assert(i);
-        assert(interface_name);
         assert(v);
 
-        r = set_interface_name(i, interface_name);
-        if (r < 0)
-                return r;
-
         for (; v->type != _SD_BUS_VTABLE_END; v = bus_vtable_next(vtable, v)) {
 
                 /* Ignore methods, signals and properties that are
@@ -251,7 +241,71 @@ int introspect_write_interface(
                 }
 
         }
+}
+
+int introspect_write_interface(
+                struct introspect *i,
+                const char *interface_name,
+                const sd_bus_vtable *v) {
+
+        int r;
+
+        assert(i);
+        assert(interface_name);
+        assert(v);
+
+        r = set_interface_name(i, interface_name);
+        if (r < 0)
+                return r;
+
+        introspect_write_members(i, v);
+        return 0;
+}
+
+int introspect_format_members(const sd_bus_vtable *v, bool trusted, char **ret) {
+        _cleanup_(introspect_free) struct introspect i = {
+                .trusted = trusted,
+        };
+        int r;
+
+        assert(v);
+        assert(ret);
+
+        /* Formats the members of the vtable only, without the surrounding <interface> element, so that the
+         * result can be cached and written out with introspect_write_interface_members() later on. */
+
+        i.f = open_memstream_unlocked(&i.introspection, &i.size);
+        if (!i.f)
+                return -ENOMEM;
+
+        introspect_write_members(&i, v);
+
+        r = fflush_and_check(i.f);
+        if (r < 0)
+                return r;
+
+        i.f = safe_fclose(i.f);
+        *ret = TAKE_PTR(i.introspection);
+
+        return 0;
+}
+
+int introspect_write_interface_members(
+                struct introspect *i,
+                const char *interface_name,
+                const char *members) {
+
+        int r;
+
+        assert(i);
+        assert(interface_name);
+        assert(members);
+
+        r = set_interface_name(i, interface_name);
+        if (r < 0)
+                return r;
 
+        fputs(members, i->f);
         return 0;
 }
 
@@ -22,5 +22,10 @@ int introspect_write_interface(
                 struct introspect *i,
                 const char *interface_name,
                 const sd_bus_vtable *v);
+int introspect_format_members(const sd_bus_vtable *v, bool trusted, char **ret);
+int introspect_write_interface_members(
+                struct introspect *i,
+                const char *interface_name,
+                const char *members);
 int introspect_finish(struct introspect *i, char **ret);
 void introspect_free(struct introspect *i);
@@ -53,7 +53,7 @@ static bool BUS_MATCH_IS_COMPARE(enum bus_match_node_type t) {
 }
 
 static bool BUS_MATCH_CAN_HASH(enum bus_match_node_type t) {
-        return (t >= BUS_MATCH_MESSAGE_TYPE && t <= BUS_MATCH_PATH) ||
+        return (t >= BUS_MATCH_MESSAGE_TYPE && t <= BUS_MATCH_PATH_NAMESPACE) ||
                 (t >= BUS_MATCH_ARG && t <= BUS_MATCH_ARG_LAST) ||
                 (t >= BUS_MATCH_ARG_HAS && t <= BUS_MATCH_ARG_HAS_LAST);
 }
@@ -239,6 +239,70 @@ static bool value_node_same(
         }
 }
 
+static int bus_match_run_path_namespace(
+                sd_bus *bus,
+                struct bus_match_node *node,
+                sd_bus_message *m,
+                const char *path) {
+
+        _cleanup_free_ char *prefix = NULL;
+        size_t k, last = (size_t) -1;
+        int r;
+
+        assert(node);
+        assert(node->type == BUS_MATCH_PATH_NAMESPACE);
+
+        /* The value nodes of path_namespace= matches are hashed too. A path is part of a namespace if it is
+         * the namespace itself, if the namespace is followed by a slash in the path, or if the namespace
+         * ends in a slash. Hence look up exactly those prefixes of the path, instead of testing each
+         * namespace. */
+
+        if (!path)
+                return 0;
+
+        prefix = strdup(path);
+        if (!prefix)
+                return -ENOMEM;
+
+        for (k = 0;; k++) {
+                size_t lengths[2], i, n = 0;
+
+                if (!IN_SET(path[k], '/', 0))
+                        continue;
+
+                /* The prefix up to here, and, if at a slash, the prefix including the slash */
+                if (k != last)
+                        lengths[n++] = k;
+                if (path[k] == '/')
+                        lengths[n++] = k + 1;
+
+                for (i = 0; i < n; i++) {
+                        struct bus_match_node *found;
+                        char saved;
+
+                        saved = prefix[lengths[i]];
+                        prefix[lengths[i]] = 0;
+                        found = hashmap_get(node->compare.children, prefix);
+                        prefix[lengths[i]] = saved;
+
+                        last = lengths[i];
+
+                        if (!found)
+                                continue;
+
+                        r = bus_match_run(bus, found, m);
+                        if (r != 0)
+                                return r;
+
+                        if (bus && bus->match_callbacks_modified)
+                                return 0;
+                }
+
+                if (path[k] == 0)
+                        return 0;
+        }
+}
+
 int bus_match_run(
                 sd_bus *bus,
                 struct bus_match_node *node,
@@ -384,7 +448,13 @@ int bus_match_run(
 
                 /* Lookup via hash table, nice! So let's jump directly. */
 
-                if (test_str)
+                if (node->type == BUS_MATCH_PATH_NAMESPACE) {
+                        r = bus_match_run_path_namespace(bus, node, m, test_str);
+                        if (r != 0)
+                                return r;
+
+                        found = NULL;
+                } else if (test_str)
                         found = hashmap_get(node->compare.children, test_str);
                 else if (test_strv) {
                         char **i;
@@ -97,12 +97,49 @@ static struct bus_container *message_get_last_container(sd_bus_message *m) {
         return m->containers + m->n_containers - 1;
 }
 
+static char *message_container_signature_new(sd_bus_message *m, const char *contents) {
+        size_t l;
+        char *s;
+
+        assert(m);
+        assert(contents);
+
+        l = strlen(contents);
+        if (m->spare_signature && l < m->spare_signature_size) {
+                s = memcpy(TAKE_PTR(m->spare_signature), contents, l + 1);
+                m->spare_signature_size = 0;
+                return s;
+        }
+
+        return memdup(contents, l + 1);
+}
+
+static void message_container_signature_free(sd_bus_message *m, char *s) {
+        size_t l;
+
+        assert(m);
+
+        if (!s)
+                return;
+
+        /* Keep the longer of the two buffers around for the next container */
+        l = strlen(s) + 1;
+        if (l <= m->spare_signature_size) {
+                free(s);
+                return;
+        }
+
+        free(m->spare_signature);
+        m->spare_signature = s;
+        m->spare_signature_size = l;
+}
+
 static void message_free_last_container(sd_bus_message *m) {
         struct bus_container *c;
 
         c = message_get_last_container(m);
 
-        free(c->signature);
+        message_container_signature_free(m, c->signature);
         free(c->peeked_signature);
         free(c->offsets);
 
@@ -144,11 +181,16 @@ static sd_bus_message* message_free(sd_bus_message *m) {
         message_reset_containers(m);
         assert(m->n_containers == 0);
         message_free_last_container(m);
+        free(m->spare_signature);
 
         bus_creds_done(&m->creds);
         return mfree(m);
 }
 
+/* How much to allocate at least for the header and its fields, once they no longer fit into the message
+ * object itself. That's enough for the path, interface, member, destination and signature of most calls. */
+#define FIELDS_ALLOCATE_MIN 256U
+
 static void *message_extend_fields(sd_bus_message *m, size_t align, size_t sz, bool add_offset) {
         void *op, *np;
         size_t old_size, new_size, start;
@@ -169,20 +211,32 @@ static void *message_extend_fields(sd_bus_message *m, size_t align, size_t sz, b
         if (old_size == new_size)
                 return (uint8_t*) m->header + old_size;
 
-        if (m->free_header) {
-                np = realloc(m->header, ALIGN8(new_size));
-                if (!np)
-                        goto poison;
-        } else {
-                /* Initially, the header is allocated as part of
-                 * the sd_bus_message itself, let's replace it by
-                 * dynamic data */
+        if (ALIGN8(new_size) <= m->header_allocated)
+                /* Still fits into what we allocated before */
+                np = m->header;
+        else {
+                size_t a;
 
-                np = malloc(ALIGN8(new_size));
-                if (!np)
-                        goto poison;
+                /* Leave room for further fields, so that we don't have to reallocate for each of them */
+                a = MAX(2 * ALIGN8(new_size), FIELDS_ALLOCATE_MIN);
+
+                if (m->free_header) {
+                        np = realloc(m->header, a);
+                        if (!np)
+                                goto poison;
+                } else {
+                        /* Initially, the header is allocated as part of
+                         * the sd_bus_message itself, let's replace it by
+                         * dynamic data */
+
+                        np = malloc(a);
+                        if (!np)
+                                goto poison;
+
+                        memcpy(np, m->header, sizeof(struct bus_header));
+                }
 
-                memcpy(np, m->header, sizeof(struct bus_header));
+                m->header_allocated = a;
         }
 
         /* Zero out padding */
@@ -2041,7 +2095,7 @@ _public_ int sd_bus_message_open_container(
 
         c = message_get_last_container(m);
 
-        signature = strdup(contents);
+        signature = message_container_signature_new(m, contents);
         if (!signature) {
                 m->poisoned = true;
                 return -ENOMEM;
@@ -2281,7 +2335,7 @@ _public_ int sd_bus_message_close_container(sd_bus_message *m) {
         else
                 assert_not_reached("Unknown container type");
 
-        free(c->signature);
+        message_container_signature_free(m, c->signature);
         free(c->offsets);
 
         return r;
@@ -4123,7 +4177,7 @@ _public_ int sd_bus_message_enter_container(sd_bus_message *m,
 
         c = message_get_last_container(m);
 
-        signature = strdup(contents);
+        signature = message_container_signature_new(m, contents);
         if (!signature)
                 return -ENOMEM;
 
@@ -95,6 +95,7 @@ struct sd_bus_message {
         size_t footer_accessible;
 
         size_t fields_size;
+        size_t header_allocated; /* if we allocated the header ourselves, how much */
         size_t body_size;
         size_t user_body_size;
 
@@ -113,6 +114,11 @@ struct sd_bus_message {
         size_t n_containers;
         size_t containers_allocated;
 
+        /* The signature buffer of the last closed container, recycled for the next one opened, so that
+         * appending or reading arrays of structs doesn't need an allocation per element */
+        char *spare_signature;
+        size_t spare_signature_size;
+
         struct iovec *iovec;
         struct iovec iovec_fixed[2];
         unsigned n_iovec;
@@ -839,6 +839,12 @@ static int property_get_all_callbacks_run(
                 if (require_fallback && !c->is_fallback)
                         continue;
 
+                /* Resolving the object might be expensive (e.g. a unit lookup), hence skip the vtables of
+                 * other interfaces right-away. They only matter for figuring out whether the object
+                 * exists at all, which we do below if needed. */
+                if (iface && !streq(c->interface, iface))
+                        continue;
+
                 r = node_vtable_get_userdata(bus, m->path, c, &u, &error);
                 if (r < 0)
                         return bus_maybe_reply_error(m, r, &error);
@@ -848,9 +854,6 @@ static int property_get_all_callbacks_run(
                         continue;
 
                 *found_object = true;
-
-                if (iface && !streq(c->interface, iface))
-                        continue;
                 found_interface = true;
 
                 r = vtable_append_all_properties(bus, reply, m->path, c, u, &error);
@@ -860,6 +863,30 @@ static int property_get_all_callbacks_run(
                         return 0;
         }
 
+        if (!*found_object && iface) {
+                /* No vtable for the requested interface, let's see if the object exists at all, so that we
+                 * can return a proper error */
+                LIST_FOREACH(vtables, c, first) {
+                        _cleanup_(sd_bus_error_free) sd_bus_error error = SD_BUS_ERROR_NULL;
+
+                        if (require_fallback && !c->is_fallback)
+                                continue;
+
+                        if (streq(c->interface, iface))
+                                continue;
+
+                        r = node_vtable_get_userdata(bus, m->path, c, NULL, &error);
+                        if (r < 0)
+                                return bus_maybe_reply_error(m, r, &error);
+                        if (bus->nodes_modified)
+                                return 0;
+                        if (r > 0) {
+                                *found_object = true;
+                                break;
+                        }
+                }
+        }
+
         if (!*found_object)
                 return 0;
 
@@ -983,7 +1010,17 @@ int introspect_path(
                 if (c->vtable[0].flags & SD_BUS_VTABLE_HIDDEN)
                         continue;
 
-                r = introspect_write_interface(&intro, c->interface, c->vtable);
+                if (!c->introspection || c->introspection_trusted != bus->trusted) {
+                        c->introspection = mfree(c->introspection);
+
+                        r = introspect_format_members(c->vtable, bus->trusted, &c->introspection);
+                        if (r < 0)
+                                return r;
+
+                        c->introspection_trusted = bus->trusted;
+                }
+
+                r = introspect_write_interface_members(&intro, c->interface, c->introspection);
                 if (r < 0)
                         return r;
         }
@@ -999,56 +999,76 @@ int bus_socket_take_fd(sd_bus *b) {
         return bus_socket_start_auth(b);
 }
 
-int bus_socket_write_message(sd_bus *bus, sd_bus_message *m, size_t *idx) {
+int bus_socket_write_messages(sd_bus *bus, sd_bus_message **m, size_t n_messages, size_t *idx) {
         struct iovec *iov;
+        size_t i, n_iovec = 0;
         ssize_t k;
-        size_t n;
         unsigned j;
         int r;
 
         assert(bus);
         assert(m);
+        assert(n_messages > 0);
         assert(idx);
         assert(IN_SET(bus->state, BUS_RUNNING, BUS_HELLO));
 
-        if (*idx >= BUS_MESSAGE_SIZE(m))
+        /* Writes the first message, and as many of the following ones as fit, with a single syscall. *idx is
+         * how much of the first message has been written before, and is increased by how much has been
+         * written now, hence may point past the first message afterwards. File descriptors are sent along
+         * with the first byte of the message they belong to, hence only the first message may carry any. */
+
+        if (*idx >= BUS_MESSAGE_SIZE(m[0]))
                 return 0;
 
-        r = bus_message_setup_iovec(m);
-        if (r < 0)
-                return r;
+        for (i = 0; i < n_messages; i++) {
+                r = bus_message_setup_iovec(m[i]);
+                if (r < 0) {
+                        if (i == 0)
+                                return r;
+
+                        break; /* Will be reported once this one is first in line */
+                }
+
+                if (i > 0 && (m[i]->n_fds > 0 || n_iovec + m[i]->n_iovec > BUS_WRITE_IOVEC_MAX))
+                        break;
 
-        n = m->n_iovec * sizeof(struct iovec);
-        iov = newa(struct iovec, n);
-        memcpy_safe(iov, m->iovec, n);
+                n_iovec += m[i]->n_iovec;
+        }
+        n_messages = i;
+
+        iov = newa(struct iovec, n_iovec);
+        for (i = 0, n_iovec = 0; i < n_messages; i++) {
+                memcpy_safe(iov + n_iovec, m[i]->iovec, m[i]->n_iovec * sizeof(struct iovec));
+                n_iovec += m[i]->n_iovec;
+        }
 
         j = 0;
         iovec_advance(iov, &j, *idx);
 
         if (bus->prefer_writev)
-                k = writev(bus->output_fd, iov, m->n_iovec);
+                k = writev(bus->output_fd, iov, n_iovec);
         else {
                 struct msghdr mh = {
                         .msg_iov = iov,
-                        .msg_iovlen = m->n_iovec,
+                        .msg_iovlen = n_iovec,
                 };
 
-                if (m->n_fds > 0 && *idx == 0) {
+                if (m[0]->n_fds > 0 && *idx == 0) {
                         struct cmsghdr *control;
 
-                        mh.msg_controllen = CMSG_SPACE(sizeof(int) * m->n_fds);
+                        mh.msg_controllen = CMSG_SPACE(sizeof(int) * m[0]->n_fds);
                         mh.msg_control = alloca0(mh.msg_controllen);
                         control = CMSG_FIRSTHDR(&mh);
-                        control->cmsg_len = CMSG_LEN(sizeof(int) * m->n_fds);
+                        control->cmsg_len = CMSG_LEN(sizeof(int) * m[0]->n_fds);
                         control->cmsg_level = SOL_SOCKET;
                         control->cmsg_type = SCM_RIGHTS;
-                        memcpy(CMSG_DATA(control), m->fds, sizeof(int) * m->n_fds);
+                        memcpy(CMSG_DATA(control), m[0]->fds, sizeof(int) * m[0]->n_fds);
                 }
 
                 k = sendmsg(bus->output_fd, &mh, MSG_DONTWAIT|MSG_NOSIGNAL);
                 if (k < 0 && errno == ENOTSOCK) {
                         bus->prefer_writev = true;
-                        k = writev(bus->output_fd, iov, m->n_iovec);
+                        k = writev(bus->output_fd, iov, n_iovec);
                 }
         }
 
@@ -1775,29 +1775,40 @@ int bus_seal_synthetic_message(sd_bus *b, sd_bus_message *m) {
         return sd_bus_message_seal(m, 0xFFFFFFFFULL, 0);
 }
 
-static int bus_write_message(sd_bus *bus, sd_bus_message *m, size_t *idx) {
+static int bus_write_messages(sd_bus *bus, sd_bus_message **m, size_t n_messages, size_t *idx) {
+        size_t i, before, end = 0;
         int r;
 
         assert(bus);
         assert(m);
+        assert(idx);
 
-        r = bus_socket_write_message(bus, m, idx);
+        before = *idx;
+
+        r = bus_socket_write_messages(bus, m, n_messages, idx);
         if (r <= 0)
                 return r;
 
-        if (*idx >= BUS_MESSAGE_SIZE(m))
+        for (i = 0; i < n_messages; i++) {
+                end += BUS_MESSAGE_SIZE(m[i]);
+                if (end > *idx)
+                        break;
+                if (end <= before)
+                        continue;
+
                 log_debug("Sent message type=%s sender=%s destination=%s path=%s interface=%s member=%s cookie=%" PRIu64 " reply_cookie=%" PRIu64 " signature=%s error-name=%s error-message=%s",
-                          bus_message_type_to_string(m->header->type),
-                          strna(sd_bus_message_get_sender(m)),
-                          strna(sd_bus_message_get_destination(m)),
-                          strna(sd_bus_message_get_path(m)),
-                          strna(sd_bus_message_get_interface(m)),
-                          strna(sd_bus_message_get_member(m)),
-                          BUS_MESSAGE_COOKIE(m),
-                          m->reply_cookie,
-                          strna(m->root_container.signature),
-                          strna(m->error.name),
-                          strna(m->error.message));
+                          bus_message_type_to_string(m[i]->header->type),
+                          strna(sd_bus_message_get_sender(m[i])),
+                          strna(sd_bus_message_get_destination(m[i])),
+                          strna(sd_bus_message_get_path(m[i])),
+                          strna(sd_bus_message_get_interface(m[i])),
+                          strna(sd_bus_message_get_member(m[i])),
+                          BUS_MESSAGE_COOKIE(m[i]),
+                          m[i]->reply_cookie,
+                          strna(m[i]->root_container.signature),
+                          strna(m[i]->error.name),
+                          strna(m[i]->error.message));
+        }
 
         return r;
 }
@@ -1809,28 +1820,33 @@ static int dispatch_wqueue(sd_bus *bus) {
         assert(IN_SET(bus->state, BUS_RUNNING, BUS_HELLO));
 
         while (bus->wqueue_size > 0) {
+                size_t n;
 
-                r = bus_write_message(bus, bus->wqueue[0], &bus->windex);
+                /* Write out as many queued messages as we can in one go */
+                r = bus_write_messages(bus, bus->wqueue, bus->wqueue_size, &bus->windex);
                 if (r < 0)
                         return r;
                 else if (r == 0)
                         /* Didn't do anything this time */
                         return ret;
-                else if (bus->windex >= BUS_MESSAGE_SIZE(bus->wqueue[0])) {
-                        /* Fully written. Let's drop the entry from
-                         * the queue.
-                         *
-                         * This isn't particularly optimized, but
-                         * well, this is supposed to be our worst-case
-                         * buffer only, and the socket buffer is
-                         * supposed to be our primary buffer, and if
-                         * it got full, then all bets are off
-                         * anyway. */
-
-                        bus->wqueue_size--;
-                        bus_message_unref_queued(bus->wqueue[0], bus);
-                        memmove(bus->wqueue, bus->wqueue + 1, sizeof(sd_bus_message*) * bus->wqueue_size);
-                        bus->windex = 0;
+
+                /* Drop all fully written entries from the queue.
+                 *
+                 * This isn't particularly optimized, but
+                 * well, this is supposed to be our worst-case
+                 * buffer only, and the socket buffer is
+                 * supposed to be our primary buffer, and if
+                 * it got full, then all bets are off
+                 * anyway. */
+
+                for (n = 0; n < bus->wqueue_size && bus->windex >= BUS_MESSAGE_SIZE(bus->wqueue[n]); n++) {
+                        bus->windex -= BUS_MESSAGE_SIZE(bus->wqueue[n]);
+                        bus_message_unref_queued(bus->wqueue[n], bus);
+                }
+
+                if (n > 0) {
+                        bus->wqueue_size -= n;
+                        memmove(bus->wqueue, bus->wqueue + n, sizeof(sd_bus_message*) * bus->wqueue_size);
 
                         ret = 1;
                 }
@@ -1940,7 +1956,7 @@ _public_ int sd_bus_send(sd_bus *bus, sd_bus_message *_m, uint64_t *cookie) {
         if (IN_SET(bus->state, BUS_RUNNING, BUS_HELLO) && bus->wqueue_size <= 0) {
                 size_t idx = 0;
 
-                r = bus_write_message(bus, m, &idx);
+                r = bus_write_messages(bus, &m, 1, &idx);
                 if (r < 0) {
                         if (ERRNO_IS_DISCONNECT(r)) {
                                 bus_enter_closing(bus);
@@ -17,6 +17,9 @@
 
 #define MAX_SIZE (2*1024*1024)
 
+/* Signals emitted at once, enough to fill up the socket buffer so that they end up in the write queue */
+#define SIGNAL_BURST 4096U
+
 static usec_t arg_loop_usec = 100 * USEC_PER_MSEC;
 
 typedef enum Type {
@@ -206,10 +209,63 @@ static void client_chart(Type type, const char *address, const char *server_name
         sd_bus_unref(b);
 }
 
+static void client_signals(Type type, const char *address, const char *server_name, int fd) {
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *x = NULL;
+        unsigned n_signals = 0;
+        sd_bus *b;
+        usec_t t;
+        int r;
+
+        r = sd_bus_new(&b);
+        assert_se(r >= 0);
+
+        if (type == TYPE_DIRECT) {
+                r = sd_bus_set_fd(b, fd, fd);
+                assert_se(r >= 0);
+        } else {
+                r = sd_bus_set_address(b, address);
+                assert_se(r >= 0);
+
+                r = sd_bus_set_bus_client(b, true);
+                assert_se(r >= 0);
+        }
+
+        r = sd_bus_start(b);
+        assert_se(r >= 0);
+
+        r = sd_bus_call_method(b, server_name, "/", "benchmark.server", "Ping", NULL, NULL, NULL);
+        assert_se(r >= 0);
+
+        /* Emits signals in bursts, like the service manager does for PropertiesChanged, and measures how
+         * many make it to the other side per second. */
+
+        t = now(CLOCK_MONOTONIC);
+        do {
+                unsigned i;
+
+                for (i = 0; i < SIGNAL_BURST; i++)
+                        assert_se(sd_bus_emit_signal(b, "/benchmark", "benchmark.server", "Changed", "u", i) >= 0);
+
+                assert_se(sd_bus_call_method(b, server_name, "/", "benchmark.server", "Ping", NULL, NULL, NULL) >= 0);
+                n_signals += SIGNAL_BURST;
+        } while (now(CLOCK_MONOTONIC) < t + arg_loop_usec);
+        t = now(CLOCK_MONOTONIC) - t;
+
+        printf("SIGNALS\tPER SECOND\n");
+        printf("%u\t%u\n", n_signals, (unsigned) ((n_signals * USEC_PER_SEC) / t));
+
+        assert_se(sd_bus_message_new_method_call(b, &x, server_name, "/", "benchmark.server", "Exit") >= 0);
+        assert_se(sd_bus_message_append(x, "t", (uint64_t) n_signals) >= 0);
+        assert_se(sd_bus_send(b, x, NULL) >= 0);
+
+        sd_bus_unref(b);
+}
+
 int main(int argc, char *argv[]) {
         enum {
                 MODE_BISECT,
                 MODE_CHART,
+                MODE_SIGNALS,
         } mode = MODE_BISECT;
         Type type = TYPE_LEGACY;
         int i, pair[2] = { -1, -1 };
@@ -226,6 +282,9 @@ int main(int argc, char *argv[]) {
                 if (streq(argv[i], "chart")) {
                         mode = MODE_CHART;
                         continue;
+                } else if (streq(argv[i], "signals")) {
+                        mode = MODE_SIGNALS;
+                        continue;
                 } else if (streq(argv[i], "legacy")) {
                         type = TYPE_LEGACY;
                         continue;
@@ -301,6 +360,10 @@ int main(int argc, char *argv[]) {
                 case MODE_CHART:
                         client_chart(type, address, server_name, pair[1]);
                         break;
+
+                case MODE_SIGNALS:
+                        client_signals(type, address, server_name, pair[1]);
+                        break;
                 }
 
                 _exit(EXIT_SUCCESS);
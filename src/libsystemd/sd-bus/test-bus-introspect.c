@@ -2,6 +2,7 @@
 
 #include "bus-introspect.h"
 #include "log.h"
+#include "string-util.h"
 #include "tests.h"
 
 #include "test-vtable-data.h"
@@ -23,6 +24,28 @@ static void test_manual_introspection(const sd_bus_vtable vtable[]) {
         fputs("\n", stdout);
 }
 
+static void test_cached_introspection(const sd_bus_vtable vtable[]) {
+        struct introspect intro = {};
+        _cleanup_free_ char *members = NULL, *s = NULL, *t = NULL;
+
+        log_info("/* %s */", __func__);
+
+        assert_se(introspect_begin(&intro, false) >= 0);
+        assert_se(introspect_write_interface(&intro, "org.foo", vtable) >= 0);
+        assert_se(introspect_write_interface(&intro, "org.foo.bar", vtable) >= 0);
+        assert_se(introspect_finish(&intro, &s) == 0);
+
+        /* The cached member data must result in identical output */
+        assert_se(introspect_format_members(vtable, false, &members) >= 0);
+
+        assert_se(introspect_begin(&intro, false) >= 0);
+        assert_se(introspect_write_interface_members(&intro, "org.foo", members) >= 0);
+        assert_se(introspect_write_interface_members(&intro, "org.foo.bar", members) >= 0);
+        assert_se(introspect_finish(&intro, &t) == 0);
+
+        assert_se(streq(s, t));
+}
+
 int main(int argc, char *argv[]) {
         test_setup_logging(LOG_DEBUG);
 
@@ -31,5 +54,9 @@ int main(int argc, char *argv[]) {
         test_manual_introspection(test_vtable_deprecated);
         test_manual_introspection((const sd_bus_vtable *) vtable_format_221);
 
+        test_cached_introspection(test_vtable_1);
+        test_cached_introspection(test_vtable_2);
+        test_cached_introspection(test_vtable_deprecated);
+
         return 0;
 }
@@ -325,6 +325,9 @@ int main(int argc, char *argv[]) {
         assert_se(r > 0);
         assert_se(sz == sizeof(integer_array));
         assert_se(memcmp(integer_array, return_array, sz) == 0);
+        /* Arrays of trivial types are returned in place, from the buffer the message was received in */
+        assert_se((uint8_t*) return_array >= (uint8_t*) buffer);
+        assert_se((uint8_t*) return_array + sz <= (uint8_t*) buffer + BUS_MESSAGE_SIZE(m));
 
         r = sd_bus_message_read_array(m, 'u', (const void**) &return_array, &sz);
         assert_se(r > 0);
@@ -1,5 +1,6 @@
 /* SPDX-License-Identifier: LGPL-2.1+ */
 
+#include "alloc-util.h"
 #include "bus-match.h"
 #include "bus-message.h"
 #include "bus-slot.h"
@@ -7,7 +8,9 @@
 #include "log.h"
 #include "macro.h"
 #include "memory-util.h"
+#include "stdio-util.h"
 #include "tests.h"
+#include "time-util.h"
 
 static bool mask[32];
 
@@ -59,6 +62,61 @@ static int match_add(sd_bus_slot *slots, struct bus_match_node *root, const char
         return r;
 }
 
+static unsigned n_hits;
+
+static int count_filter(sd_bus_message *m, void *userdata, sd_bus_error *ret_error) {
+        n_hits++;
+        return 0;
+}
+
+static void test_match_many_path_namespaces(sd_bus *bus) {
+        struct bus_match_node root = {
+                .type = BUS_MATCH_ROOT,
+        };
+
+        _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
+        _cleanup_free_ sd_bus_slot *slots = NULL;
+        char ts[FORMAT_TIMESPAN_MAX];
+        const unsigned n_matches = 10000, n_runs = 1000;
+        usec_t t;
+        unsigned i;
+
+        /* One PropertiesChanged watcher per unit, as many clients of the service manager have */
+        assert_se(slots = new0(sd_bus_slot, n_matches));
+
+        for (i = 0; i < n_matches; i++) {
+                struct bus_match_component *components = NULL;
+                unsigned n_components = 0;
+                char match[STRLEN("type='signal',interface='org.freedesktop.DBus.Properties',member='PropertiesChanged',path_namespace='/org/freedesktop/systemd1/unit/u'") + DECIMAL_STR_MAX(unsigned)];
+
+                xsprintf(match, "type='signal',interface='org.freedesktop.DBus.Properties',member='PropertiesChanged',path_namespace='/org/freedesktop/systemd1/unit/u%u'", i);
+
+                assert_se(bus_match_parse(match, &components, &n_components) >= 0);
+                slots[i].match_callback.callback = count_filter;
+                assert_se(bus_match_add(&root, components, n_components, &slots[i].match_callback) >= 0);
+                bus_match_parse_free(components, n_components);
+        }
+
+        assert_se(sd_bus_message_new_signal(bus, &m, "/org/freedesktop/systemd1/unit/u4711/job", "org.freedesktop.DBus.Properties", "PropertiesChanged") >= 0);
+        assert_se(sd_bus_message_seal(m, 1, 0) >= 0);
+
+        t = now(CLOCK_MONOTONIC);
+        for (i = 0; i < n_runs; i++)
+                assert_se(bus_match_run(NULL, &root, m) == 0);
+        t = now(CLOCK_MONOTONIC) - t;
+
+        /* Only u4711 matches, not u471 or u47110 */
+        assert_se(n_hits == n_runs);
+
+        log_info("%u path_namespace matches: %s per message", n_matches,
+                 format_timespan(ts, sizeof(ts), t / n_runs, 1));
+
+        for (i = 0; i < n_matches; i++)
+                assert_se(bus_match_remove(&root, &slots[i].match_callback) >= 0);
+
+        bus_match_free(&root);
+}
+
 static void test_match_scope(const char *match, enum bus_match_scope scope) {
         struct bus_match_component *components = NULL;
         unsigned n_components = 0;
@@ -76,7 +134,7 @@ int main(int argc, char *argv[]) {
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *m = NULL;
         _cleanup_(sd_bus_flush_close_unrefp) sd_bus *bus = NULL;
         enum bus_match_node_type i;
-        sd_bus_slot slots[19];
+        sd_bus_slot slots[22];
         int r;
 
         test_setup_logging(LOG_INFO);
@@ -105,6 +163,9 @@ int main(int argc, char *argv[]) {
         assert_se(match_add(slots, &root, "arg4has='pa'", 16) >= 0);
         assert_se(match_add(slots, &root, "arg4has='po'", 17) >= 0);
         assert_se(match_add(slots, &root, "arg4='pi'", 18) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/foo/bar'", 19) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/'", 20) >= 0);
+        assert_se(match_add(slots, &root, "path_namespace='/foo/ba'", 21) >= 0);
 
         bus_match_dump(&root, 0);
 
@@ -114,7 +175,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17 }, 11));
+        assert_se(mask_contains((unsigned[]) { 9, 8, 7, 5, 10, 12, 13, 14, 15, 16, 17, 19, 20 }, 13));
 
         assert_se(bus_match_remove(&root, &slots[8].match_callback) >= 0);
         assert_se(bus_match_remove(&root, &slots[13].match_callback) >= 0);
@@ -123,7 +184,7 @@ int main(int argc, char *argv[]) {
 
         zero(mask);
         assert_se(bus_match_run(NULL, &root, m) == 0);
-        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17 }, 9));
+        assert_se(mask_contains((unsigned[]) { 9, 5, 10, 12, 14, 7, 15, 16, 17, 19, 20 }, 11));
 
         for (i = 0; i < _BUS_MATCH_NODE_TYPE_MAX; i++) {
                 char buf[32];
@@ -137,6 +198,8 @@ int main(int argc, char *argv[]) {
 
         bus_match_free(&root);
 
+        test_match_many_path_namespaces(bus);
+
         test_match_scope("interface='foobar'", BUS_MATCH_GENERIC);
         test_match_scope("", BUS_MATCH_GENERIC);
         test_match_scope("interface='org.freedesktop.DBus.Local'", BUS_MATCH_LOCAL);
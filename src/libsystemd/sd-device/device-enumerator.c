@@ -444,6 +444,11 @@ static int enumerator_scan_dir_and_add_devices(sd_device_enumerator *enumerator,
                         continue;
                 }
 
+                /* Check this first, it only needs the syspath, while the checks below might need to read
+                 * the udev database or sysfs attributes */
+                if (!match_parent(enumerator, device))
+                        continue;
+
                 initialized = sd_device_get_is_initialized(device);
                 if (initialized < 0) {
                         if (initialized != -ENOENT)
@@ -469,9 +474,6 @@ static int enumerator_scan_dir_and_add_devices(sd_device_enumerator *enumerator,
                      sd_device_get_ifindex(device, NULL) >= 0))
                         continue;
 
-                if (!match_parent(enumerator, device))
-                        continue;
-
                 if (!match_tag(enumerator, device))
                         continue;
 
@@ -579,6 +581,10 @@ static int enumerator_scan_devices_tag(sd_device_enumerator *enumerator, const c
                         continue;
                 }
 
+                /* Cheapest check first, see enumerator_scan_dir_and_add_devices() */
+                if (!match_parent(enumerator, device))
+                        continue;
+
                 k = sd_device_get_subsystem(device, &subsystem);
                 if (k < 0) {
                         if (k != -ENOENT)
@@ -599,9 +605,6 @@ static int enumerator_scan_devices_tag(sd_device_enumerator *enumerator, const c
                 if (!match_sysname(enumerator, sysname))
                         continue;
 
-                if (!match_parent(enumerator, device))
-                        continue;
-
                 if (!match_property(enumerator, device))
                         continue;
 
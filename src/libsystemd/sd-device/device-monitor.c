@@ -47,6 +47,9 @@ struct sd_device_monitor {
 
 #define UDEV_MONITOR_MAGIC                0xfeedcafe
 
+/* How many uevents to process at most before returning to the event loop */
+#define DEVICE_MONITOR_MESSAGES_PER_WAKEUP_MAX 16U
+
 typedef struct monitor_netlink_header {
         /* "libudev" prefix to distinguish libudev and kernel messages */
         char prefix[8];
@@ -221,17 +224,38 @@ _public_ int sd_device_monitor_stop(sd_device_monitor *m) {
         return 0;
 }
 
+static int device_monitor_receive_device_full(sd_device_monitor *m, int flags, sd_device **ret);
+
 static int device_monitor_event_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
-        _cleanup_(sd_device_unrefp) sd_device *device = NULL;
+        _cleanup_(sd_device_monitor_unrefp) sd_device_monitor *ref = NULL;
         sd_device_monitor *m = userdata;
+        int r;
 
         assert(m);
 
-        if (device_monitor_receive_device(m, &device) <= 0)
-                return 0;
+        /* Process a couple of queued uevents per wakeup, so that a burst of uevents (e.g. from "udevadm
+         * trigger") doesn't cost a full event loop iteration each. The callback might stop or drop the
+         * monitor, hence keep a reference and stop as soon as the event source is gone or disabled. */
+        ref = sd_device_monitor_ref(m);
+
+        for (unsigned i = 0; i < DEVICE_MONITOR_MESSAGES_PER_WAKEUP_MAX; i++) {
+                _cleanup_(sd_device_unrefp) sd_device *device = NULL;
+
+                r = device_monitor_receive_device_full(m, MSG_DONTWAIT, &device);
+                if (IN_SET(r, -EAGAIN, -EINTR))
+                        return 0; /* Drained */
+                if (r <= 0)
+                        continue; /* Filtered out or invalid, look at the next one */
 
-        if (m->callback)
-                return m->callback(m, device, m->userdata);
+                if (m->callback) {
+                        r = m->callback(m, device, m->userdata);
+                        if (r < 0)
+                                return r;
+                }
+
+                if (!m->event_source || sd_event_source_get_enabled(m->event_source, NULL) <= 0)
+                        break;
+        }
 
         return 0;
 }
@@ -387,7 +411,7 @@ tag:
         return 0;
 }
 
-int device_monitor_receive_device(sd_device_monitor *m, sd_device **ret) {
+static int device_monitor_receive_device_full(sd_device_monitor *m, int flags, sd_device **ret) {
         _cleanup_(sd_device_unrefp) sd_device *device = NULL;
         union {
                 monitor_netlink_header nlh;
@@ -415,9 +439,9 @@ int device_monitor_receive_device(sd_device_monitor *m, sd_device **ret) {
 
         assert(ret);
 
-        buflen = recvmsg(m->sock, &smsg, 0);
+        buflen = recvmsg(m->sock, &smsg, flags);
         if (buflen < 0) {
-                if (errno != EINTR)
+                if (!IN_SET(errno, EINTR, EAGAIN))
                         log_debug_errno(errno, "sd-device-monitor: Failed to receive message: %m");
                 return -errno;
         }
@@ -498,6 +522,10 @@ int device_monitor_receive_device(sd_device_monitor *m, sd_device **ret) {
         return r;
 }
 
+int device_monitor_receive_device(sd_device_monitor *m, sd_device **ret) {
+        return device_monitor_receive_device_full(m, 0, ret);
+}
+
 static uint32_t string_hash32(const char *str) {
         return MurmurHash2(str, strlen(str), 0);
 }
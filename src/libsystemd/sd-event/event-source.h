@@ -7,6 +7,7 @@
 
 #include "sd-event.h"
 
+#include "event-util.h"
 #include "fs-util.h"
 #include "hashmap.h"
 #include "list.h"
@@ -67,6 +68,9 @@ struct sd_event_source {
         uint64_t pending_iteration;
         uint64_t prepare_iteration;
 
+        usec_t pending_timestamp;
+        EventSourceStats stats;
+
         sd_event_destroy_t destroy_callback;
 
         LIST_FIELDS(sd_event_source, sources);
@@ -2,12 +2,26 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "sd-event.h"
 
+#include "time-util.h"
+
+/* Maintained only if event loop profiling is turned on with $SD_EVENT_PROFILE_DELAYS */
+typedef struct EventSourceStats {
+        uint64_t n_dispatched;
+        usec_t dispatch_usec;      /* total time spent in the callback */
+        usec_t dispatch_usec_max;  /* longest single invocation of the callback */
+        usec_t pending_usec;       /* total time between becoming pending and being dispatched */
+} EventSourceStats;
+
 int event_reset_time(sd_event *e, sd_event_source **s,
                      clockid_t clock, uint64_t usec, uint64_t accuracy,
                      sd_event_time_handler_t callback, void *userdata,
                      int64_t priority, const char *description, bool force_reset);
 int event_source_disable(sd_event_source *s);
 int event_source_is_enabled(sd_event_source *s);
+
+int event_source_get_stats(sd_event_source *s, EventSourceStats *ret);
+void event_dump_source_stats(sd_event *e, FILE *f, const char *prefix);
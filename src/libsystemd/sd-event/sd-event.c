@@ -11,6 +11,7 @@
 #include "alloc-util.h"
 #include "env-util.h"
 #include "event-source.h"
+#include "event-util.h"
 #include "fd-util.h"
 #include "fs-util.h"
 #include "hashmap.h"
@@ -105,9 +106,14 @@ struct sd_event {
         bool need_process_child:1;
         bool watchdog:1;
         bool profile_delays:1;
+        bool poll_batch_enabled:1;
+        bool poll_batch:1;
 
         int exit_code;
 
+        /* Priority of the I/O sources we may dispatch without polling again, see event_may_skip_poll() */
+        int64_t poll_batch_priority;
+
         pid_t tid;
         sd_event **default_event_ptr;
 
@@ -122,6 +128,7 @@ struct sd_event {
 
         usec_t last_run, last_log;
         unsigned delays[sizeof(usec_t) * 8];
+        unsigned n_timer_wakeups, n_timers_elapsed;
 };
 
 static thread_local sd_event *default_event = NULL;
@@ -340,7 +347,7 @@ _public_ int sd_event_new(sd_event** ret) {
         e->epoll_fd = fd_move_above_stdio(e->epoll_fd);
 
         if (secure_getenv("SD_EVENT_PROFILE_DELAYS")) {
-                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 ... 2^63 us will be logged every 5s.");
+                log_debug("Event loop profiling enabled. Logarithmic histogram of event loop iterations in the range 2^0 ... 2^63 us, and the number of timer wakeups, will be logged every 5s.");
                 e->profile_delays = true;
         }
 
@@ -902,6 +909,9 @@ static int source_set_pending(sd_event_source *s, bool b) {
         if (b) {
                 s->pending_iteration = s->event->iteration;
 
+                if (s->event->profile_delays)
+                        s->pending_timestamp = now(CLOCK_MONOTONIC);
+
                 r = prioq_put(s->event->pending, s, &s->pending_index);
                 if (r < 0) {
                         s->pending = false;
@@ -2843,6 +2853,7 @@ static int process_timer(
                 struct clock_data *d) {
 
         sd_event_source *s;
+        unsigned k = 0;
         int r;
 
         assert(e);
@@ -2863,6 +2874,47 @@ static int process_timer(
                 prioq_reshuffle(d->earliest, s, &s->time.earliest_index);
                 prioq_reshuffle(d->latest, s, &s->time.latest_index);
                 d->needs_rearm = true;
+                k++;
+        }
+
+        return k;
+}
+
+static int process_timers(sd_event *e) {
+        unsigned k;
+        int r;
+
+        assert(e);
+
+        r = process_timer(e, e->timestamp.realtime, &e->realtime);
+        if (r < 0)
+                return r;
+        k = r;
+
+        r = process_timer(e, e->timestamp.boottime, &e->boottime);
+        if (r < 0)
+                return r;
+        k += r;
+
+        r = process_timer(e, e->timestamp.monotonic, &e->monotonic);
+        if (r < 0)
+                return r;
+        k += r;
+
+        r = process_timer(e, e->timestamp.realtime, &e->realtime_alarm);
+        if (r < 0)
+                return r;
+        k += r;
+
+        r = process_timer(e, e->timestamp.boottime, &e->boottime_alarm);
+        if (r < 0)
+                return r;
+        k += r;
+
+        /* Keep track of how well timers are coalesced, i.e. how many elapse per wakeup on average */
+        if (e->profile_delays && k > 0) {
+                e->n_timer_wakeups++;
+                e->n_timers_elapsed += k;
         }
 
         return 0;
@@ -3182,8 +3234,12 @@ static int process_inotify(sd_event *e) {
         return done;
 }
 
+/* Callbacks taking longer than this are logged when profiling */
+#define SLOW_DISPATCH_USEC (100 * USEC_PER_MSEC)
+
 static int source_dispatch(sd_event_source *s) {
         EventSourceType saved_type;
+        usec_t begin = USEC_INFINITY;
         int r = 0;
 
         assert(s);
@@ -3193,6 +3249,16 @@ static int source_dispatch(sd_event_source *s) {
          * the event. */
         saved_type = s->type;
 
+        if (s->event->profile_delays) {
+                begin = now(CLOCK_MONOTONIC);
+
+                if (s->pending && s->pending_timestamp > 0)
+                        s->stats.pending_usec += usec_sub_unsigned(begin, s->pending_timestamp);
+
+                /* Defer sources stay pending, only count the time until their first dispatch */
+                s->pending_timestamp = 0;
+        }
+
         if (!IN_SET(s->type, SOURCE_DEFER, SOURCE_EXIT)) {
                 r = source_set_pending(s, false);
                 if (r < 0)
@@ -3299,6 +3365,24 @@ static int source_dispatch(sd_event_source *s) {
 
         s->dispatching = false;
 
+        if (begin != USEC_INFINITY) {
+                usec_t d;
+
+                d = usec_sub_unsigned(now(CLOCK_MONOTONIC), begin);
+
+                s->stats.n_dispatched++;
+                s->stats.dispatch_usec += d;
+                s->stats.dispatch_usec_max = MAX(s->stats.dispatch_usec_max, d);
+
+                if (d >= SLOW_DISPATCH_USEC) {
+                        char buf[FORMAT_TIMESPAN_MAX];
+
+                        log_debug("Event source %s (type %s) took %s to dispatch.",
+                                  strna(s->description), event_source_type_to_string(saved_type),
+                                  format_timespan(buf, sizeof(buf), d, USEC_PER_MSEC));
+                }
+        }
+
         if (r < 0)
                 log_debug_errno(r, "Event source %s (type %s) returned error, disabling: %m",
                                 strna(s->description), event_source_type_to_string(saved_type));
@@ -3444,7 +3528,26 @@ static void event_close_inode_data_fds(sd_event *e) {
         }
 }
 
+static bool event_may_skip_poll(sd_event *e, sd_event_source *p) {
+        assert(e);
+
+        /* If the last poll made multiple I/O sources of the top priority pending, dispatch them one after
+         * the other without polling in between. I/O sources are no longer pending once dispatched, hence
+         * each one we find here is still left over from the last poll, and the batch ends by itself. If
+         * anything else turned up in the meantime at the same or a higher priority, let's poll again, so
+         * that priorities are still honoured. This is opt-in, see sd_event_set_poll_batch(). */
+
+        if (!e->poll_batch || !p)
+                return false;
+
+        if (e->need_process_child || e->inotify_data_buffered)
+                return false;
+
+        return p->type == SOURCE_IO && p->priority == e->poll_batch_priority;
+}
+
 _public_ int sd_event_prepare(sd_event *e) {
+        sd_event_source *p;
         int r;
 
         assert_return(e, -EINVAL);
@@ -3491,7 +3594,29 @@ _public_ int sd_event_prepare(sd_event *e) {
 
         event_close_inode_data_fds(e);
 
-        if (event_next_pending(e) || e->need_process_child)
+        p = event_next_pending(e);
+        if (event_may_skip_poll(e, p)) {
+                /* We don't poll, but time still passes: update the timestamp, so that the callbacks see
+                 * the right time, and let elapsed timers become pending, so that they preempt the batch
+                 * if they have a higher priority. The timerfds are flushed by the next real poll. */
+                triple_timestamp_get(&e->timestamp);
+
+                r = process_watchdog(e);
+                if (r < 0)
+                        return r;
+
+                r = process_timers(e);
+                if (r < 0)
+                        return r;
+
+                p = event_next_pending(e);
+                if (event_may_skip_poll(e, p)) {
+                        e->state = SD_EVENT_PENDING;
+                        return 1;
+                }
+        }
+
+        if (p || e->need_process_child)
                 goto pending;
 
         e->state = SD_EVENT_ARMED;
@@ -3508,6 +3633,7 @@ pending:
 }
 
 _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
+        sd_event_source *p;
         size_t event_queue_max;
         int r, m, i;
 
@@ -3517,6 +3643,8 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
         assert_return(e->state != SD_EVENT_FINISHED, -ESTALE);
         assert_return(e->state == SD_EVENT_ARMED, -EBUSY);
 
+        e->poll_batch = false;
+
         if (e->exit_requested) {
                 e->state = SD_EVENT_PENDING;
                 return 1;
@@ -3604,23 +3732,7 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
         if (r < 0)
                 goto finish;
 
-        r = process_timer(e, e->timestamp.realtime, &e->realtime);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.boottime, &e->boottime);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.monotonic, &e->monotonic);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.realtime, &e->realtime_alarm);
-        if (r < 0)
-                goto finish;
-
-        r = process_timer(e, e->timestamp.boottime, &e->boottime_alarm);
+        r = process_timers(e);
         if (r < 0)
                 goto finish;
 
@@ -3634,9 +3746,12 @@ _public_ int sd_event_wait(sd_event *e, uint64_t timeout) {
         if (r < 0)
                 goto finish;
 
-        if (event_next_pending(e)) {
-                e->state = SD_EVENT_PENDING;
+        p = event_next_pending(e);
+        if (p) {
+                e->poll_batch = e->poll_batch_enabled;
+                e->poll_batch_priority = p->priority;
 
+                e->state = SD_EVENT_PENDING;
                 return 1;
         }
 
@@ -3688,6 +3803,47 @@ static void event_log_delays(sd_event *e) {
                 e->delays[i] = 0;
         }
         log_debug("Event loop iterations: %s", b);
+
+        log_debug("Event loop timer wakeups: %u, elapsed timers: %u", e->n_timer_wakeups, e->n_timers_elapsed);
+        e->n_timer_wakeups = e->n_timers_elapsed = 0;
+}
+
+int event_source_get_stats(sd_event_source *s, EventSourceStats *ret) {
+        assert(s);
+        assert(ret);
+
+        if (!s->event || !s->event->profile_delays)
+                return -ENODATA;
+
+        *ret = s->stats;
+        return 0;
+}
+
+void event_dump_source_stats(sd_event *e, FILE *f, const char *prefix) {
+        sd_event_source *s;
+
+        assert(e);
+        assert(f);
+
+        if (!e->profile_delays)
+                return;
+
+        LIST_FOREACH(sources, s, e->sources) {
+                char a[FORMAT_TIMESPAN_MAX], b[FORMAT_TIMESPAN_MAX], c[FORMAT_TIMESPAN_MAX];
+
+                if (s->stats.n_dispatched == 0)
+                        continue;
+
+                fprintf(f,
+                        "%sEvent source %s (type %s): dispatched %" PRIu64 " times, total %s, max %s, pending %s\n",
+                        strempty(prefix),
+                        strna(s->description),
+                        event_source_type_to_string(s->type),
+                        s->stats.n_dispatched,
+                        format_timespan(a, sizeof(a), s->stats.dispatch_usec, 1),
+                        format_timespan(b, sizeof(b), s->stats.dispatch_usec_max, 1),
+                        format_timespan(c, sizeof(c), s->stats.pending_usec, 1));
+        }
 }
 
 _public_ int sd_event_run(sd_event *e, uint64_t timeout) {
@@ -3922,6 +4078,26 @@ _public_ int sd_event_get_watchdog(sd_event *e) {
         return e->watchdog;
 }
 
+_public_ int sd_event_set_poll_batch(sd_event *e, int b) {
+        assert_return(e, -EINVAL);
+        assert_return(e = event_resolve(e), -ENOPKG);
+        assert_return(!event_pid_changed(e), -ECHILD);
+
+        e->poll_batch_enabled = b;
+        if (!b)
+                e->poll_batch = false;
+
+        return 0;
+}
+
+_public_ int sd_event_get_poll_batch(sd_event *e) {
+        assert_return(e, -EINVAL);
+        assert_return(e = event_resolve(e), -ENOPKG);
+        assert_return(!event_pid_changed(e), -ECHILD);
+
+        return e->poll_batch_enabled;
+}
+
 _public_ int sd_event_get_iteration(sd_event *e, uint64_t *ret) {
         assert_return(e, -EINVAL);
         assert_return(e = event_resolve(e), -ENOPKG);
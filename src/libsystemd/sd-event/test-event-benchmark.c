@@ -0,0 +1,252 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "sd-event.h"
+
+#include "alloc-util.h"
+#include "fd-util.h"
+#include "log.h"
+#include "macro.h"
+#include "parse-util.h"
+#include "signal-util.h"
+#include "stdio-util.h"
+#include "string-util.h"
+#include "tests.h"
+#include "time-util.h"
+
+/* Children that are alive at the same time in the child benchmark */
+#define CHILDREN_IN_FLIGHT 8U
+
+static usec_t arg_duration = USEC_PER_SEC;
+static unsigned arg_n_sources = 1000;
+
+static uint64_t n_dispatched;
+
+static void run_loop(sd_event *e, const char *name, unsigned n_sources, uint64_t timeout) {
+        char buf[FORMAT_TIMESPAN_MAX];
+        usec_t begin, end, n;
+        uint64_t i;
+
+        n_dispatched = 0;
+
+        n = begin = now(CLOCK_MONOTONIC);
+        end = usec_add(begin, arg_duration);
+
+        for (i = 0;; i++) {
+                /* Don't read the clock on every iteration, that would dominate the measurement */
+                if (i % 64 == 0) {
+                        n = now(CLOCK_MONOTONIC);
+                        if (n >= end)
+                                break;
+                }
+
+                assert_se(sd_event_run(e, timeout) >= 0);
+        }
+
+        log_info("%-24s %6u sources: %9" PRIu64 " dispatches in %s, %" PRIu64 " ns/dispatch, %" PRIu64 " ns/iteration",
+                 name, n_sources, n_dispatched,
+                 format_timespan(buf, sizeof(buf), n - begin, USEC_PER_MSEC),
+                 n_dispatched > 0 ? (n - begin) * NSEC_PER_USEC / n_dispatched : 0,
+                 i > 0 ? (n - begin) * NSEC_PER_USEC / i : 0);
+}
+
+static int io_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        n_dispatched++;
+
+        /* Keep the pipe readable, so that the source is dispatched again in the next iteration */
+        return 0;
+}
+
+static void benchmark_io(unsigned n_sources) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_free_ sd_event_source **sources = NULL;
+        _cleanup_free_ int *fds = NULL;
+        unsigned i;
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        assert_se(sources = new0(sd_event_source*, n_sources));
+        assert_se(fds = new(int, n_sources * 2));
+
+        for (i = 0; i < n_sources; i++) {
+                assert_se(pipe2(fds + i*2, O_CLOEXEC|O_NONBLOCK) >= 0);
+                assert_se(write(fds[i*2+1], "x", 1) == 1);
+                assert_se(sd_event_add_io(e, sources + i, fds[i*2], EPOLLIN, io_handler, NULL) >= 0);
+        }
+
+        run_loop(e, "io", n_sources, 0);
+
+        for (i = 0; i < n_sources; i++) {
+                sd_event_source_unref(sources[i]);
+                safe_close_pair(fds + i*2);
+        }
+}
+
+static int time_handler(sd_event_source *s, uint64_t usec, void *userdata) {
+        n_dispatched++;
+
+        /* Rearm, so that the timer elapses again right-away, which exercises the timer prioqs and the
+         * timerfd rearming logic */
+        assert_se(sd_event_source_set_time(s, now(CLOCK_MONOTONIC)) >= 0);
+        assert_se(sd_event_source_set_enabled(s, SD_EVENT_ONESHOT) >= 0);
+
+        return 0;
+}
+
+static void benchmark_time(unsigned n_sources, usec_t accuracy) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_free_ sd_event_source **sources = NULL;
+        char buf[FORMAT_TIMESPAN_MAX], name[64];
+        usec_t n;
+        unsigned i;
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        assert_se(sources = new0(sd_event_source*, n_sources));
+
+        n = now(CLOCK_MONOTONIC);
+        for (i = 0; i < n_sources; i++)
+                assert_se(sd_event_add_time(e, sources + i, CLOCK_MONOTONIC, n + i, accuracy, time_handler, NULL) >= 0);
+
+        xsprintf(name, "time (accuracy %s)", format_timespan(buf, sizeof(buf), accuracy, 1));
+        run_loop(e, name, n_sources, 0);
+
+        for (i = 0; i < n_sources; i++)
+                sd_event_source_unref(sources[i]);
+}
+
+static int defer_handler(sd_event_source *s, void *userdata) {
+        n_dispatched++;
+        return 0;
+}
+
+static void benchmark_defer(unsigned n_sources) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_free_ sd_event_source **sources = NULL;
+        unsigned i;
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        assert_se(sources = new0(sd_event_source*, n_sources));
+
+        for (i = 0; i < n_sources; i++) {
+                assert_se(sd_event_add_defer(e, sources + i, defer_handler, NULL) >= 0);
+                assert_se(sd_event_source_set_enabled(sources[i], SD_EVENT_ON) >= 0);
+        }
+
+        run_loop(e, "defer", n_sources, 0);
+
+        for (i = 0; i < n_sources; i++)
+                sd_event_source_unref(sources[i]);
+}
+
+static void benchmark_post(unsigned n_sources) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        _cleanup_free_ sd_event_source **sources = NULL;
+        _cleanup_(sd_event_source_unrefp) sd_event_source *d = NULL;
+        unsigned i;
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        /* One defer source that is always pending, which makes all post sources pending when dispatched */
+        assert_se(sd_event_add_defer(e, &d, defer_handler, NULL) >= 0);
+        assert_se(sd_event_source_set_enabled(d, SD_EVENT_ON) >= 0);
+
+        assert_se(sources = new0(sd_event_source*, n_sources));
+
+        for (i = 0; i < n_sources; i++) {
+                assert_se(sd_event_add_post(e, sources + i, defer_handler, NULL) >= 0);
+                assert_se(sd_event_source_set_enabled(sources[i], SD_EVENT_ON) >= 0);
+        }
+
+        run_loop(e, "post", n_sources, 0);
+
+        for (i = 0; i < n_sources; i++)
+                sd_event_source_unref(sources[i]);
+}
+
+static void child_fork(sd_event *e);
+
+static int child_handler(sd_event_source *s, const siginfo_t *si, void *userdata) {
+        sd_event *e = userdata;
+
+        n_dispatched++;
+
+        /* The source is owned by the event loop, take it over to get rid of it */
+        assert_se(sd_event_source_set_floating(s, false) >= 0);
+        sd_event_source_unref(s);
+
+        /* Replace the child that just died */
+        child_fork(e);
+
+        return 0;
+}
+
+static void child_fork(sd_event *e) {
+        pid_t pid;
+
+        pid = fork();
+        assert_se(pid >= 0);
+        if (pid == 0)
+                _exit(EXIT_SUCCESS);
+
+        assert_se(sd_event_add_child(e, NULL, pid, WEXITED, child_handler, e) >= 0);
+}
+
+static void benchmark_child(bool with_pidfd) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        unsigned i;
+
+        assert_se(setenv("SYSTEMD_PIDFD", yes_no(with_pidfd), 1) >= 0);
+
+        assert_se(sd_event_new(&e) >= 0);
+
+        for (i = 0; i < CHILDREN_IN_FLIGHT; i++)
+                child_fork(e);
+
+        run_loop(e, with_pidfd ? "child (pidfd)" : "child (SIGCHLD)", CHILDREN_IN_FLIGHT, UINT64_MAX);
+
+        /* Reap the children still left, their event sources go away with the event loop */
+        while (waitpid(-1, NULL, 0) >= 0)
+                ;
+
+        assert_se(unsetenv("SYSTEMD_PIDFD") >= 0);
+}
+
+int main(int argc, char *argv[]) {
+        test_setup_logging(LOG_INFO);
+
+        /* Invoke as "test-event-benchmark [DURATION [SOURCES]]" to change how long each benchmark runs, and
+         * with how many sources, for example "test-event-benchmark 5s 10000". */
+
+        if (argc > 1)
+                assert_se(parse_sec(argv[1], &arg_duration) >= 0);
+        if (argc > 2)
+                assert_se(safe_atou(argv[2], &arg_n_sources) >= 0);
+
+        assert_se(arg_duration > 0);
+        assert_se(arg_n_sources > 0);
+
+        assert_se(sigprocmask_many(SIG_BLOCK, NULL, SIGCHLD, -1) >= 0);
+
+        benchmark_io(1);
+        benchmark_io(arg_n_sources);
+
+        benchmark_time(1, 1);
+        benchmark_time(arg_n_sources, 1);
+        benchmark_time(arg_n_sources, USEC_PER_MSEC);
+        benchmark_time(arg_n_sources, 0); /* default accuracy */
+
+        benchmark_defer(1);
+        benchmark_defer(arg_n_sources);
+
+        benchmark_post(arg_n_sources);
+
+        benchmark_child(true);
+        benchmark_child(false);
+
+        return 0;
+}
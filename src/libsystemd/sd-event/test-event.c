@@ -5,6 +5,7 @@
 #include "sd-event.h"
 
 #include "alloc-util.h"
+#include "event-util.h"
 #include "fd-util.h"
 #include "fs-util.h"
 #include "log.h"
@@ -326,6 +327,120 @@ static void test_sd_event_now(void) {
         assert_se(sd_event_now(e, 900 /* arbitrary big number */, &event_now) == -EOPNOTSUPP);
 }
 
+static int stats_handler(sd_event_source *s, void *userdata) {
+        return sd_event_exit(sd_event_source_get_event(s), 0);
+}
+
+static void test_source_stats(void) {
+        _cleanup_(sd_event_source_unrefp) sd_event_source *s = NULL;
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        EventSourceStats stats;
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(sd_event_add_defer(e, &s, stats_handler, NULL) >= 0);
+        assert_se(event_source_get_stats(s, &stats) == -ENODATA);
+        e = sd_event_unref(e);
+        s = sd_event_source_unref(s);
+
+        assert_se(setenv("SD_EVENT_PROFILE_DELAYS", "1", 1) >= 0);
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(sd_event_add_defer(e, &s, stats_handler, NULL) >= 0);
+        assert_se(event_source_get_stats(s, &stats) >= 0);
+        assert_se(stats.n_dispatched == 0);
+
+        assert_se(sd_event_loop(e) >= 0);
+
+        assert_se(event_source_get_stats(s, &stats) >= 0);
+        assert_se(stats.n_dispatched == 1);
+        assert_se(stats.dispatch_usec_max <= stats.dispatch_usec);
+
+        assert_se(unsetenv("SD_EVENT_PROFILE_DELAYS") >= 0);
+}
+
+static unsigned n_batch_io = 0, n_batch_io_at_timer = 0, n_batch_io_at_high = 0;
+static sd_event_source *batch_timer = NULL;
+
+static int batch_timer_handler(sd_event_source *s, uint64_t usec, void *userdata) {
+        n_batch_io_at_timer = n_batch_io;
+        return 0;
+}
+
+static int batch_high_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        char c;
+
+        assert_se(read(fd, &c, 1) == 1);
+        n_batch_io_at_high = n_batch_io;
+
+        return 0;
+}
+
+static int batch_io_handler(sd_event_source *s, int fd, uint32_t revents, void *userdata) {
+        int *high_fd = userdata;
+        char c;
+
+        assert_se(read(fd, &c, 1) == 1);
+
+        switch (n_batch_io++) {
+
+        case 0:
+                /* The higher priority source becomes ready, but we only notice that when we poll again */
+                assert_se(write(*high_fd, "x", 1) == 1);
+                break;
+
+        case 1:
+                /* The timer elapses right away. Elapsed timers are processed even without polling, hence
+                 * it preempts the rest of the batch. */
+                assert_se(sd_event_add_time_relative(sd_event_source_get_event(s), &batch_timer, CLOCK_MONOTONIC, 0, 1, batch_timer_handler, NULL) >= 0);
+                assert_se(sd_event_source_set_priority(batch_timer, -1) >= 0);
+                break;
+        }
+
+        return 0;
+}
+
+static void test_poll_batch(bool batch) {
+        _cleanup_(sd_event_unrefp) sd_event *e = NULL;
+        sd_event_source *s[3] = {}, *high = NULL;
+        int p[3][2], h[2];
+
+        log_info("/* %s(%s) */", __func__, yes_no(batch));
+
+        n_batch_io = n_batch_io_at_timer = n_batch_io_at_high = 0;
+
+        assert_se(sd_event_new(&e) >= 0);
+        assert_se(sd_event_get_poll_batch(e) == 0);
+        assert_se(sd_event_set_poll_batch(e, batch) >= 0);
+        assert_se(sd_event_get_poll_batch(e) == batch);
+
+        assert_se(pipe2(h, O_CLOEXEC|O_NONBLOCK) >= 0);
+        assert_se(sd_event_add_io(e, &high, h[0], EPOLLIN, batch_high_handler, NULL) >= 0);
+        assert_se(sd_event_source_set_priority(high, -1) >= 0);
+
+        for (size_t i = 0; i < ELEMENTSOF(s); i++) {
+                assert_se(pipe2(p[i], O_CLOEXEC|O_NONBLOCK) >= 0);
+                assert_se(write(p[i][1], "x", 1) == 1);
+                assert_se(sd_event_add_io(e, &s[i], p[i][0], EPOLLIN, batch_io_handler, &h[1]) >= 0);
+        }
+
+        while (n_batch_io < ELEMENTSOF(s))
+                assert_se(sd_event_run(e, (uint64_t) -1) >= 0);
+
+        /* Without batching we poll after each dispatch, and the higher priority source is dispatched right
+         * after it became ready. With batching the second source of the batch is dispatched first, and only
+         * the timer makes us poll again. */
+        assert_se(n_batch_io_at_high == (batch ? 2 : 1));
+        assert_se(n_batch_io_at_timer == 2);
+
+        batch_timer = sd_event_source_unref(batch_timer);
+        sd_event_source_unref(high);
+        safe_close_pair(h);
+        for (size_t i = 0; i < ELEMENTSOF(s); i++) {
+                sd_event_source_unref(s[i]);
+                safe_close_pair(p[i]);
+        }
+}
+
 static int last_rtqueue_sigval = 0;
 static int n_rtqueue = 0;
 
@@ -597,6 +712,9 @@ int main(int argc, char *argv[]) {
         test_basic(false);  /* test without pidfd */
 
         test_sd_event_now();
+        test_source_stats();
+        test_poll_batch(false);
+        test_poll_batch(true);
         test_rtqueue();
 
         test_inotify(100); /* should work without overflow */
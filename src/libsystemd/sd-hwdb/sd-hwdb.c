@@ -35,6 +35,9 @@ struct sd_hwdb {
         OrderedHashmap *properties;
         Iterator properties_iterator;
         bool properties_modified;
+
+        /* The modalias the current properties were looked up for */
+        char *properties_modalias;
 };
 
 struct linebuf {
@@ -367,6 +370,7 @@ static sd_hwdb *hwdb_free(sd_hwdb *hwdb) {
                 munmap((void *)hwdb->map, hwdb->st.st_size);
         safe_fclose(hwdb->f);
         ordered_hashmap_free(hwdb->properties);
+        free(hwdb->properties_modalias);
         return mfree(hwdb);
 }
 
@@ -397,13 +401,29 @@ bool hwdb_validate(sd_hwdb *hwdb) {
 }
 
 static int properties_prepare(sd_hwdb *hwdb, const char *modalias) {
+        int r;
+
         assert(hwdb);
         assert(modalias);
 
+        /* Callers frequently ask for more than one key of the same modalias in a row, let's not search the
+         * trie again in that case. */
+        if (streq_ptr(hwdb->properties_modalias, modalias)) {
+                hwdb->properties_modified = true;
+                return 0;
+        }
+
+        hwdb->properties_modalias = mfree(hwdb->properties_modalias);
         ordered_hashmap_clear(hwdb->properties);
         hwdb->properties_modified = true;
 
-        return trie_search_f(hwdb, modalias);
+        r = trie_search_f(hwdb, modalias);
+        if (r < 0)
+                return r;
+
+        /* If this fails we just won't be able to skip the search next time */
+        hwdb->properties_modalias = strdup(modalias);
+        return 0;
 }
 
 _public_ int sd_hwdb_get(sd_hwdb *hwdb, const char *modalias, const char *key, const char **_value) {
@@ -17,6 +17,9 @@
 #include "string-util.h"
 #include "util.h"
 
+/* How many messages to process at most before returning to the event loop */
+#define NETLINK_MESSAGES_PER_WAKEUP_MAX 16U
+
 static int sd_netlink_new(sd_netlink **ret) {
         _cleanup_(sd_netlink_unrefp) sd_netlink *rtnl = NULL;
 
@@ -710,9 +713,20 @@ static int io_callback(sd_event_source *s, int fd, uint32_t revents, void *userd
 
         assert(rtnl);
 
-        r = sd_netlink_process(rtnl, NULL);
-        if (r < 0)
-                return r;
+        /* A single read from the socket usually returns many messages, e.g. the replies to a batch of
+         * requests sent with sd_netlink_call_async(), or a dump. Dispatch several of them per wakeup,
+         * instead of paying an event loop iteration for each. The callbacks might drop the last reference to
+         * us, hence keep one while we loop. */
+
+        NETLINK_DONT_DESTROY(rtnl);
+
+        for (unsigned i = 0; i < NETLINK_MESSAGES_PER_WAKEUP_MAX; i++) {
+                r = sd_netlink_process(rtnl, NULL);
+                if (r < 0)
+                        return r;
+                if (r == 0)
+                        break;
+        }
 
         return 1;
 }
@@ -364,6 +364,62 @@ static int image_flush_cache(sd_event_source *s, void *userdata) {
         return 0;
 }
 
+static int image_cache_arm(Manager *m) {
+        int r;
+
+        assert(m);
+
+        /* The cache is only valid for the current event loop iteration, it's flushed as soon as we are idle
+         * again, so that we pick up changes made to the image directories behind our back. */
+
+        r = hashmap_ensure_allocated(&m->image_cache, &image_hash_ops);
+        if (r < 0)
+                return r;
+
+        if (!m->image_cache_defer_event) {
+                r = sd_event_add_defer(m->event, &m->image_cache_defer_event, image_flush_cache, m);
+                if (r < 0)
+                        return r;
+
+                r = sd_event_source_set_priority(m->image_cache_defer_event, SD_EVENT_PRIORITY_IDLE);
+                if (r < 0)
+                        return r;
+        }
+
+        return sd_event_source_set_enabled(m->image_cache_defer_event, SD_EVENT_ONESHOT);
+}
+
+int image_cache_add(Manager *m, Hashmap *images) {
+        Image *image;
+        int r;
+
+        assert(m);
+
+        /* Stores freshly discovered images in the cache, so that the object lookups which usually follow an
+         * enumeration don't have to look for each image, stat it and query its quota all over again. */
+
+        if (hashmap_isempty(images))
+                return 0;
+
+        r = image_cache_arm(m);
+        if (r < 0)
+                return r;
+
+        HASHMAP_FOREACH(image, images) {
+                if (hashmap_contains(m->image_cache, image->name))
+                        continue;
+
+                r = hashmap_put(m->image_cache, image->name, image);
+                if (r < 0)
+                        return r;
+
+                image_ref(image);
+                image->userdata = m;
+        }
+
+        return 0;
+}
+
 static int image_object_find(sd_bus *bus, const char *path, const char *interface, void *userdata, void **found, sd_bus_error *error) {
         _cleanup_free_ char *e = NULL;
         Manager *m = userdata;
@@ -390,21 +446,7 @@ static int image_object_find(sd_bus *bus, const char *path, const char *interfac
                 return 1;
         }
 
-        r = hashmap_ensure_allocated(&m->image_cache, &image_hash_ops);
-        if (r < 0)
-                return r;
-
-        if (!m->image_cache_defer_event) {
-                r = sd_event_add_defer(m->event, &m->image_cache_defer_event, image_flush_cache, m);
-                if (r < 0)
-                        return r;
-
-                r = sd_event_source_set_priority(m->image_cache_defer_event, SD_EVENT_PRIORITY_IDLE);
-                if (r < 0)
-                        return r;
-        }
-
-        r = sd_event_source_set_enabled(m->image_cache_defer_event, SD_EVENT_ONESHOT);
+        r = image_cache_arm(m);
         if (r < 0)
                 return r;
 
@@ -441,12 +483,14 @@ char *image_bus_path(const char *name) {
 static int image_node_enumerator(sd_bus *bus, const char *path, void *userdata, char ***nodes, sd_bus_error *error) {
         _cleanup_hashmap_free_ Hashmap *images = NULL;
         _cleanup_strv_free_ char **l = NULL;
+        Manager *m = userdata;
         Image *image;
         int r;
 
         assert(bus);
         assert(path);
         assert(nodes);
+        assert(m);
 
         images = hashmap_new(&image_hash_ops);
         if (!images)
@@ -456,6 +500,10 @@ static int image_node_enumerator(sd_bus *bus, const char *path, void *userdata,
         if (r < 0)
                 return r;
 
+        r = image_cache_add(m, images);
+        if (r < 0)
+                log_debug_errno(r, "Failed to cache discovered images, ignoring: %m");
+
         HASHMAP_FOREACH(image, images) {
                 char *p;
 
@@ -471,7 +471,7 @@ static int method_get_machine_os_release(sd_bus_message *message, void *userdata
 static int method_list_images(sd_bus_message *message, void *userdata, sd_bus_error *error) {
         _cleanup_(sd_bus_message_unrefp) sd_bus_message *reply = NULL;
         _cleanup_hashmap_free_ Hashmap *images = NULL;
-        _unused_ Manager *m = userdata;
+        Manager *m = userdata;
         Image *image;
         int r;
 
@@ -486,6 +486,10 @@ static int method_list_images(sd_bus_message *message, void *userdata, sd_bus_er
         if (r < 0)
                 return r;
 
+        r = image_cache_add(m, images);
+        if (r < 0)
+                log_debug_errno(r, "Failed to cache discovered images, ignoring: %m");
+
         r = sd_bus_message_new_method_return(message, &reply);
         if (r < 0)
                 return r;
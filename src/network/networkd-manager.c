@@ -341,6 +341,12 @@ int manager_rtnl_process_route(sd_netlink *rtnl, sd_netlink_message *message, vo
                 return 0;
         }
 
+        /* If we neither track foreign routes nor configured any route on this link, there's nothing the
+         * message could match, hence don't bother parsing it. With full routing tables in the kernel this
+         * is the vast majority of all route messages. */
+        if (!m->manage_foreign_routes && set_isempty(link->routes) && set_isempty(link->routes_foreign))
+                return 0;
+
         r = route_new(&tmp);
         if (r < 0)
                 return log_oom();
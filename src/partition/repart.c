@@ -2556,7 +2556,10 @@ static int context_copy_blocks(Context *context) {
 
                 log_info("Copying in '%s' (%s) on block level into future partition %" PRIu64 ".", p->copy_blocks_path, format_bytes(buf, sizeof(buf), p->copy_blocks_size), p->partno);
 
-                r = copy_bytes_full(p->copy_blocks_fd, target_fd, p->copy_blocks_size, 0, NULL, NULL, NULL, NULL);
+                /* When building an image file on a file system that supports reflinks, and the source lives
+                 * on the same file system, the data doesn't have to be copied at all. If that's not possible
+                 * copy_bytes_full() falls back to copy_file_range() and friends. */
+                r = copy_bytes_full(p->copy_blocks_fd, target_fd, p->copy_blocks_size, p->encrypt ? 0 : COPY_REFLINK, NULL, NULL, NULL, NULL);
                 if (r < 0)
                         return log_error_errno(r, "Failed to copy in data from '%s': %m", p->copy_blocks_path);
 
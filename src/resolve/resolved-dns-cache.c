@@ -15,6 +15,9 @@
  * leave DNS caches unbounded, but that's crazy. */
 #define CACHE_MAX 4096
 
+/* How many recently used entries to spare at most per make-space run */
+#define CACHE_SECOND_CHANCE_MAX 16U
+
 /* We never keep any item longer than 2h in our cache */
 #define CACHE_TTL_MAX_USEC (2 * USEC_PER_HOUR)
 
@@ -41,6 +44,7 @@ struct DnsCacheItem {
         usec_t until;
         bool authenticated:1;
         bool shared_owner:1;
+        bool used:1; /* looked up since it was added, or last spared from eviction */
 
         int ifindex;
         int owner_family;
@@ -155,6 +159,10 @@ void dns_cache_flush(DnsCache *c) {
 }
 
 static void dns_cache_make_space(DnsCache *c, unsigned add) {
+        DnsCacheItem *spared[CACHE_SECOND_CHANCE_MAX];
+        size_t n_spared = 0;
+        usec_t t = 0;
+
         assert(c);
 
         if (add <= 0)
@@ -163,7 +171,12 @@ static void dns_cache_make_space(DnsCache *c, unsigned add) {
         /* Makes space for n new entries. Note that we actually allow
          * the cache to grow beyond CACHE_MAX, but only when we shall
          * add more RRs to the cache than CACHE_MAX at once. In that
-         * case the cache will be emptied completely otherwise. */
+         * case the cache will be emptied completely otherwise.
+         *
+         * Entries are evicted in the order they expire, except that a few entries that have been looked up
+         * since they were added get a second chance, so that a flood of one-off lookups doesn't push out
+         * the records that are actually used. Those are taken out of the prioq while we evict, and put back
+         * at the end. */
 
         for (;;) {
                 _cleanup_(dns_resource_key_unrefp) DnsResourceKey *key = NULL;
@@ -172,17 +185,43 @@ static void dns_cache_make_space(DnsCache *c, unsigned add) {
                 if (prioq_size(c->by_expiry) <= 0)
                         break;
 
-                if (prioq_size(c->by_expiry) + add < CACHE_MAX)
+                if (prioq_size(c->by_expiry) + n_spared + add < CACHE_MAX)
                         break;
 
                 i = prioq_peek(c->by_expiry);
                 assert(i);
 
+                if (i->used && n_spared < ELEMENTSOF(spared)) {
+                        if (t <= 0)
+                                t = now(clock_boottime_or_monotonic());
+
+                        if (i->until > t) {
+                                i->used = false;
+
+                                assert_se(prioq_pop(c->by_expiry) == i);
+                                i->prioq_idx = PRIOQ_IDX_NULL;
+                                spared[n_spared++] = i;
+                                continue;
+                        }
+                }
+
                 /* Take an extra reference to the key so that it
                  * doesn't go away in the middle of the remove call */
                 key = dns_resource_key_ref(i->key);
+
+                /* All entries of the key are removed, including spared ones, hence forget about those */
+                for (size_t k = 0; k < n_spared;)
+                        if (dns_resource_key_equal(spared[k]->key, key) > 0)
+                                spared[k] = spared[--n_spared];
+                        else
+                                k++;
+
                 dns_cache_remove_by_key(c, key);
         }
+
+        for (size_t k = 0; k < n_spared; k++)
+                if (prioq_put(c->by_expiry, spared[k], &spared[k]->prioq_idx) < 0)
+                        dns_cache_item_unlink_and_free(c, spared[k]);
 }
 
 void dns_cache_prune(DnsCache *c) {
@@ -872,6 +911,8 @@ int dns_cache_lookup(DnsCache *c, DnsResourceKey *key, bool clamp_ttl, int *rcod
         }
 
         LIST_FOREACH(by_key, j, first) {
+                j->used = true;
+
                 if (j->rr) {
                         if (j->rr->key->type == DNS_TYPE_NSEC)
                                 nsec = j;
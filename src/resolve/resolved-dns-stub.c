@@ -15,6 +15,9 @@
  * IP and UDP header sizes */
 #define ADVERTISE_DATAGRAM_SIZE_MAX (65536U-14U-20U-8U)
 
+/* How many UDP queries to read from a stub socket at most before returning to the event loop */
+#define STUB_PACKETS_PER_WAKEUP_MAX 16U
+
 static int manager_dns_stub_fd_extra(Manager *m, DnsStubListenerExtra *l, int type);
 
 static void dns_stub_listener_extra_hash_func(const DnsStubListenerExtra *a, struct siphash *state) {
@@ -448,19 +451,29 @@ static void dns_stub_process_query(Manager *m, DnsStubListenerExtra *l, DnsStrea
 }
 
 static int on_dns_stub_packet_internal(sd_event_source *s, int fd, uint32_t revents, Manager *m, DnsStubListenerExtra *l) {
-        _cleanup_(dns_packet_unrefp) DnsPacket *p = NULL;
         int r;
 
-        r = manager_recv(m, fd, DNS_PROTOCOL_DNS, &p);
-        if (r <= 0)
-                return r;
+        /* Process a couple of queued queries per wakeup, so that we don't need one poll for each query
+         * when we are busy */
+        for (unsigned i = 0; i < STUB_PACKETS_PER_WAKEUP_MAX; i++) {
+                _cleanup_(dns_packet_unrefp) DnsPacket *p = NULL;
 
-        if (dns_packet_validate_query(p) > 0) {
-                log_debug("Got DNS stub UDP query packet for id %u", DNS_PACKET_ID(p));
+                r = manager_recv(m, fd, DNS_PROTOCOL_DNS, &p);
+                /* The socket is non-blocking. Once the queue is drained, or if the kernel dropped the
+                 * datagram we were woken up for, we get EAGAIN. Don't return that, as sd-event would
+                 * disable the event source then. */
+                if (IN_SET(r, -EAGAIN, -EINTR))
+                        return 0;
+                if (r <= 0)
+                        return r;
 
-                dns_stub_process_query(m, l, NULL, p);
-        } else
-                log_debug("Invalid DNS stub UDP packet, ignoring.");
+                if (dns_packet_validate_query(p) > 0) {
+                        log_debug("Got DNS stub UDP query packet for id %u", DNS_PACKET_ID(p));
+
+                        dns_stub_process_query(m, l, NULL, p);
+                } else
+                        log_debug("Invalid DNS stub UDP packet, ignoring.");
+        }
 
         return 0;
 }
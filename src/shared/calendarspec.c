@@ -1193,21 +1193,36 @@ static int tm_within_bounds(struct tm *tm, bool utc) {
                     t.tm_sec  == tm->tm_sec;
         if (!good)
                 *tm = t;
+        else {
+                /* Keep the fields derived from the date up-to-date, see matches_weekday() */
+                tm->tm_wday = t.tm_wday;
+                tm->tm_yday = t.tm_yday;
+        }
         return good;
 }
 
-static bool matches_weekday(int weekdays_bits, const struct tm *tm, bool utc) {
-        struct tm t;
+static int tm_within_bounds_if_changed(struct tm *tm, bool utc, int dst, int changed) {
+        assert(tm);
+
+        /* Like tm_within_bounds(), but skips the expensive normalization if find_matching_component()
+         * didn't change anything, since find_next() keeps the time normalized otherwise. That doesn't
+         * hold if a DST flag was explicitly specified, as normalization might move the time then. */
+
+        if (changed == 0 && dst < 0)
+                return tm->tm_year + 1900 > MAX_YEAR ? -ERANGE : 1;
+
+        return tm_within_bounds(tm, utc);
+}
+
+static bool matches_weekday(int weekdays_bits, const struct tm *tm) {
         int k;
 
+        /* Note that find_next() makes sure tm_wday is up-to-date when we get here */
+
         if (weekdays_bits < 0 || weekdays_bits >= BITS_WEEKDAYS)
                 return true;
 
-        t = *tm;
-        if (mktime_or_timegm(&t, utc) < 0)
-                return false;
-
-        k = t.tm_wday == 0 ? 6 : t.tm_wday - 1;
+        k = tm->tm_wday == 0 ? 6 : tm->tm_wday - 1;
         return (weekdays_bits & (1 << k));
 }
 
@@ -1240,7 +1255,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 }
                 if (r < 0)
                         return r;
-                if (tm_within_bounds(&c, spec->utc) <= 0)
+                if (tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r) <= 0)
                         return -ENOENT;
 
                 c.tm_mon += 1;
@@ -1251,7 +1266,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                         c.tm_mday = 1;
                         c.tm_hour = c.tm_min = c.tm_sec = tm_usec = 0;
                 }
-                if (r < 0 || (r = tm_within_bounds(&c, spec->utc)) < 0) {
+                if (r < 0 || (r = tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r)) < 0) {
                         c.tm_year++;
                         c.tm_mon = 0;
                         c.tm_mday = 1;
@@ -1264,7 +1279,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 r = find_matching_component(spec, spec->day, &c, &c.tm_mday);
                 if (r > 0)
                         c.tm_hour = c.tm_min = c.tm_sec = tm_usec = 0;
-                if (r < 0 || (r = tm_within_bounds(&c, spec->utc)) < 0) {
+                if (r < 0 || (r = tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r)) < 0) {
                         c.tm_mon++;
                         c.tm_mday = 1;
                         c.tm_hour = c.tm_min = c.tm_sec = tm_usec = 0;
@@ -1273,7 +1288,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 if (r == 0)
                         continue;
 
-                if (!matches_weekday(spec->weekdays_bits, &c, spec->utc)) {
+                if (!matches_weekday(spec->weekdays_bits, &c)) {
                         c.tm_mday++;
                         c.tm_hour = c.tm_min = c.tm_sec = tm_usec = 0;
                         continue;
@@ -1282,7 +1297,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 r = find_matching_component(spec, spec->hour, &c, &c.tm_hour);
                 if (r > 0)
                         c.tm_min = c.tm_sec = tm_usec = 0;
-                if (r < 0 || (r = tm_within_bounds(&c, spec->utc)) < 0) {
+                if (r < 0 || (r = tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r)) < 0) {
                         c.tm_mday++;
                         c.tm_hour = c.tm_min = c.tm_sec = tm_usec = 0;
                         continue;
@@ -1296,7 +1311,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 r = find_matching_component(spec, spec->minute, &c, &c.tm_min);
                 if (r > 0)
                         c.tm_sec = tm_usec = 0;
-                if (r < 0 || (r = tm_within_bounds(&c, spec->utc)) < 0) {
+                if (r < 0 || (r = tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r)) < 0) {
                         c.tm_hour++;
                         c.tm_min = c.tm_sec = tm_usec = 0;
                         continue;
@@ -1309,7 +1324,7 @@ static int find_next(const CalendarSpec *spec, struct tm *tm, usec_t *usec) {
                 tm_usec = c.tm_sec % USEC_PER_SEC;
                 c.tm_sec /= USEC_PER_SEC;
 
-                if (r < 0 || (r = tm_within_bounds(&c, spec->utc)) < 0) {
+                if (r < 0 || (r = tm_within_bounds_if_changed(&c, spec->utc, spec->dst, r)) < 0) {
                         c.tm_min++;
                         c.tm_sec = tm_usec = 0;
                         continue;
@@ -85,10 +85,17 @@ int config_item_perf_lookup(
         assert(data);
 
         if (section) {
-                const char *key;
+                size_t n_section, n_lvalue;
+                char *key;
 
-                key = strjoina(section, ".", lvalue);
-                p = lookup(key, strlen(key));
+                /* The gperf tables are keyed by "Section.Key", assemble that on the stack, and pass the
+                 * length we know already, instead of letting the lookup calculate it again */
+                n_section = strlen(section);
+                n_lvalue = strlen(lvalue);
+                key = newa(char, n_section + 1 + n_lvalue + 1);
+                memcpy(mempcpy(mempcpy(key, section, n_section), ".", 1), lvalue, n_lvalue + 1);
+
+                p = lookup(key, n_section + 1 + n_lvalue);
         } else
                 p = lookup(lvalue, strlen(lvalue));
         if (!p)
@@ -272,15 +279,18 @@ int config_parse(const char *unit,
         assert(lookup);
 
         if (!f) {
-                f = ours = fopen(filename, "re");
-                if (!f) {
+                /* We read the file character by character, hence avoid taking the stream lock for each */
+                r = fopen_unlocked(filename, "re", &ours);
+                if (r < 0) {
                         /* Only log on request, except for ENOENT,
                          * since we return 0 to the caller. */
-                        if ((flags & CONFIG_PARSE_WARN) || errno == ENOENT)
-                                log_full_errno(errno == ENOENT ? LOG_DEBUG : LOG_ERR, errno,
+                        if ((flags & CONFIG_PARSE_WARN) || r == -ENOENT)
+                                log_full_errno(r == -ENOENT ? LOG_DEBUG : LOG_ERR, r,
                                                "Failed to open configuration file '%s': %m", filename);
-                        return errno == ENOENT ? 0 : -errno;
+                        return r == -ENOENT ? 0 : r;
                 }
+
+                f = ours;
         }
 
         fd = fileno(f);
@@ -1538,6 +1538,16 @@ static int verity_partition(
         if (r != 0 && FLAGS_SET(flags, DISSECT_IMAGE_VERITY_SHARE))
                 return verity_partition(m, v, verity, flags & ~DISSECT_IMAGE_VERITY_SHARE, d);
 
+        /* dm-verity exposes the data partition unmodified, hence the file system type is the one we already
+         * probed on the underlying partition. Don't probe again, reading the superblock through the verity
+         * device would only cause the hash tree to be walked for nothing. If the type is not known, leave it
+         * unset, so that dissected_image_decrypt() probes the verity device. */
+        if (!m->decrypted_fstype && m->fstype) {
+                m->decrypted_fstype = strdup(m->fstype);
+                if (!m->decrypted_fstype)
+                        return -ENOMEM;
+        }
+
         /* Everything looks good and we'll be able to mount the device, so deferred remove will be re-enabled at that point. */
         restore_deferred_remove = mfree(restore_deferred_remove);
 
@@ -3,7 +3,9 @@
 #include <dirent.h>
 #include <errno.h>
 #include <sys/prctl.h>
+#include <sys/resource.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <stdio.h>
 
@@ -72,6 +74,31 @@ static int do_spawn(const char *path, char *argv[], int stdout_fd, pid_t *pid) {
         return 1;
 }
 
+static void log_execution_time(const char *path, usec_t start, struct rusage *last) {
+        char a[FORMAT_TIMESPAN_MAX], b[FORMAT_TIMESPAN_MAX], c[FORMAT_TIMESPAN_MAX];
+        struct rusage ru;
+
+        assert(path);
+        assert(last);
+
+        /* We are the only one reaping children of the executor process, hence the difference in resource
+         * usage of our waited-for children since the last call is what the binary just reaped used. */
+
+        if (!DEBUG_LOGGING)
+                return;
+
+        if (getrusage(RUSAGE_CHILDREN, &ru) < 0)
+                return;
+
+        log_debug("%s finished after %s (%s user, %s system CPU time).",
+                  path,
+                  format_timespan(a, sizeof(a), usec_sub_unsigned(now(CLOCK_MONOTONIC), start), USEC_PER_MSEC),
+                  format_timespan(b, sizeof(b), usec_sub_unsigned(timeval_load(&ru.ru_utime), timeval_load(&last->ru_utime)), USEC_PER_MSEC),
+                  format_timespan(c, sizeof(c), usec_sub_unsigned(timeval_load(&ru.ru_stime), timeval_load(&last->ru_stime)), USEC_PER_MSEC));
+
+        *last = ru;
+}
+
 static int do_execute(
                 char **directories,
                 usec_t timeout,
@@ -84,7 +111,9 @@ static int do_execute(
 
         _cleanup_hashmap_free_free_ Hashmap *pids = NULL;
         _cleanup_strv_free_ char **paths = NULL;
+        struct rusage ru = {};
         char **path, **e;
+        usec_t start;
         int r;
         bool parallel_execution;
 
@@ -116,9 +145,12 @@ static int do_execute(
                 if (putenv(*e) != 0)
                         return log_error_errno(errno, "Failed to set environment variable: %m");
 
+        start = now(CLOCK_MONOTONIC);
+
         STRV_FOREACH(path, paths) {
                 _cleanup_free_ char *t = NULL;
                 _cleanup_close_ int fd = -1;
+                usec_t spawned;
                 pid_t pid;
 
                 t = strdup(*path);
@@ -131,6 +163,8 @@ static int do_execute(
                                 return log_error_errno(fd, "Failed to open serialization file: %m");
                 }
 
+                spawned = now(CLOCK_MONOTONIC);
+
                 r = do_spawn(t, argv, fd, &pid);
                 if (r <= 0)
                         continue;
@@ -142,6 +176,7 @@ static int do_execute(
                         t = NULL;
                 } else {
                         r = wait_for_terminate_and_check(t, pid, WAIT_LOG);
+                        log_execution_time(t, spawned, &ru);
                         if (FLAGS_SET(flags, EXEC_DIR_IGNORE_ERRORS)) {
                                 if (r < 0)
                                         continue;
@@ -168,15 +203,23 @@ static int do_execute(
 
         while (!hashmap_isempty(pids)) {
                 _cleanup_free_ char *t = NULL;
+                siginfo_t si = {};
                 pid_t pid;
 
-                pid = PTR_TO_PID(hashmap_first_key(pids));
+                /* Pick up the binaries in the order they finish, so that the execution time we log is
+                 * accurate. All our children are in the hashmap, but let's be careful anyway. */
+                if (waitid(P_ALL, 0, &si, WEXITED|WNOWAIT) >= 0 &&
+                    hashmap_contains(pids, PID_TO_PTR(si.si_pid)))
+                        pid = si.si_pid;
+                else
+                        pid = PTR_TO_PID(hashmap_first_key(pids));
                 assert(pid > 0);
 
                 t = hashmap_remove(pids, PID_TO_PTR(pid));
                 assert(t);
 
                 r = wait_for_terminate_and_check(t, pid, WAIT_LOG);
+                log_execution_time(t, start, &ru);
                 if (!FLAGS_SET(flags, EXEC_DIR_IGNORE_ERRORS) && r > 0)
                         return r;
         }
@@ -219,6 +219,10 @@ static int process_special_field(JournalImporter *imp, char *line) {
 
         assert(line);
 
+        /* All the fields we care about here are trusted ones */
+        if (line[0] != '_')
+                return 0;
+
         value = startswith(line, "__CURSOR=");
         if (value)
                 /* ignore __CURSOR */
@@ -1489,6 +1489,12 @@ static int print_source(FILE *f, JsonVariant *v, JsonFormatFlags flags, bool whi
         return 0;
 }
 
+/* All characters that json_format_string() needs to escape */
+static const char json_string_escape_chars[] =
+        "\"\\"
+        "\001\002\003\004\005\006\007\010\011\012\013\014\015\016\017"
+        "\020\021\022\023\024\025\026\027\030\031\032\033\034\035\036\037";
+
 static void json_format_string(FILE *f, const char *q, JsonFormatFlags flags) {
         assert(q);
 
@@ -1497,7 +1503,18 @@ static void json_format_string(FILE *f, const char *q, JsonFormatFlags flags) {
         if (flags & JSON_FORMAT_COLOR)
                 fputs(ANSI_GREEN, f);
 
-        for (; *q; q++)
+        for (; *q; q++) {
+                size_t n;
+
+                /* Write out runs of characters that need no escaping in one go */
+                n = strcspn(q, json_string_escape_chars);
+                if (n > 0) {
+                        fwrite(q, 1, n, f);
+                        q += n;
+                        if (*q == 0)
+                                break;
+                }
+
                 switch (*q) {
                 case '"':
                         fputs("\\\"", f);
@@ -1534,6 +1551,7 @@ static void json_format_string(FILE *f, const char *q, JsonFormatFlags flags) {
                                 fputc(*q, f);
                         break;
                 }
+        }
 
         if (flags & JSON_FORMAT_COLOR)
                 fputs(ANSI_NORMAL, f);
@@ -2492,9 +2510,17 @@ static int json_parse_string(const char **p, char **ret) {
                         continue;
                 }
 
-                len = utf8_encoded_valid_unichar(c, (size_t) -1);
-                if (len < 0)
-                        return len;
+                /* Copy runs of plain ASCII characters in one go, they need neither unescaping nor UTF-8
+                 * validation. That's the bulk of most strings. */
+                len = 0;
+                while ((uint8_t) c[len] >= ' ' && (uint8_t) c[len] < 0x7f && !IN_SET(c[len], '"', '\\'))
+                        len++;
+
+                if (len == 0) {
+                        len = utf8_encoded_valid_unichar(c, (size_t) -1);
+                        if (len < 0)
+                                return len;
+                }
 
                 if (!GREEDY_REALLOC(s, allocated, n + len + 1))
                         return -ENOMEM;
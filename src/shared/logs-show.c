@@ -1103,7 +1103,9 @@ static int output_json(
         r = 0;
 
 finish:
-        while ((d = hashmap_steal_first(h))) {
+        /* Release the entries while iterating rather than stealing them one by one, since the hashmap is
+         * freed right after anyway, and each hashmap_steal_first() would scan for the first entry again. */
+        HASHMAP_FOREACH(d, h) {
                 size_t k;
 
                 json_variant_unref(d->name);
@@ -1609,7 +1611,7 @@ int add_match_this_boot(sd_journal *j, const char *machine) {
         return 0;
 }
 
-int show_journal_by_unit(
+int show_journal_by_unit_full(
                 FILE *f,
                 const char *unit,
                 const char *log_namespace,
@@ -1621,21 +1623,41 @@ int show_journal_by_unit(
                 OutputFlags flags,
                 int journal_open_flags,
                 bool system_unit,
-                bool *ellipsized) {
+                bool *ellipsized,
+                sd_journal **cached_journal) {
 
-        _cleanup_(sd_journal_closep) sd_journal *j = NULL;
+        _cleanup_(sd_journal_closep) sd_journal *opened = NULL;
+        sd_journal *j;
         int r;
 
         assert(mode >= 0);
         assert(mode < _OUTPUT_MODE_MAX);
         assert(unit);
 
+        /* If cached_journal is non-NULL, the journal opened here is returned in it, and reused on the next
+         * call, instead of opening (and mapping) all journal files again for each unit. The caller must
+         * only pass the same cache for calls with the same namespace and open flags. */
+
         if (how_many <= 0)
                 return 0;
 
-        r = sd_journal_open_namespace(&j, log_namespace, journal_open_flags | SD_JOURNAL_INCLUDE_DEFAULT_NAMESPACE);
-        if (r < 0)
-                return log_error_errno(r, "Failed to open journal: %m");
+        if (cached_journal && *cached_journal) {
+                j = *cached_journal;
+
+                sd_journal_flush_matches(j);
+
+                r = sd_journal_seek_head(j);
+                if (r < 0)
+                        return log_error_errno(r, "Failed to seek to head: %m");
+        } else {
+                r = sd_journal_open_namespace(&opened, log_namespace, journal_open_flags | SD_JOURNAL_INCLUDE_DEFAULT_NAMESPACE);
+                if (r < 0)
+                        return log_error_errno(r, "Failed to open journal: %m");
+
+                j = opened;
+                if (cached_journal)
+                        *cached_journal = TAKE_PTR(opened);
+        }
 
         r = add_match_this_boot(j, NULL);
         if (r < 0)
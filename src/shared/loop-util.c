@@ -95,6 +95,12 @@ static int loop_configure(int fd, const struct loop_config *c) {
                 goto fail;
         }
 
+        /* LOOP_SET_STATUS64 ignores LO_FLAGS_DIRECT_IO, it has to be turned on separately. This is
+         * purely an optimization, hence don't fail if the backing file system doesn't support it. */
+        if (FLAGS_SET(c->info.lo_flags, LO_FLAGS_DIRECT_IO))
+                if (ioctl(fd, LOOP_SET_DIRECT_IO, 1UL) < 0)
+                        log_debug_errno(errno, "Failed to enable direct IO mode on loopback device, ignoring: %m");
+
         return 0;
 
 fail:
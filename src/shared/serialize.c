@@ -131,6 +131,22 @@ int serialize_strv(FILE *f, const char *key, char **l) {
         return ret;
 }
 
+int read_serialization_line(FILE *f, char **ret) {
+        int r;
+
+        assert(f);
+        assert(ret);
+
+        /* The serialization is stored in a memfd or a regular file, never on a TTY. Let's say so, so that
+         * read_line() doesn't have to check with isatty() for every single line. */
+
+        r = read_line_full(f, LONG_LINE_MAX, READ_LINE_NOT_A_TTY, ret);
+        if (r < 0)
+                return log_error_errno(r, "Failed to read serialization line: %m");
+
+        return r;
+}
+
 int deserialize_usec(const char *value, usec_t *ret) {
         int r;
 
@@ -267,10 +267,24 @@ int unit_file_build_name_map(
         /* The timestamp hash is now set based on the mtimes from before when we start reading files.
          * If anything is modified concurrently, we'll consider the cache outdated. */
 
+        /* The previous maps are usually a good estimate of how large the new ones will be, hence size
+         * the new ones right away instead of growing them step by step while filling them. */
+        ids = hashmap_new(&string_hash_ops_free_free);
+        if (!ids)
+                return log_oom();
+
+        r = hashmap_reserve(ids, hashmap_size(*unit_ids_map));
+        if (r < 0)
+                return log_oom();
+
         if (path_cache) {
                 paths = set_new(&path_hash_ops_free);
                 if (!paths)
                         return log_oom();
+
+                r = set_reserve(paths, set_size(*path_cache));
+                if (r < 0)
+                        return log_oom();
         }
 
         STRV_FOREACH(dir, (char**) lp->search_path) {
@@ -1241,27 +1241,20 @@ static int varlink_enqueue_json(Varlink *v, JsonVariant *m) {
                 v->output_buffer_size = v->output_buffer_allocated = r + 1;
                 v->output_buffer_index = 0;
 
-        } else if (v->output_buffer_index == 0) {
+        } else {
+                /* Move what's left of the partially written buffer to the front, and append to it in
+                 * place, so that the allocation is reused instead of replaced by an exactly sized one,
+                 * which would have to be grown again right away on the next message. */
+                if (v->output_buffer_index > 0) {
+                        memmove(v->output_buffer, v->output_buffer + v->output_buffer_index, v->output_buffer_size);
+                        v->output_buffer_index = 0;
+                }
 
                 if (!GREEDY_REALLOC(v->output_buffer, v->output_buffer_allocated, v->output_buffer_size + r + 1))
                         return -ENOMEM;
 
                 memcpy(v->output_buffer + v->output_buffer_size, text, r + 1);
                 v->output_buffer_size += r + 1;
-
-        } else {
-                char *n;
-                const size_t new_size = v->output_buffer_size + r + 1;
-
-                n = new(char, new_size);
-                if (!n)
-                        return -ENOMEM;
-
-                memcpy(mempcpy(n, v->output_buffer + v->output_buffer_index, v->output_buffer_size), text, r + 1);
-
-                free_and_replace(v->output_buffer, n);
-                v->output_buffer_allocated = v->output_buffer_size = new_size;
-                v->output_buffer_index = 0;
         }
 
         return 0;
@@ -420,19 +420,34 @@ static bool nonunmountable_path(const char *path) {
                 || path_startswith(path, "/run/initramfs");
 }
 
-static int remount_with_timeout(MountPoint *m, int umount_log_level) {
+/* How many remount/umount child processes to run at the same time */
+#define UMOUNT_JOBS_MAX 16U
+
+typedef enum UmountJobState {
+        UMOUNT_JOB_PENDING,
+        UMOUNT_JOB_REMOUNTING,
+        UMOUNT_JOB_UNMOUNTING,
+        UMOUNT_JOB_DONE,
+} UmountJobState;
+
+typedef struct UmountJob {
+        MountPoint *mount_point;
+        UmountJobState state;
         pid_t pid;
-        int r;
+        usec_t until;
+} UmountJob;
 
-        BLOCK_SIGNALS(SIGCHLD);
+static int remount_fork(MountPoint *m, int umount_log_level, pid_t *ret_pid) {
+        int r;
 
         assert(m);
+        assert(ret_pid);
 
         /* Due to the possibility of a remount operation hanging, we
          * fork a child process and set a timeout. If the timeout
          * lapses, the assumption is that that particular remount
          * failed. */
-        r = safe_fork("(sd-remount)", FORK_RESET_SIGNALS|FORK_CLOSE_ALL_FDS|FORK_LOG|FORK_REOPEN_LOG, &pid);
+        r = safe_fork("(sd-remount)", FORK_RESET_SIGNALS|FORK_CLOSE_ALL_FDS|FORK_LOG|FORK_REOPEN_LOG, ret_pid);
         if (r < 0)
                 return r;
         if (r == 0) {
@@ -446,31 +461,20 @@ static int remount_with_timeout(MountPoint *m, int umount_log_level) {
                 _exit(r < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
         }
 
-        r = wait_for_terminate_with_timeout(pid, DEFAULT_TIMEOUT_USEC);
-        if (r == -ETIMEDOUT) {
-                log_error_errno(r, "Remounting '%s' timed out, issuing SIGKILL to PID " PID_FMT ".", m->path, pid);
-                (void) kill(pid, SIGKILL);
-        } else if (r == -EPROTO)
-                log_debug_errno(r, "Remounting '%s' failed abnormally, child process " PID_FMT " aborted or exited non-zero.", m->path, pid);
-        else if (r < 0)
-                log_error_errno(r, "Remounting '%s' failed unexpectedly, couldn't wait for child process " PID_FMT ": %m", m->path, pid);
-
-        return r;
+        return 0;
 }
 
-static int umount_with_timeout(MountPoint *m, int umount_log_level) {
-        pid_t pid;
+static int umount_fork(MountPoint *m, int umount_log_level, pid_t *ret_pid) {
         int r;
 
-        BLOCK_SIGNALS(SIGCHLD);
-
         assert(m);
+        assert(ret_pid);
 
         /* Due to the possibility of a umount operation hanging, we
          * fork a child process and set a timeout. If the timeout
          * lapses, the assumption is that that particular umount
          * failed. */
-        r = safe_fork("(sd-umount)", FORK_RESET_SIGNALS|FORK_CLOSE_ALL_FDS|FORK_LOG|FORK_REOPEN_LOG, &pid);
+        r = safe_fork("(sd-umount)", FORK_RESET_SIGNALS|FORK_CLOSE_ALL_FDS|FORK_LOG|FORK_REOPEN_LOG, ret_pid);
         if (r < 0)
                 return r;
         if (r == 0) {
@@ -490,28 +494,41 @@ static int umount_with_timeout(MountPoint *m, int umount_log_level) {
                 _exit(r < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
         }
 
-        r = wait_for_terminate_with_timeout(pid, DEFAULT_TIMEOUT_USEC);
-        if (r == -ETIMEDOUT) {
-                log_error_errno(r, "Unmounting '%s' timed out, issuing SIGKILL to PID " PID_FMT ".", m->path, pid);
-                (void) kill(pid, SIGKILL);
-        } else if (r == -EPROTO)
-                log_debug_errno(r, "Unmounting '%s' failed abnormally, child process " PID_FMT " aborted or exited non-zero.", m->path, pid);
-        else if (r < 0)
-                log_error_errno(r, "Unmounting '%s' failed unexpectedly, couldn't wait for child process " PID_FMT ": %m", m->path, pid);
+        return 0;
+}
 
-        return r;
+static bool umount_job_ready(const UmountJob *jobs, size_t i) {
+        assert(jobs);
+
+        /* The jobs are ordered newest mount first. A mount may only be touched once all newer mounts
+         * below it, above it or stacked on top of it are done with, exactly like when processing the
+         * list one by one. Independent subtrees are hence processed concurrently. */
+        for (size_t j = 0; j < i; j++) {
+                if (jobs[j].state == UMOUNT_JOB_DONE)
+                        continue;
+
+                if (path_startswith(jobs[j].mount_point->path, jobs[i].mount_point->path) ||
+                    path_startswith(jobs[i].mount_point->path, jobs[j].mount_point->path))
+                        return false;
+        }
+
+        return true;
 }
 
-/* This includes remounting readonly, which changes the kernel mount options.  Therefore the list passed to
- * this function is invalidated, and should not be reused. */
-static int mount_points_list_umount(MountPoint **head, bool *changed, int umount_log_level) {
+static void umount_job_next(UmountJob *job, int r, bool *changed, int *n_failed, int umount_log_level) {
         MountPoint *m;
-        int n_failed = 0;
 
-        assert(head);
+        assert(job);
         assert(changed);
+        assert(n_failed);
+
+        /* Called whenever the job's previous step finished with result r, moves on to the next step */
 
-        LIST_FOREACH(mount_point, m, *head) {
+        m = job->mount_point;
+
+        switch (job->state) {
+
+        case UMOUNT_JOB_PENDING:
                 if (m->try_remount_ro) {
                         /* We always try to remount directories read-only first, before we go on and umount
                          * them.
@@ -525,26 +542,180 @@ static int mount_points_list_umount(MountPoint **head, bool *changed, int umount
                          *
                          * Since the remount can hang in the instance of remote filesystems, we remount
                          * asynchronously and skip the subsequent umount if it fails. */
-                        if (remount_with_timeout(m, umount_log_level) < 0) {
-                                /* Remount failed, but try unmounting anyway,
-                                 * unless this is a mount point we want to skip. */
-                                if (nonunmountable_path(m->path)) {
-                                        n_failed++;
-                                        continue;
-                                }
+                        job->state = UMOUNT_JOB_REMOUNTING;
+                        r = remount_fork(m, umount_log_level, &job->pid);
+                        if (r >= 0) {
+                                job->until = usec_add(now(CLOCK_MONOTONIC), DEFAULT_TIMEOUT_USEC);
+                                return;
+                        }
+
+                        /* Remount failed, but try unmounting anyway,
+                         * unless this is a mount point we want to skip. */
+                        if (nonunmountable_path(m->path)) {
+                                (*n_failed)++;
+                                job->state = UMOUNT_JOB_DONE;
+                                return;
                         }
                 }
+                break;
 
-                /* Skip / and /usr since we cannot unmount that anyway, since we are running from it. They
-                 * have already been remounted ro. */
-                if (nonunmountable_path(m->path))
-                        continue;
+        case UMOUNT_JOB_REMOUNTING:
+                if (r < 0 && nonunmountable_path(m->path)) {
+                        (*n_failed)++;
+                        job->state = UMOUNT_JOB_DONE;
+                        return;
+                }
+                break;
 
-                /* Trying to umount */
-                if (umount_with_timeout(m, umount_log_level) < 0)
-                        n_failed++;
+        case UMOUNT_JOB_UNMOUNTING:
+                if (r < 0)
+                        (*n_failed)++;
                 else
                         *changed = true;
+
+                job->state = UMOUNT_JOB_DONE;
+                return;
+
+        default:
+                assert_not_reached("Unexpected umount job state");
+        }
+
+        /* Skip / and /usr since we cannot unmount that anyway, since we are running from it. They
+         * have already been remounted ro. */
+        if (nonunmountable_path(m->path)) {
+                job->state = UMOUNT_JOB_DONE;
+                return;
+        }
+
+        /* Trying to umount */
+        job->state = UMOUNT_JOB_UNMOUNTING;
+        r = umount_fork(m, umount_log_level, &job->pid);
+        if (r < 0) {
+                (*n_failed)++;
+                job->state = UMOUNT_JOB_DONE;
+                return;
+        }
+
+        job->until = usec_add(now(CLOCK_MONOTONIC), DEFAULT_TIMEOUT_USEC);
+}
+
+static int umount_job_reap(UmountJob *job, usec_t n) {
+        const char *what;
+        siginfo_t status = {};
+
+        assert(job);
+        assert(IN_SET(job->state, UMOUNT_JOB_REMOUNTING, UMOUNT_JOB_UNMOUNTING));
+
+        /* Returns -EAGAIN if the child is still running and hasn't timed out yet, and the result of the
+         * operation otherwise. */
+
+        what = job->state == UMOUNT_JOB_REMOUNTING ? "Remounting" : "Unmounting";
+
+        if (waitid(P_PID, job->pid, &status, WEXITED|WNOHANG) < 0) {
+                int r = -errno;
+
+                log_error_errno(r, "%s '%s' failed unexpectedly, couldn't wait for child process " PID_FMT ": %m",
+                                what, job->mount_point->path, job->pid);
+                return r;
+        }
+
+        if (status.si_pid == job->pid) {
+                if (status.si_code == CLD_EXITED && status.si_status == 0)
+                        return 0;
+
+                log_debug("%s '%s' failed abnormally, child process " PID_FMT " aborted or exited non-zero.",
+                          what, job->mount_point->path, job->pid);
+                return -EPROTO;
+        }
+
+        if (n < job->until)
+                return -EAGAIN;
+
+        log_error("%s '%s' timed out, issuing SIGKILL to PID " PID_FMT ".", what, job->mount_point->path, job->pid);
+        (void) kill(job->pid, SIGKILL);
+        return -ETIMEDOUT;
+}
+
+/* This includes remounting readonly, which changes the kernel mount options.  Therefore the list passed to
+ * this function is invalidated, and should not be reused. */
+static int mount_points_list_umount(MountPoint **head, bool *changed, int umount_log_level) {
+        _cleanup_free_ UmountJob *jobs = NULL;
+        size_t n_jobs = 0, n_running = 0;
+        int n_failed = 0;
+        MountPoint *m;
+        sigset_t mask;
+
+        assert(head);
+        assert(changed);
+
+        BLOCK_SIGNALS(SIGCHLD);
+
+        LIST_FOREACH(mount_point, m, *head)
+                n_jobs++;
+
+        if (n_jobs == 0)
+                return 0;
+
+        jobs = new(UmountJob, n_jobs);
+        if (!jobs)
+                return log_oom();
+
+        n_jobs = 0;
+        LIST_FOREACH(mount_point, m, *head)
+                jobs[n_jobs++] = (UmountJob) {
+                        .mount_point = m,
+                        .state = UMOUNT_JOB_PENDING,
+                };
+
+        assert_se(sigemptyset(&mask) == 0);
+        assert_se(sigaddset(&mask, SIGCHLD) == 0);
+
+        for (;;) {
+                usec_t n, until = USEC_INFINITY;
+                struct timespec ts;
+
+                /* Start as many of the jobs that don't depend on any other unfinished ones as we may */
+                for (size_t i = 0; i < n_jobs && n_running < UMOUNT_JOBS_MAX; i++) {
+                        if (jobs[i].state != UMOUNT_JOB_PENDING)
+                                continue;
+                        if (!umount_job_ready(jobs, i))
+                                continue;
+
+                        umount_job_next(jobs + i, 0, changed, &n_failed, umount_log_level);
+                        if (jobs[i].state != UMOUNT_JOB_DONE)
+                                n_running++;
+                }
+
+                /* The oldest pending job only depends on running or finished ones, hence if nothing is
+                 * running anymore, everything is done. */
+                if (n_running == 0)
+                        break;
+
+                for (size_t i = 0; i < n_jobs; i++)
+                        if (IN_SET(jobs[i].state, UMOUNT_JOB_REMOUNTING, UMOUNT_JOB_UNMOUNTING))
+                                until = MIN(until, jobs[i].until);
+
+                n = now(CLOCK_MONOTONIC);
+                if (until > n &&
+                    sigtimedwait(&mask, NULL, timespec_store(&ts, until - n)) < 0 &&
+                    !IN_SET(errno, EAGAIN, EINTR))
+                        return log_error_errno(errno, "Failed to wait for umount child processes: %m");
+
+                n = now(CLOCK_MONOTONIC);
+                for (size_t i = 0; i < n_jobs; i++) {
+                        int r;
+
+                        if (!IN_SET(jobs[i].state, UMOUNT_JOB_REMOUNTING, UMOUNT_JOB_UNMOUNTING))
+                                continue;
+
+                        r = umount_job_reap(jobs + i, n);
+                        if (r == -EAGAIN)
+                                continue;
+
+                        umount_job_next(jobs + i, r, changed, &n_failed, umount_log_level);
+                        if (jobs[i].state == UMOUNT_JOB_DONE)
+                                n_running--;
+                }
         }
 
         return n_failed;
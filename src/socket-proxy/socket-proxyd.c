@@ -29,6 +29,14 @@
 
 #define BUFFER_SIZE (256 * 1024)
 
+/* How many empty pipes of closed connections to keep around for reuse */
+#define PIPE_POOL_MAX 16
+
+typedef struct PipePair {
+        int fds[2];
+        size_t size;
+} PipePair;
+
 static unsigned arg_connections_max = 256;
 static const char *arg_remote_host = NULL;
 static usec_t arg_exit_idle_time = USEC_INFINITY;
@@ -40,6 +48,9 @@ typedef struct Context {
 
         Set *listen;
         Set *connections;
+
+        PipePair pipe_pool[PIPE_POOL_MAX];
+        size_t n_pipe_pool;
 } Context;
 
 typedef struct Connection {
@@ -57,6 +68,28 @@ typedef struct Connection {
         sd_resolve_query *resolve_query;
 } Connection;
 
+static void connection_release_pipe(Connection *c, int buffer[static 2], size_t full, size_t sz) {
+        Context *context = c->context;
+
+        assert(c);
+        assert(buffer);
+
+        /* Pipes that were drained completely can be handed to the next connection, which saves setting
+         * up a new one with the enlarged buffer size. Anything else is closed. */
+
+        if (buffer[0] >= 0 && full == 0 && context && context->n_pipe_pool < PIPE_POOL_MAX) {
+                context->pipe_pool[context->n_pipe_pool++] = (PipePair) {
+                        .fds = { buffer[0], buffer[1] },
+                        .size = sz,
+                };
+
+                buffer[0] = buffer[1] = -1;
+                return;
+        }
+
+        safe_close_pair(buffer);
+}
+
 static void connection_free(Connection *c) {
         assert(c);
 
@@ -69,8 +102,8 @@ static void connection_free(Connection *c) {
         safe_close(c->server_fd);
         safe_close(c->client_fd);
 
-        safe_close_pair(c->server_to_client_buffer);
-        safe_close_pair(c->client_to_server_buffer);
+        connection_release_pipe(c, c->server_to_client_buffer, c->server_to_client_buffer_full, c->server_to_client_buffer_size);
+        connection_release_pipe(c, c->client_to_server_buffer, c->client_to_server_buffer_full, c->client_to_server_buffer_size);
 
         sd_resolve_query_unref(c->resolve_query);
 
@@ -127,6 +160,10 @@ static void context_clear(Context *context) {
         set_free_with_destructor(context->listen, sd_event_source_unref);
         set_free_with_destructor(context->connections, connection_free);
 
+        for (size_t i = 0; i < context->n_pipe_pool; i++)
+                safe_close_pair(context->pipe_pool[i].fds);
+        context->n_pipe_pool = 0;
+
         sd_event_unref(context->event);
         sd_resolve_unref(context->resolve);
         sd_event_source_unref(context->idle_time);
@@ -142,6 +179,15 @@ static int connection_create_pipes(Connection *c, int buffer[static 2], size_t *
         if (buffer[0] >= 0)
                 return 0;
 
+        if (c->context->n_pipe_pool > 0) {
+                PipePair *p = c->context->pipe_pool + --c->context->n_pipe_pool;
+
+                buffer[0] = p->fds[0];
+                buffer[1] = p->fds[1];
+                *sz = p->size;
+                return 0;
+        }
+
         r = pipe2(buffer, O_CLOEXEC|O_NONBLOCK);
         if (r < 0)
                 return log_error_errno(errno, "Failed to allocate pipe buffer: %m");
@@ -176,6 +176,7 @@ static TimestampStyle arg_timestamp_style = TIMESTAMP_PRETTY;
 /* This is a global cache that will be constructed on first use. */
 static Hashmap *cached_id_map = NULL;
 static Hashmap *cached_name_map = NULL;
+static sd_journal *cached_journal = NULL;
 
 STATIC_DESTRUCTOR_REGISTER(arg_wall, strv_freep);
 STATIC_DESTRUCTOR_REGISTER(arg_root, freep);
@@ -185,6 +186,7 @@ STATIC_DESTRUCTOR_REGISTER(arg_properties, strv_freep);
 STATIC_DESTRUCTOR_REGISTER(arg_clean_what, strv_freep);
 STATIC_DESTRUCTOR_REGISTER(cached_id_map, hashmap_freep);
 STATIC_DESTRUCTOR_REGISTER(cached_name_map, hashmap_freep);
+STATIC_DESTRUCTOR_REGISTER(cached_journal, sd_journal_closep);
 
 static int daemon_reload(int argc, char *argv[], void* userdata);
 static int trivial_method(int argc, char *argv[], void *userdata);
@@ -4532,8 +4534,11 @@ static void print_status_info(
                                           i->id, bus_error_message(&error, r));
         }
 
+        /* Units in the default namespace, which are almost all, share one journal instance across
+         * invocations, so that "systemctl status" on many units doesn't open all journal files again for
+         * each of them. */
         if (i->id && arg_transport == BUS_TRANSPORT_LOCAL)
-                show_journal_by_unit(
+                show_journal_by_unit_full(
                                 stdout,
                                 i->id,
                                 i->log_namespace,
@@ -4545,7 +4550,8 @@ static void print_status_info(
                                 get_output_flags() | OUTPUT_BEGIN_NEWLINE,
                                 SD_JOURNAL_LOCAL_ONLY,
                                 arg_scope == UNIT_FILE_SYSTEM,
-                                ellipsized);
+                                ellipsized,
+                                i->log_namespace ? NULL : &cached_journal);
 
         if (i->need_daemon_reload)
                 warn_unit_file_changed(i->id);
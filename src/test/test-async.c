@@ -9,6 +9,7 @@
 #include "util.h"
 
 static bool test_async = false;
+static bool test_async_reused = false;
 
 static void *async_func(void *arg) {
         test_async = true;
@@ -16,6 +17,12 @@ static void *async_func(void *arg) {
         return NULL;
 }
 
+static void *async_func_reused(void *arg) {
+        test_async_reused = true;
+
+        return NULL;
+}
+
 int main(int argc, char *argv[]) {
         int fd;
         char name[] = "/tmp/test-asynchronous_close.XXXXXX";
@@ -33,6 +40,13 @@ int main(int argc, char *argv[]) {
         assert_se(fcntl(fd, F_GETFD) == -1);
         assert_se(test_async);
 
+        /* The worker threads are idle now, and should pick up the next job */
+        assert_se(asynchronous_job(async_func_reused, NULL) >= 0);
+
+        sleep(1);
+
+        assert_se(test_async_reused);
+
         (void) unlink(name);
 
         return 0;
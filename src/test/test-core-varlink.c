@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include <sys/socket.h>
+
+#include "fd-util.h"
+#include "json.h"
+#include "manager.h"
+#include "rm-rf.h"
+#include "strv.h"
+#include "tests.h"
+#include "unit.h"
+#include "varlink.h"
+
+typedef struct ListResult {
+        char **ids;
+        uint64_t generation;
+        sd_id128_t instance;
+        bool complete;
+        bool done;
+} ListResult;
+
+static void list_result_done(ListResult *l) {
+        l->ids = strv_free(l->ids);
+        l->done = false;
+}
+
+static int list_reply(Varlink *link, JsonVariant *parameters, const char *error_id, VarlinkReplyFlags flags, void *userdata) {
+        ListResult *l = userdata;
+        JsonVariant *unit, *v;
+
+        assert_se(l);
+        assert_se(!error_id);
+
+        if (FLAGS_SET(flags, VARLINK_REPLY_CONTINUES)) {
+                assert_se(unit = json_variant_by_key(parameters, "unit"));
+                assert_se(v = json_variant_by_key(unit, "id"));
+                assert_se(strv_extend(&l->ids, json_variant_string(v)) >= 0);
+                return 0;
+        }
+
+        assert_se(v = json_variant_by_key(parameters, "generation"));
+        l->generation = json_variant_unsigned(v);
+        assert_se(v = json_variant_by_key(parameters, "instance"));
+        assert_se(sd_id128_from_string(json_variant_string(v), &l->instance) >= 0);
+        assert_se(v = json_variant_by_key(parameters, "complete"));
+        l->complete = json_variant_boolean(v);
+
+        l->done = true;
+        return 0;
+}
+
+static void list_units(Manager *m, Varlink *c, ListResult *l, uint64_t since_generation, sd_id128_t instance) {
+        _cleanup_(json_variant_unrefp) JsonVariant *p = NULL;
+
+        list_result_done(l);
+
+        if (since_generation > 0)
+                assert_se(json_build(&p, JSON_BUILD_OBJECT(
+                                                     JSON_BUILD_PAIR("sinceGeneration", JSON_BUILD_UNSIGNED(since_generation)),
+                                                     JSON_BUILD_PAIR("instance", JSON_BUILD_ID128(instance)))) >= 0);
+        else
+                assert_se(json_build(&p, JSON_BUILD_EMPTY_OBJECT) >= 0);
+
+        assert_se(varlink_observe(c, "io.systemd.Unit.List", p) >= 0);
+
+        while (!l->done)
+                assert_se(sd_event_run(m->event, UINT64_MAX) >= 0);
+}
+
+int main(int argc, char *argv[]) {
+        _cleanup_(rm_rf_physical_and_freep) char *runtime_dir = NULL;
+        _cleanup_(manager_freep) Manager *m = NULL;
+        _cleanup_(varlink_flush_close_unrefp) Varlink *c = NULL;
+        _cleanup_free_ char *unit_dir = NULL;
+        _cleanup_close_pair_ int pair[2] = { -1, -1 };
+        ListResult l = {};
+        sd_id128_t instance;
+        uint64_t generation;
+        Unit *a, *b;
+        int r;
+
+        test_setup_logging(LOG_DEBUG);
+
+        r = enter_cgroup_subroot(NULL);
+        if (r == -ENOMEDIUM)
+                return log_tests_skipped("cgroupfs not available");
+
+        assert_se(get_testdata_dir("units", &unit_dir) >= 0);
+        assert_se(set_unit_path(unit_dir) >= 0);
+        assert_se(runtime_dir = setup_fake_runtime_dir());
+
+        r = manager_new(UNIT_FILE_USER, MANAGER_TEST_RUN_BASIC, &m);
+        if (manager_errno_skip_test(r))
+                return log_tests_skipped_errno(r, "manager_new");
+        assert_se(r >= 0);
+        assert_se(manager_startup(m, NULL, NULL) >= 0);
+
+        /* The unit interface has a server of its own, not shared with the userdb one */
+        assert_se(m->varlink_unit_server);
+        assert_se(m->varlink_unit_server != m->varlink_server);
+
+        assert_se(manager_load_startable_unit_or_warn(m, "a.service", NULL, &a) >= 0);
+        assert_se(manager_load_startable_unit_or_warn(m, "b.service", NULL, &b) >= 0);
+
+        assert_se(socketpair(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0, pair) >= 0);
+        assert_se(varlink_server_add_connection(m->varlink_unit_server, pair[0], NULL) >= 0);
+        TAKE_FD(pair[0]);
+        assert_se(varlink_connect_fd(&c, pair[1]) >= 0);
+        TAKE_FD(pair[1]);
+        assert_se(varlink_attach_event(c, m->event, SD_EVENT_PRIORITY_NORMAL) >= 0);
+        assert_se(varlink_bind_reply(c, list_reply) >= 0);
+        varlink_set_userdata(c, &l);
+
+        /* Without a generation we get everything */
+        list_units(m, c, &l, 0, SD_ID128_NULL);
+        assert_se(l.complete);
+        assert_se(strv_contains(l.ids, "a.service"));
+        assert_se(strv_contains(l.ids, "b.service"));
+        assert_se(sd_id128_equal(l.instance, m->unit_state_instance_id));
+        assert_se(l.generation == m->unit_state_generation);
+        generation = l.generation;
+        instance = l.instance;
+
+        /* Nothing changed since then */
+        list_units(m, c, &l, generation, instance);
+        assert_se(!l.complete);
+        assert_se(strv_isempty(l.ids));
+        assert_se(l.generation == generation);
+
+        /* A single unit changed */
+        unit_add_to_dbus_queue(a);
+        list_units(m, c, &l, generation, instance);
+        assert_se(!l.complete);
+        assert_se(strv_equal(l.ids, STRV_MAKE("a.service")));
+        assert_se(l.generation > generation);
+        generation = l.generation;
+
+        /* A generation of a different manager instance means nothing to us, hence we get everything */
+        list_units(m, c, &l, generation, SD_ID128_MAKE(01,02,03,04,05,06,07,08,09,0a,0b,0c,0d,0e,0f,10));
+        assert_se(l.complete);
+        assert_se(strv_contains(l.ids, "a.service"));
+        assert_se(strv_contains(l.ids, "b.service"));
+
+        /* Same for the null instance, which no manager ever uses */
+        list_units(m, c, &l, generation, SD_ID128_NULL);
+        assert_se(l.complete);
+        assert_se(strv_contains(l.ids, "b.service"));
+
+        list_result_done(&l);
+
+        return 0;
+}
@@ -226,6 +226,43 @@ static void test_rearrange_stdio(void) {
         }
 }
 
+static void test_close_all_fds(void) {
+        pid_t pid;
+        int r;
+
+        r = safe_fork("close-all", FORK_WAIT|FORK_LOG, &pid);
+        assert_se(r >= 0);
+
+        if (r == 0) {
+                int fds[10], keep[3];
+                size_t i;
+
+                /* Child */
+
+                for (i = 0; i < ELEMENTSOF(fds); i++)
+                        assert_se((fds[i] = open("/dev/null", O_RDONLY|O_CLOEXEC)) >= 0);
+
+                /* Keep a few fds, out of order, with gaps of different sizes between them */
+                keep[0] = fds[7];
+                keep[1] = fds[2];
+                keep[2] = fds[3];
+
+                assert_se(close_all_fds(keep, ELEMENTSOF(keep)) >= 0);
+
+                for (i = 0; i < ELEMENTSOF(fds); i++)
+                        assert_se((fcntl(fds[i], F_GETFD) >= 0) == IN_SET(i, 2, 3, 7));
+
+                assert_se(fcntl(STDERR_FILENO, F_GETFD) >= 0);
+
+                assert_se(close_all_fds(NULL, 0) >= 0);
+
+                for (i = 0; i < ELEMENTSOF(fds); i++)
+                        assert_se(fcntl(fds[i], F_GETFD) < 0 && errno == EBADF);
+
+                _exit(EXIT_SUCCESS);
+        }
+}
+
 static void assert_equal_fd(int fd1, int fd2) {
 
         for (;;) {
@@ -328,6 +365,7 @@ int main(int argc, char *argv[]) {
         test_acquire_data_fd();
         test_fd_move_above_stdio();
         test_rearrange_stdio();
+        test_close_all_fds();
         test_fd_duplicate_data_fd();
         test_read_nr_open();
 
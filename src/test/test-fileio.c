@@ -907,6 +907,38 @@ static void test_read_full_file_socket(void) {
 #undef TEST_STR
 }
 
+static void test_read_virtual_file_to_buffer(void) {
+        _cleanup_(unlink_tempfilep) char fn[] = "/tmp/test-read-virtual-file-to-buffer-XXXXXX";
+        _cleanup_close_ int fd = -1;
+        char buf[16], small[4];
+        size_t size;
+
+        log_info("/* %s */", __func__);
+
+        fd = mkostemp_safe(fn);
+        assert_se(fd >= 0);
+        assert_se(write(fd, "foo\nbar\n", 8) == 8);
+
+        assert_se(read_virtual_file_to_buffer(fn, buf, sizeof(buf), NULL) >= 0);
+        assert_se(streq(buf, "foo\nbar\n"));
+
+        assert_se(read_virtual_file_to_buffer(fn, buf, sizeof(buf), &size) >= 0);
+        assert_se(size == 8);
+        assert_se(streq(buf, "foo\nbar\n"));
+
+        assert_se(read_virtual_file_to_buffer(fn, small, sizeof(small), NULL) == -E2BIG);
+        assert_se(read_virtual_file_to_buffer(fn, buf, 8, NULL) == -E2BIG);
+        assert_se(read_virtual_file_to_buffer(fn, buf, 9, NULL) >= 0);
+
+        assert_se(write(fd, "", 1) == 1);
+        assert_se(read_virtual_file_to_buffer(fn, buf, sizeof(buf), NULL) == -EBADMSG);
+        assert_se(read_virtual_file_to_buffer(fn, buf, sizeof(buf), &size) >= 0);
+        assert_se(size == 9);
+
+        assert_se(read_virtual_file_to_buffer("/proc/self/stat", buf, sizeof(buf), NULL) == -E2BIG);
+        assert_se(read_virtual_file_to_buffer("/nonexistent", buf, sizeof(buf), NULL) == -ENOENT);
+}
+
 int main(int argc, char *argv[]) {
         test_setup_logging(LOG_DEBUG);
 
@@ -933,6 +965,7 @@ int main(int argc, char *argv[]) {
         test_read_line4();
         test_read_nul_string();
         test_read_full_file_socket();
+        test_read_virtual_file_to_buffer();
 
         return 0;
 }
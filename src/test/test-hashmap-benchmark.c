@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include "alloc-util.h"
+#include "hashmap.h"
+#include "log.h"
+#include "macro.h"
+#include "parse-util.h"
+#include "stdio-util.h"
+#include "string-util.h"
+#include "tests.h"
+#include "time-util.h"
+
+static unsigned arg_n_max = 1000000;
+
+/* Same functions as trivial_hash_ops and uint64_hash_ops, but not recognized by the hashmap, hence
+ * always called through the hash_ops, for comparison */
+static void generic_trivial_hash_func(const void *p, struct siphash *state) {
+        trivial_hash_func(p, state);
+}
+
+static void generic_uint64_hash_func(const uint64_t *p, struct siphash *state) {
+        uint64_hash_func(p, state);
+}
+
+DEFINE_PRIVATE_HASH_OPS(generic_trivial_hash_ops, void, generic_trivial_hash_func, trivial_compare_func);
+DEFINE_PRIVATE_HASH_OPS(generic_uint64_hash_ops, uint64_t, generic_uint64_hash_func, uint64_compare_func);
+
+static void log_step(const char *name, const char *step, unsigned n, usec_t begin) {
+        char buf[FORMAT_TIMESPAN_MAX];
+        usec_t d;
+
+        d = usec_sub_unsigned(now(CLOCK_MONOTONIC), begin);
+
+        log_info("%-18s %8u entries: %-7s %12s, %5" PRIu64 " ns/entry",
+                 name, n, step,
+                 format_timespan(buf, sizeof(buf), d, USEC_PER_MSEC),
+                 d * NSEC_PER_USEC / n);
+}
+
+static void benchmark(const char *name, const struct hash_ops *hash_ops, void **keys, unsigned n) {
+        _cleanup_hashmap_free_ Hashmap *h = NULL;
+        usec_t ts;
+        unsigned k;
+        void *v;
+
+        assert_se(h = hashmap_new(hash_ops));
+
+        ts = now(CLOCK_MONOTONIC);
+        for (k = 0; k < n; k++)
+                assert_se(hashmap_put(h, keys[k], keys[k]) == 1);
+        log_step(name, "insert", n, ts);
+
+        ts = now(CLOCK_MONOTONIC);
+        for (k = 0; k < n; k++)
+                assert_se(hashmap_get(h, keys[k]) == keys[k]);
+        log_step(name, "lookup", n, ts);
+
+        ts = now(CLOCK_MONOTONIC);
+        k = 0;
+        HASHMAP_FOREACH(v, h)
+                k++;
+        assert_se(k == n);
+        log_step(name, "iterate", n, ts);
+
+        ts = now(CLOCK_MONOTONIC);
+        for (k = 0; k < n; k++)
+                assert_se(hashmap_remove(h, keys[k]) == keys[k]);
+        assert_se(hashmap_isempty(h));
+        log_step(name, "remove", n, ts);
+}
+
+static void benchmark_n(unsigned n) {
+        _cleanup_free_ void **pointers = NULL, **uint64s = NULL, **strings = NULL;
+        _cleanup_free_ uint64_t *numbers = NULL;
+        unsigned k;
+
+        assert_se(pointers = new(void*, n));
+        assert_se(uint64s = new(void*, n));
+        assert_se(strings = new0(void*, n));
+        assert_se(numbers = new(uint64_t, n));
+
+        for (k = 0; k < n; k++) {
+                char s[DECIMAL_STR_MAX(unsigned) + STRLEN("/sys/devices/")];
+
+                pointers[k] = UINT_TO_PTR(k + 1);
+
+                numbers[k] = (uint64_t) k * UINT64_C(0x9E3779B97F4A7C15);
+                uint64s[k] = numbers + k;
+
+                xsprintf(s, "/sys/devices/%u", k);
+                assert_se(strings[k] = strdup(s));
+        }
+
+        benchmark("pointer", &trivial_hash_ops, pointers, n);
+        benchmark("pointer (generic)", &generic_trivial_hash_ops, pointers, n);
+        benchmark("uint64", &uint64_hash_ops, uint64s, n);
+        benchmark("uint64 (generic)", &generic_uint64_hash_ops, uint64s, n);
+        benchmark("string", &string_hash_ops, strings, n);
+
+        for (k = 0; k < n; k++)
+                free(strings[k]);
+}
+
+int main(int argc, char *argv[]) {
+        unsigned n;
+
+        test_setup_logging(LOG_INFO);
+
+        /* Invoke as "test-hashmap-benchmark [ENTRIES]" to change the largest number of entries that is
+         * benchmarked, for example "test-hashmap-benchmark 10000000". */
+
+        if (argc > 1)
+                assert_se(safe_atou(argv[1], &arg_n_max) >= 0);
+
+        assert_se(arg_n_max > 0);
+
+        for (n = 1000;; n *= 10) {
+                benchmark_n(n);
+                if (n > arg_n_max / 10)
+                        break;
+        }
+
+        return 0;
+}
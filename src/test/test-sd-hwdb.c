@@ -58,6 +58,10 @@ static void test_basic_enumerate(void) {
         }
 
         assert_se(len1 == len2);
+
+        /* Switching to another modalias must not return the properties of the previous one */
+        assert_se(sd_hwdb_seek(hwdb, "no-such-modalias-should-exist") == 0);
+        assert_se(sd_hwdb_enumerate(hwdb, &key, &value) == 0);
 }
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: LGPL-2.1+ */
+
+#include "manager.h"
+#include "rm-rf.h"
+#include "swap.h"
+#include "tests.h"
+
+int main(int argc, char *argv[]) {
+        _cleanup_(rm_rf_physical_and_freep) char *runtime_dir = NULL;
+        _cleanup_(manager_freep) Manager *m = NULL;
+        _cleanup_free_ char *unit_dir = NULL;
+        int r;
+
+        test_setup_logging(LOG_DEBUG);
+
+        r = enter_cgroup_subroot(NULL);
+        if (r == -ENOMEDIUM)
+                return log_tests_skipped("cgroupfs not available");
+
+        assert_se(get_testdata_dir("units", &unit_dir) >= 0);
+        assert_se(set_unit_path(unit_dir) >= 0);
+        assert_se(runtime_dir = setup_fake_runtime_dir());
+
+        r = manager_new(UNIT_FILE_USER, MANAGER_TEST_RUN_BASIC, &m);
+        if (manager_errno_skip_test(r))
+                return log_tests_skipped_errno(r, "manager_new");
+        assert_se(r >= 0);
+        assert_se(manager_startup(m, NULL, NULL) >= 0);
+
+        if (!m->swap_event_source)
+                return log_tests_skipped("/proc/swaps is not watched");
+
+        /* Up to the burst, changes are processed right away */
+        for (unsigned i = 0; i < m->swap_ratelimit.burst; i++) {
+                assert_se(swap_process_proc_swaps_ratelimited(m) >= 0);
+                assert_se(!m->swap_ratelimit_event_source);
+                assert_se(sd_event_source_get_enabled(m->swap_event_source, NULL) > 0);
+        }
+
+        /* Then we stop watching /proc/swaps, and wait for the interval to end */
+        assert_se(swap_process_proc_swaps_ratelimited(m) >= 0);
+        assert_se(m->swap_ratelimit_event_source);
+        assert_se(sd_event_source_get_enabled(m->swap_event_source, NULL) == 0);
+
+        /* Further changes in the same interval don't arm a second timer */
+        assert_se(swap_process_proc_swaps_ratelimited(m) >= 0);
+        assert_se(m->swap_ratelimit_event_source);
+
+        /* Once the interval is over we rescan and watch /proc/swaps again */
+        while (m->swap_ratelimit_event_source)
+                assert_se(sd_event_run(m->event, UINT64_MAX) >= 0);
+
+        assert_se(sd_event_source_get_enabled(m->swap_event_source, NULL) > 0);
+
+        /* And the next change is processed right away again */
+        assert_se(swap_process_proc_swaps_ratelimited(m) >= 0);
+        assert_se(!m->swap_ratelimit_event_source);
+
+        return 0;
+}
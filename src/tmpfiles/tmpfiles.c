@@ -381,6 +381,14 @@ static struct Item* find_glob(OrderedHashmap *h, const char *match) {
 
                 for (n = 0; n < j->n_items; n++) {
                         Item *item = j->items + n;
+                        size_t k;
+
+                        /* This is called for every entry while aging directories, hence quickly rule out
+                         * globs whose literal prefix doesn't match before calling the much slower
+                         * fnmatch(). */
+                        k = strcspn(item->path, GLOB_CHARS "\\");
+                        if (strncmp(item->path, match, k) != 0)
+                                continue;
 
                         if (fnmatch(item->path, match, FNM_PATHNAME|FNM_PERIOD) == 0)
                                 return item;
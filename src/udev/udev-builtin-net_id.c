@@ -243,6 +243,66 @@ static bool is_pci_ari_enabled(sd_device *dev) {
         return streq(a, "1");
 }
 
+typedef struct PciSlot {
+        unsigned number;
+        char *address;
+} PciSlot;
+
+static void pci_slots_free(PciSlot *slots, size_t n) {
+        for (size_t i = 0; i < n; i++)
+                free(slots[i].address);
+        free(slots);
+}
+
+static int pci_slots_read(const char *path, PciSlot **ret, size_t *ret_n) {
+        _cleanup_closedir_ DIR *dir = NULL;
+        PciSlot *slots = NULL;
+        size_t n = 0, allocated = 0;
+        struct dirent *dent;
+        int r;
+
+        assert(path);
+        assert(ret);
+        assert(ret_n);
+
+        /* Reads the addresses of all hotplug slots, in directory order. */
+
+        dir = opendir(path);
+        if (!dir)
+                return -errno;
+
+        FOREACH_DIRENT_ALL(dent, dir, break) {
+                _cleanup_free_ char *address = NULL;
+                char str[PATH_MAX];
+                unsigned i;
+
+                if (dot_or_dot_dot(dent->d_name))
+                        continue;
+
+                r = safe_atou_full(dent->d_name, 10, &i);
+                if (r < 0 || i <= 0)
+                        continue;
+
+                if (!snprintf_ok(str, sizeof str, "%s/%s/address", path, dent->d_name) ||
+                    read_one_line_file(str, &address) < 0)
+                        continue;
+
+                if (!GREEDY_REALLOC(slots, allocated, n + 1)) {
+                        pci_slots_free(slots, n);
+                        return -ENOMEM;
+                }
+
+                slots[n++] = (PciSlot) {
+                        .number = i,
+                        .address = TAKE_PTR(address),
+                };
+        }
+
+        *ret = slots;
+        *ret_n = n;
+        return 0;
+}
+
 static int dev_pci_slot(sd_device *dev, struct netnames *names) {
         unsigned long dev_port = 0;
         unsigned domain, bus, slot, func, hotplug_slot = 0;
@@ -252,8 +312,8 @@ static int dev_pci_slot(sd_device *dev, struct netnames *names) {
         _cleanup_(sd_device_unrefp) sd_device *pci = NULL;
         sd_device *hotplug_slot_dev;
         char slots[PATH_MAX];
-        _cleanup_closedir_ DIR *dir = NULL;
-        struct dirent *dent;
+        PciSlot *slot_list = NULL;
+        size_t n_slots = 0;
         int r;
 
         r = sd_device_get_sysname(names->pcidev, &sysname);
@@ -316,42 +376,31 @@ static int dev_pci_slot(sd_device *dev, struct netnames *names) {
         if (!snprintf_ok(slots, sizeof slots, "%s/slots", syspath))
                 return -ENAMETOOLONG;
 
-        dir = opendir(slots);
-        if (!dir)
-                return -errno;
+        /* Read the slot addresses only once, rather than for every PCI device on the way up: with many
+         * slots and VFs below bridges that used to be a lot of sysfs reads per interface. */
+        r = pci_slots_read(slots, &slot_list, &n_slots);
+        if (r < 0)
+                return r;
 
         hotplug_slot_dev = names->pcidev;
         while (hotplug_slot_dev) {
                 if (sd_device_get_sysname(hotplug_slot_dev, &sysname) < 0)
-                        continue;
-
-                FOREACH_DIRENT_ALL(dent, dir, break) {
-                        unsigned i;
-                        char str[PATH_MAX];
-                        _cleanup_free_ char *address = NULL;
-
-                        if (dot_or_dot_dot(dent->d_name))
-                                continue;
-
-                        r = safe_atou_full(dent->d_name, 10, &i);
-                        if (r < 0 || i <= 0)
-                                continue;
+                        break;
 
-                        /* match slot address with device by stripping the function */
-                        if (snprintf_ok(str, sizeof str, "%s/%s/address", slots, dent->d_name) &&
-                            read_one_line_file(str, &address) >= 0 &&
-                            startswith(sysname, address)) {
-                                hotplug_slot = i;
+                /* match slot address with device by stripping the function */
+                for (size_t k = 0; k < n_slots; k++)
+                        if (startswith(sysname, slot_list[k].address)) {
+                                hotplug_slot = slot_list[k].number;
                                 break;
                         }
-                }
                 if (hotplug_slot > 0)
                         break;
                 if (sd_device_get_parent_with_subsystem_devtype(hotplug_slot_dev, "pci", NULL, &hotplug_slot_dev) < 0)
                         break;
-                rewinddir(dir);
         }
 
+        pci_slots_free(slot_list, n_slots);
+
         if (hotplug_slot > 0) {
                 s = names->pci_slot;
                 l = sizeof(names->pci_slot);
@@ -7,6 +7,7 @@
 #include "device-util.h"
 #include "string-util.h"
 #include "strv.h"
+#include "time-util.h"
 #include "udev-builtin.h"
 
 static bool initialized;
@@ -109,6 +110,8 @@ UdevBuiltinCommand udev_builtin_lookup(const char *command) {
 
 int udev_builtin_run(sd_device *dev, UdevBuiltinCommand cmd, const char *command, bool test) {
         _cleanup_strv_free_ char **argv = NULL;
+        char buf[FORMAT_TIMESPAN_MAX];
+        usec_t start;
         int r;
 
         assert(dev);
@@ -122,9 +125,17 @@ int udev_builtin_run(sd_device *dev, UdevBuiltinCommand cmd, const char *command
         if (r < 0)
                 return r;
 
+        start = now(CLOCK_MONOTONIC);
+
         /* we need '0' here to reset the internal state */
         optind = 0;
-        return builtins[cmd]->cmd(dev, strv_length(argv), argv, test);
+        r = builtins[cmd]->cmd(dev, strv_length(argv), argv, test);
+
+        /* Makes it possible to tell from the debug logs which builtin is slow for which device */
+        log_device_debug(dev, "Builtin command '%s' finished after %s.", command,
+                         format_timespan(buf, sizeof(buf), usec_sub_unsigned(now(CLOCK_MONOTONIC), start), USEC_PER_MSEC));
+
+        return r;
 }
 
 int udev_builtin_add_property(sd_device *dev, bool test, const char *key, const char *val) {
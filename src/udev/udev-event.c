@@ -43,6 +43,7 @@ typedef struct Spawn {
         usec_t timeout_usec;
         int timeout_signal;
         usec_t event_birth_usec;
+        usec_t start_usec;
         bool accept_failure;
         int fd_stdout;
         int fd_stderr;
@@ -623,6 +624,7 @@ static int on_spawn_timeout_warning(sd_event_source *s, uint64_t usec, void *use
 }
 
 static int on_spawn_sigchld(sd_event_source *s, const siginfo_t *si, void *userdata) {
+        char buf[FORMAT_TIMESPAN_MAX];
         Spawn *spawn = userdata;
         int ret = -EIO;
 
@@ -631,7 +633,8 @@ static int on_spawn_sigchld(sd_event_source *s, const siginfo_t *si, void *userd
         switch (si->si_code) {
         case CLD_EXITED:
                 if (si->si_status == 0)
-                        log_device_debug(spawn->device, "Process '%s' succeeded.", spawn->cmd);
+                        log_device_debug(spawn->device, "Process '%s' succeeded after %s.", spawn->cmd,
+                                         format_timespan(buf, sizeof(buf), usec_sub_unsigned(now(CLOCK_MONOTONIC), spawn->start_usec), USEC_PER_MSEC));
                 else
                         log_device_full(spawn->device, spawn->accept_failure ? LOG_DEBUG : LOG_WARNING,
                                         "Process '%s' failed with exit code %i.", spawn->cmd, si->si_status);
@@ -800,6 +803,7 @@ int udev_event_spawn(UdevEvent *event,
                 .timeout_usec = timeout_usec,
                 .timeout_signal = timeout_signal,
                 .event_birth_usec = event->birth_usec,
+                .start_usec = now(CLOCK_MONOTONIC),
                 .fd_stdout = outpipe[READ_END],
                 .fd_stderr = errpipe[READ_END],
                 .result = result,
@@ -2213,27 +2213,14 @@ static int udev_rule_apply_line_to_event(
                 usec_t timeout_usec,
                 int timeout_signal,
                 Hashmap *properties_list,
+                UdevRuleLineType mask,
                 UdevRuleLine **next_line) {
 
         UdevRuleLine *line = rules->current_file->current_line;
-        UdevRuleLineType mask = LINE_HAS_GOTO | LINE_UPDATE_SOMETHING;
         UdevRuleToken *token, *next_token;
         bool parents_done = false;
-        DeviceAction action;
         int r;
 
-        r = device_get_action(event->dev, &action);
-        if (r < 0)
-                return r;
-
-        if (action != DEVICE_ACTION_REMOVE) {
-                if (sd_device_get_devnum(event->dev, NULL) >= 0)
-                        mask |= LINE_HAS_DEVLINK;
-
-                if (sd_device_get_ifindex(event->dev, NULL) >= 0)
-                        mask |= LINE_HAS_NAME;
-        }
-
         if ((line->type & mask) == 0)
                 return 0;
 
@@ -2271,17 +2258,33 @@ int udev_rules_apply_to_event(
                 int timeout_signal,
                 Hashmap *properties_list) {
 
+        UdevRuleLineType mask = LINE_HAS_GOTO | LINE_UPDATE_SOMETHING;
         UdevRuleFile *file;
         UdevRuleLine *next_line;
+        DeviceAction action;
         int r;
 
         assert(rules);
         assert(event);
 
+        /* Which kinds of lines are relevant for this event only depends on the device, hence figure that
+         * out once here, rather than for each of the (usually thousands of) lines */
+        r = device_get_action(event->dev, &action);
+        if (r < 0)
+                return r;
+
+        if (action != DEVICE_ACTION_REMOVE) {
+                if (sd_device_get_devnum(event->dev, NULL) >= 0)
+                        mask |= LINE_HAS_DEVLINK;
+
+                if (sd_device_get_ifindex(event->dev, NULL) >= 0)
+                        mask |= LINE_HAS_NAME;
+        }
+
         LIST_FOREACH(rule_files, file, rules->rule_files) {
                 rules->current_file = file;
                 LIST_FOREACH_SAFE(rule_lines, file->current_line, next_line, file->rule_lines) {
-                        r = udev_rule_apply_line_to_event(rules, event, timeout_usec, timeout_signal, properties_list, &next_line);
+                        r = udev_rule_apply_line_to_event(rules, event, timeout_usec, timeout_signal, properties_list, mask, &next_line);
                         if (r < 0)
                                 return r;
                 }
@@ -609,6 +609,24 @@ static int worker_spawn(Manager *manager, struct event *event) {
         return 0;
 }
 
+static bool manager_has_free_worker(Manager *manager) {
+        struct worker *worker;
+
+        assert(manager);
+
+        /* Returns true if event_run() would be able to pass an event to a worker right now, either an idle
+         * one, or a newly forked one. */
+
+        if (hashmap_size(manager->workers) < arg_children_max)
+                return true;
+
+        HASHMAP_FOREACH(worker, manager->workers)
+                if (worker->state == WORKER_IDLE)
+                        return true;
+
+        return false;
+}
+
 static void event_run(Manager *manager, struct event *event) {
         static bool log_children_max_reached = true;
         struct worker *worker;
@@ -937,6 +955,12 @@ static void event_queue_start(Manager *manager) {
                 if (event->state != EVENT_QUEUED)
                         continue;
 
+                /* When all workers are busy, nothing can be started anyway, hence don't bother checking the
+                 * rest of the queue for events that are ready. With many thousands of events queued (e.g.
+                 * during coldplug) the is_device_busy() checks below are expensive. */
+                if (!manager_has_free_worker(manager))
+                        break;
+
                 /* do not start event if parent or child event is still running */
                 if (is_device_busy(manager, event) != 0)
                         continue;